@@ -0,0 +1,267 @@
+/*
+ * All pairs shortest paths on a dense distance matrix
+ *
+ * [$graph apsp ?-packed? ?filter?] fills an n x n matrix of doubles with the weights of the edges between
+ * the member nodes, taken from the CSR snapshot of the graph, and runs Floyd-Warshall on it in blocks of
+ * APSP_BLOCK x APSP_BLOCK, so that the three blocks an update works on stay in the cache. The min-plus
+ * update of a row segment, row[j] = min(row[j], d(i,k) + rowK[j]), is done with AVX or SSE2 instructions if
+ * the processor has them, and in plain C otherwise. Hidden nodes and edges and edges not matching the filter
+ * are left out, parallel edges count with their smallest weight and undirected edges in both directions.
+ * Weights may be negative, a negative cycle is an error.
+ *
+ * The result is a dict of the nodes to dicts of the nodes they reach to the distance or, with -packed, a
+ * list of the nodes in matrix order and the matrix as byte array of doubles in native byte order, row by
+ * row, with Inf for unreachable pairs and in the rows of hidden nodes.
+ */
+#include "graphsInt.h"
+#include <limits.h>
+#include <math.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#   include <immintrin.h>
+#   define APSP_X86 1
+#endif
+
+/*
+ * Side of the square blocks of the matrix: three blocks of 64 x 64 doubles fit the L2 cache
+ */
+#define APSP_BLOCK 64
+
+typedef void ApspRowProc(double* row, const double* rowK, double dik, int count);
+
+static void ApspRowScalar(double* row, const double* rowK, double dik, int count)
+{
+    for (int j = 0; j < count; j++) {
+        double d = dik + rowK[j];
+        if (d < row[j]) {
+            row[j] = d;
+        }
+    }
+}
+
+#ifdef APSP_X86
+__attribute__((target("sse2"))) static void ApspRowSse2(double* row, const double* rowK, double dik, int count)
+{
+    __m128d vik = _mm_set1_pd(dik);
+    int j = 0;
+
+    for (; j + 2 <= count; j += 2) {
+        __m128d d = _mm_add_pd(vik, _mm_loadu_pd(rowK + j));
+        _mm_storeu_pd(row + j, _mm_min_pd(_mm_loadu_pd(row + j), d));
+    }
+    ApspRowScalar(row + j, rowK + j, dik, count - j);
+}
+
+__attribute__((target("avx"))) static void ApspRowAvx(double* row, const double* rowK, double dik, int count)
+{
+    __m256d vik = _mm256_set1_pd(dik);
+    int j = 0;
+
+    for (; j + 8 <= count; j += 8) {
+        __m256d d0 = _mm256_add_pd(vik, _mm256_loadu_pd(rowK + j));
+        __m256d d1 = _mm256_add_pd(vik, _mm256_loadu_pd(rowK + j + 4));
+        _mm256_storeu_pd(row + j, _mm256_min_pd(_mm256_loadu_pd(row + j), d0));
+        _mm256_storeu_pd(row + j + 4, _mm256_min_pd(_mm256_loadu_pd(row + j + 4), d1));
+    }
+    for (; j + 4 <= count; j += 4) {
+        __m256d d = _mm256_add_pd(vik, _mm256_loadu_pd(rowK + j));
+        _mm256_storeu_pd(row + j, _mm256_min_pd(_mm256_loadu_pd(row + j), d));
+    }
+    ApspRowScalar(row + j, rowK + j, dik, count - j);
+}
+#endif
+
+/* The widest row update the processor supports */
+static ApspRowProc* ApspSelectRow(void)
+{
+#ifdef APSP_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx")) {
+        return ApspRowAvx;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return ApspRowSse2;
+    }
+#endif
+    return ApspRowScalar;
+}
+
+/*
+ * Relaxes the block of rows i0 .. i1-1 and columns j0 .. j1-1 over the intermediate nodes k0 .. k1-1.
+ * With k outermost the update is correct in place, also when the block overlaps row or column block k.
+ */
+static void ApspBlock(double* d, int n, ApspRowProc* rowProc, int i0, int i1, int j0, int j1, int k0, int k1)
+{
+    for (int k = k0; k < k1; k++) {
+        const double* rowK = d + (size_t)k * n + j0;
+
+        for (int i = i0; i < i1; i++) {
+            double* rowI = d + (size_t)i * n;
+            double dik = rowI[k];
+
+            if (dik != HUGE_VAL) {
+                rowProc(rowI + j0, rowK, dik, j1 - j0);
+            }
+        }
+    }
+}
+
+/*
+ * Blocked Floyd-Warshall: for every block row kb first the diagonal block, then the other blocks of row and
+ * column kb, which only depend on the diagonal block, then all remaining blocks.
+ */
+static void ApspFloydWarshall(double* d, int n)
+{
+    ApspRowProc* rowProc = ApspSelectRow();
+
+    for (int kb = 0; kb < n; kb += APSP_BLOCK) {
+        int ke = (kb + APSP_BLOCK < n) ? kb + APSP_BLOCK : n;
+
+        ApspBlock(d, n, rowProc, kb, ke, kb, ke, kb, ke);
+        for (int b = 0; b < n; b += APSP_BLOCK) {
+            int be = (b + APSP_BLOCK < n) ? b + APSP_BLOCK : n;
+            if (b != kb) {
+                ApspBlock(d, n, rowProc, kb, ke, b, be, kb, ke);
+                ApspBlock(d, n, rowProc, b, be, kb, ke, kb, ke);
+            }
+        }
+        for (int ib = 0; ib < n; ib += APSP_BLOCK) {
+            int ie = (ib + APSP_BLOCK < n) ? ib + APSP_BLOCK : n;
+            if (ib == kb) {
+                continue;
+            }
+            for (int jb = 0; jb < n; jb += APSP_BLOCK) {
+                int je = (jb + APSP_BLOCK < n) ? jb + APSP_BLOCK : n;
+                if (jb != kb) {
+                    ApspBlock(d, n, rowProc, ib, ie, jb, je, kb, ke);
+                }
+            }
+        }
+    }
+}
+
+/* Fills the matrix with 0 on the diagonal, the smallest weight of the usable arcs between nodes and Inf */
+static void ApspFill(double* d, const GraphSnapshot* snapPtr, const struct LabelFilter* lblFiltPtr)
+{
+    int n = snapPtr->nodeCount;
+
+    for (size_t i = 0; i < (size_t)n * n; i++) {
+        d[i] = HUGE_VAL;
+    }
+    for (int u = 0; u < n; u++) {
+        if ((snapPtr->nodes[u]->marks & GRAPHS_MARK_HIDDEN) != 0) {
+            continue;
+        }
+        d[(size_t)u * n + u] = 0.0;
+        for (int k = snapPtr->outOffsets[u]; k < snapPtr->outOffsets[u + 1]; k++) {
+            const Edge* edgePtr = snapPtr->outEdges[k];
+            int v = snapPtr->outTargets[k];
+            int matches = 1;
+
+            if ((edgePtr->marks & GRAPHS_MARK_HIDDEN) != 0 || (snapPtr->nodes[v]->marks & GRAPHS_MARK_HIDDEN) != 0) {
+                continue;
+            }
+            if (lblFiltPtr->filterType != LABELS_ALL_IDX) {
+                GraphsInt_MatchesLabels(&edgePtr->labels, edgePtr->name, lblFiltPtr, &matches);
+            }
+            if (matches && snapPtr->outWeights[k] < d[(size_t)u * n + v]) {
+                d[(size_t)u * n + v] = snapPtr->outWeights[k];
+            }
+        }
+    }
+}
+
+/* The dict of nodes to dicts of the nodes they reach to the distance */
+static Tcl_Obj* ApspDictObj(const double* d, const GraphSnapshot* snapPtr)
+{
+    int n = snapPtr->nodeCount;
+    Tcl_Obj* result = Tcl_NewListObj(0, NULL);
+
+    for (int i = 0; i < n; i++) {
+        const double* row = d + (size_t)i * n;
+        Tcl_Obj* targets;
+
+        if ((snapPtr->nodes[i]->marks & GRAPHS_MARK_HIDDEN) != 0) {
+            continue;
+        }
+        targets = Tcl_NewListObj(0, NULL);
+        for (int j = 0; j < n; j++) {
+            if (row[j] != HUGE_VAL) {
+                Tcl_ListObjAppendElement(NULL, targets, GraphsInt_NodeHandleObj(snapPtr->nodes[j]));
+                Tcl_ListObjAppendElement(NULL, targets, Tcl_NewDoubleObj(row[j]));
+            }
+        }
+        Tcl_ListObjAppendElement(NULL, result, GraphsInt_NodeHandleObj(snapPtr->nodes[i]));
+        Tcl_ListObjAppendElement(NULL, result, targets);
+    }
+    return result;
+}
+
+/*
+ * Implements [$graph apsp ?-packed? ?filter?]
+ */
+int GraphsInt_GraphCmdApsp(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[])
+{
+    const GraphSnapshot* snapPtr = Graphs_GraphGetSnapshot(graphPtr);
+    int n = snapPtr->nodeCount;
+    struct LabelFilter lblFilt;
+    Tcl_Obj* matrixObj = NULL;
+    double* d;
+    int packed = 0;
+
+    if (objc > 0 && strcmp(Tcl_GetString(objv[0]), "-packed") == 0) {
+        packed = 1;
+        objc--;
+        objv++;
+    }
+    if ((double)n * n * sizeof(double) > INT_MAX) {
+        Tcl_SetObjResult(interp, Tcl_ObjPrintf("%s has too many nodes for a distance matrix", graphPtr->cmdName));
+        return TCL_ERROR;
+    }
+    if (GraphsInt_PathsFilterInit(graphPtr, interp, objc, objv, &lblFilt) != TCL_OK) {
+        return TCL_ERROR;
+    }
+
+    /* the packed result is computed in place */
+    if (packed) {
+        matrixObj = Tcl_NewByteArrayObj(NULL, 0);
+        d = (double*)Tcl_SetByteArrayLength(matrixObj, n * n * (int)sizeof(double));
+    }
+    else {
+        d = (double*)ckalloc(n * n * sizeof(double) + 1);
+    }
+    ApspFill(d, snapPtr, &lblFilt);
+    GraphsInt_LabelFilterFree(&lblFilt);
+    ApspFloydWarshall(d, n);
+
+    for (int i = 0; i < n; i++) {
+        if (d[(size_t)i * n + i] < 0.0) {
+            Tcl_SetObjResult(interp, Tcl_ObjPrintf("negative cycle through %s", snapPtr->nodes[i]->cmdName));
+            Tcl_SetErrorCode(interp, "GRAPHS", "NEGATIVE_CYCLE", NULL);
+            if (packed) {
+                Tcl_DecrRefCount(matrixObj);
+            }
+            else {
+                ckfree((char*)d);
+            }
+            return TCL_ERROR;
+        }
+    }
+
+    if (packed) {
+        Tcl_Obj* pair[2];
+
+        pair[0] = Tcl_NewListObj(0, NULL);
+        for (int i = 0; i < n; i++) {
+            Tcl_ListObjAppendElement(NULL, pair[0], GraphsInt_NodeHandleObj(snapPtr->nodes[i]));
+        }
+        pair[1] = matrixObj;
+        Tcl_SetObjResult(interp, Tcl_NewListObj(2, pair));
+    }
+    else {
+        Tcl_SetObjResult(interp, ApspDictObj(d, snapPtr));
+        ckfree((char*)d);
+    }
+    return TCL_OK;
+}
@@ -0,0 +1,542 @@
+/*
+ * Typed numeric attribute columns of graphs
+ *
+ * Every node and edge gets a dense id from the allocator of its state. A graph can declare named columns
+ * of type double, int64 or float for its member nodes and edges, which store one value per id in a plain
+ * array instead of a Tcl_Obj per entity. The arrays grow by doubling on the first write beyond their
+ * capacity. A slot holds the default of its column unless the entity with that id is a member of the
+ * graph: slots are reset when an entity leaves the graph, so ids that are reused start with the default.
+ *
+ * [$graph attrs declare|forget|names|get|set ...] manages the columns and moves values in bulk,
+ * [$node configure -attr <name> <value>] and [$edge configure -attr <name> <value>] set single values.
+ */
+#include "graphsInt.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char* AttrTypeNames[] = { "double", "int64", "float", NULL };
+static const char* AttrKinds[] = { "nodes", "edges", NULL };
+
+enum AttrKindIx
+{
+    AttrNodesIx,
+    AttrEdgesIx
+};
+
+/*
+ * Number of handle generations an id allocator reserves at once, see GraphsInt_HandleReserveGenerations()
+ */
+#define IDS_GENERATION_BLOCK 4096
+
+void GraphsInt_IdsInit(GraphsIds* idsPtr)
+{
+    idsPtr->next = 0;
+    idsPtr->free = NULL;
+    idsPtr->freeCount = 0;
+    idsPtr->freeSize = 0;
+    idsPtr->entities = NULL;
+    idsPtr->generations = NULL;
+    idsPtr->capacity = 0;
+    idsPtr->nextGeneration = idsPtr->lastGeneration = 0;
+}
+
+void GraphsInt_IdsFree(GraphsIds* idsPtr)
+{
+    if (idsPtr->free != NULL) {
+        ckfree((char*)idsPtr->free);
+    }
+    if (idsPtr->entities != NULL) {
+        ckfree((char*)idsPtr->entities);
+        ckfree((char*)idsPtr->generations);
+    }
+    GraphsInt_IdsInit(idsPtr);
+}
+
+/*
+ * Allocates an id for an entity and gives it a new handle generation
+ */
+int GraphsInt_IdAlloc(GraphsIds* idsPtr, void* entity)
+{
+    int id = (idsPtr->freeCount > 0) ? idsPtr->free[--idsPtr->freeCount] : idsPtr->next++;
+
+    if (id >= idsPtr->capacity) {
+        int capacity = (idsPtr->capacity == 0) ? 64 : 2 * idsPtr->capacity;
+        idsPtr->entities = (void**)ckrealloc((char*)idsPtr->entities, capacity * sizeof(void*));
+        idsPtr->generations = (size_t*)ckrealloc((char*)idsPtr->generations, capacity * sizeof(size_t));
+        memset(idsPtr->generations + idsPtr->capacity, 0, (capacity - idsPtr->capacity) * sizeof(size_t));
+        idsPtr->capacity = capacity;
+    }
+    if (idsPtr->nextGeneration == idsPtr->lastGeneration) {
+        idsPtr->nextGeneration = GraphsInt_HandleReserveGenerations(IDS_GENERATION_BLOCK);
+        idsPtr->lastGeneration = idsPtr->nextGeneration + IDS_GENERATION_BLOCK;
+    }
+    idsPtr->entities[id] = entity;
+    idsPtr->generations[id] = idsPtr->nextGeneration++;
+    return id;
+}
+
+void GraphsInt_IdRelease(GraphsIds* idsPtr, int id)
+{
+    idsPtr->entities[id] = NULL;
+    idsPtr->generations[id] = 0;
+
+    if (idsPtr->freeCount == idsPtr->freeSize) {
+        idsPtr->freeSize = (idsPtr->freeSize == 0) ? 64 : 2 * idsPtr->freeSize;
+        idsPtr->free = (int*)ckrealloc((char*)idsPtr->free, idsPtr->freeSize * sizeof(int));
+    }
+    idsPtr->free[idsPtr->freeCount++] = id;
+
+    /* once all entities are gone, start over with a compact range */
+    if (idsPtr->freeCount == idsPtr->next) {
+        idsPtr->freeCount = 0;
+        idsPtr->next = 0;
+    }
+}
+
+static size_t AttrValueSize(GraphsAttrT type)
+{
+    switch (type) {
+    case GRAPHS_ATTR_INT64:
+        return sizeof(Tcl_WideInt);
+    case GRAPHS_ATTR_FLOAT:
+        return sizeof(float);
+    default:
+        return sizeof(double);
+    }
+}
+
+/* Sets the slots from .. to-1 to the default */
+static void AttrFill(GraphsAttr* attrPtr, int from, int to)
+{
+    for (int i = from; i < to; i++) {
+        switch (attrPtr->type) {
+        case GRAPHS_ATTR_DOUBLE:
+            attrPtr->values.d[i] = attrPtr->defaultValue.d;
+            break;
+        case GRAPHS_ATTR_INT64:
+            attrPtr->values.w[i] = attrPtr->defaultValue.w;
+            break;
+        case GRAPHS_ATTR_FLOAT:
+            attrPtr->values.f[i] = attrPtr->defaultValue.f;
+            break;
+        }
+    }
+}
+
+static void AttrReserve(GraphsAttr* attrPtr, int id)
+{
+    int capacity = attrPtr->capacity;
+
+    if (id < capacity) {
+        return;
+    }
+    if (capacity == 0) {
+        capacity = 64;
+    }
+    while (capacity <= id) {
+        capacity *= 2;
+    }
+    attrPtr->values.ptr = ckrealloc((char*)attrPtr->values.ptr, capacity * AttrValueSize(attrPtr->type));
+    AttrFill(attrPtr, attrPtr->capacity, capacity);
+    attrPtr->capacity = capacity;
+}
+
+static void AttrFree(GraphsAttr* attrPtr)
+{
+    if (attrPtr->values.ptr != NULL) {
+        ckfree((char*)attrPtr->values.ptr);
+    }
+    ckfree((char*)attrPtr);
+}
+
+void GraphsInt_AttrsInit(Graph* graphPtr)
+{
+    Tcl_InitHashTable(&graphPtr->nodeAttrs, TCL_STRING_KEYS);
+    Tcl_InitHashTable(&graphPtr->edgeAttrs, TCL_STRING_KEYS);
+}
+
+static void AttrsFreeTable(Tcl_HashTable* tablePtr)
+{
+    Tcl_HashSearch search;
+
+    for (Tcl_HashEntry* entry = Tcl_FirstHashEntry(tablePtr, &search); entry != NULL;
+        entry = Tcl_NextHashEntry(&search)) {
+        AttrFree((GraphsAttr*)Tcl_GetHashValue(entry));
+    }
+    Tcl_DeleteHashTable(tablePtr);
+}
+
+void GraphsInt_AttrsFree(Graph* graphPtr)
+{
+    AttrsFreeTable(&graphPtr->nodeAttrs);
+    AttrsFreeTable(&graphPtr->edgeAttrs);
+}
+
+/*
+ * Resets the slot of an entity in all columns of a table, when the entity leaves the graph
+ */
+void GraphsInt_AttrsReset(Tcl_HashTable* tablePtr, int id)
+{
+    Tcl_HashSearch search;
+
+    for (Tcl_HashEntry* entry = Tcl_FirstHashEntry(tablePtr, &search); entry != NULL;
+        entry = Tcl_NextHashEntry(&search)) {
+        GraphsAttr* attrPtr = (GraphsAttr*)Tcl_GetHashValue(entry);
+        if (id < attrPtr->capacity) {
+            AttrFill(attrPtr, id, id + 1);
+        }
+    }
+}
+
+/*
+ * Resets all slots of all columns of a table, after the members of the graph were dropped in bulk
+ */
+void GraphsInt_AttrsClear(Tcl_HashTable* tablePtr)
+{
+    Tcl_HashSearch search;
+
+    for (Tcl_HashEntry* entry = Tcl_FirstHashEntry(tablePtr, &search); entry != NULL;
+        entry = Tcl_NextHashEntry(&search)) {
+        GraphsAttr* attrPtr = (GraphsAttr*)Tcl_GetHashValue(entry);
+        AttrFill(attrPtr, 0, attrPtr->capacity);
+    }
+}
+
+GraphsAttr* GraphsInt_AttrFind(const Tcl_HashTable* tablePtr, const char* name)
+{
+    Tcl_HashEntry* entry = Tcl_FindHashEntry((Tcl_HashTable*)tablePtr, name);
+    return (entry == NULL) ? NULL : (GraphsAttr*)Tcl_GetHashValue(entry);
+}
+
+/*
+ * Returns the value of slot id as a double, the common type C kernels read columns with
+ */
+double GraphsInt_AttrGet(const GraphsAttr* attrPtr, int id)
+{
+    switch (attrPtr->type) {
+    case GRAPHS_ATTR_INT64:
+        return (double)(id < attrPtr->capacity ? attrPtr->values.w[id] : attrPtr->defaultValue.w);
+    case GRAPHS_ATTR_FLOAT:
+        return (double)(id < attrPtr->capacity ? attrPtr->values.f[id] : attrPtr->defaultValue.f);
+    default:
+        return id < attrPtr->capacity ? attrPtr->values.d[id] : attrPtr->defaultValue.d;
+    }
+}
+
+Tcl_Obj* GraphsInt_AttrGetObj(const GraphsAttr* attrPtr, int id)
+{
+    if (attrPtr->type == GRAPHS_ATTR_INT64) {
+        return Tcl_NewWideIntObj(id < attrPtr->capacity ? attrPtr->values.w[id] : attrPtr->defaultValue.w);
+    }
+    return Tcl_NewDoubleObj(GraphsInt_AttrGet(attrPtr, id));
+}
+
+/* Converts a value to the type of a column, into the slot of valuePtr */
+static int AttrParse(Tcl_Interp* interp, GraphsAttrT type, Tcl_Obj* valueObj, void* valuePtr)
+{
+    double d;
+
+    if (type == GRAPHS_ATTR_INT64) {
+        return Tcl_GetWideIntFromObj(interp, valueObj, (Tcl_WideInt*)valuePtr);
+    }
+    if (Tcl_GetDoubleFromObj(interp, valueObj, &d) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    if (type == GRAPHS_ATTR_FLOAT) {
+        *(float*)valuePtr = (float)d;
+    }
+    else {
+        *(double*)valuePtr = d;
+    }
+    return TCL_OK;
+}
+
+/*
+ * Checks that a value can be stored in a column, without storing it
+ */
+int GraphsInt_AttrCheckObj(Tcl_Interp* interp, const GraphsAttr* attrPtr, Tcl_Obj* valueObj)
+{
+    union {
+        double d;
+        Tcl_WideInt w;
+        float f;
+    } value;
+
+    return AttrParse(interp, attrPtr->type, valueObj, &value);
+}
+
+int GraphsInt_AttrSetFromObj(Tcl_Interp* interp, GraphsAttr* attrPtr, int id, Tcl_Obj* valueObj)
+{
+    union {
+        double d;
+        Tcl_WideInt w;
+        float f;
+    } value;
+
+    if (AttrParse(interp, attrPtr->type, valueObj, &value) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    AttrReserve(attrPtr, id);
+    memcpy((char*)attrPtr->values.ptr + id * AttrValueSize(attrPtr->type), &value, AttrValueSize(attrPtr->type));
+    return TCL_OK;
+}
+
+/*
+ * Resolves a node or edge handle to its id, if the entity is a member of the graph
+ */
+static int AttrMemberId(Graph* graphPtr, int kind, Tcl_Obj* handleObj, Tcl_Interp* interp, int* idPtr)
+{
+    if (kind == AttrNodesIx) {
+        Node* nodePtr = Graphs_NodeGetFromObj(graphPtr->statePtr, handleObj);
+        if (nodePtr != NULL && nodePtr->graph == graphPtr) {
+            *idPtr = nodePtr->id;
+            return TCL_OK;
+        }
+    }
+    else {
+        Edge* edgePtr = GraphsInt_EdgeGetFromObj(graphPtr->statePtr, handleObj);
+        if (edgePtr != NULL && Tcl_FindHashEntry(&graphPtr->edges, (ClientData)edgePtr) != NULL) {
+            *idPtr = edgePtr->id;
+            return TCL_OK;
+        }
+    }
+    Tcl_SetObjResult(interp, Tcl_ObjPrintf("%s is not a member of %s", Tcl_GetString(handleObj), graphPtr->cmdName));
+    return TCL_ERROR;
+}
+
+static GraphsAttr* AttrGetColumn(Graph* graphPtr, int kind, Tcl_Obj* nameObj, Tcl_Interp* interp)
+{
+    GraphsAttr* attrPtr = GraphsInt_AttrFind(kind == AttrNodesIx ? &graphPtr->nodeAttrs : &graphPtr->edgeAttrs,
+        Tcl_GetString(nameObj));
+
+    if (attrPtr == NULL) {
+        Tcl_SetObjResult(interp, Tcl_ObjPrintf("no %s attribute \"%s\" in %s", kind == AttrNodesIx ? "node" : "edge",
+            Tcl_GetString(nameObj), graphPtr->cmdName));
+    }
+    return attrPtr;
+}
+
+/* [$graph attrs declare nodes|edges <name> double|int64|float ?default?] */
+static int AttrCmdDeclare(Graph* graphPtr, int kind, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[])
+{
+    Tcl_HashTable* tablePtr = (kind == AttrNodesIx) ? &graphPtr->nodeAttrs : &graphPtr->edgeAttrs;
+    GraphsAttr* attrPtr;
+    Tcl_HashEntry* entry;
+    int type, new;
+
+    if (objc < 2 || objc > 3) {
+        Tcl_WrongNumArgs(interp, 0, objv, "declare nodes|edges <name> double|int64|float ?default?");
+        return TCL_ERROR;
+    }
+    if (Tcl_GetIndexFromObj(interp, objv[1], AttrTypeNames, "type", 0, &type) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    if (GraphsInt_AttrFind(tablePtr, Tcl_GetString(objv[0])) != NULL) {
+        Tcl_SetObjResult(interp, Tcl_ObjPrintf("attribute \"%s\" exists already", Tcl_GetString(objv[0])));
+        return TCL_ERROR;
+    }
+
+    attrPtr = (GraphsAttr*)ckalloc(sizeof(GraphsAttr));
+    attrPtr->type = (GraphsAttrT)type;
+    attrPtr->capacity = 0;
+    attrPtr->values.ptr = NULL;
+    memset(&attrPtr->defaultValue, 0, sizeof(attrPtr->defaultValue));
+    if (objc == 3 && AttrParse(interp, attrPtr->type, objv[2], &attrPtr->defaultValue) != TCL_OK) {
+        ckfree((char*)attrPtr);
+        return TCL_ERROR;
+    }
+    entry = Tcl_CreateHashEntry(tablePtr, Tcl_GetString(objv[0]), &new);
+    Tcl_SetHashValue(entry, attrPtr);
+    return TCL_OK;
+}
+
+static int AttrNameCompare(const void* a, const void* b)
+{
+    return strcmp(*(const char* const*)a, *(const char* const*)b);
+}
+
+/* [$graph attrs names nodes|edges]: the declared columns as a dict of name and type, sorted by name */
+static int AttrCmdNames(Graph* graphPtr, int kind, Tcl_Interp* interp)
+{
+    Tcl_HashTable* tablePtr = (kind == AttrNodesIx) ? &graphPtr->nodeAttrs : &graphPtr->edgeAttrs;
+    Tcl_HashSearch search;
+    Tcl_Obj* result = Tcl_NewListObj(0, NULL);
+    const char** names = (const char**)ckalloc(tablePtr->numEntries * sizeof(char*) + 1);
+    int count = 0;
+
+    for (Tcl_HashEntry* entry = Tcl_FirstHashEntry(tablePtr, &search); entry != NULL;
+        entry = Tcl_NextHashEntry(&search)) {
+        names[count++] = Tcl_GetHashKey(tablePtr, entry);
+    }
+    qsort(names, count, sizeof(char*), AttrNameCompare);
+    for (int i = 0; i < count; i++) {
+        GraphsAttr* attrPtr = GraphsInt_AttrFind(tablePtr, names[i]);
+        Tcl_ListObjAppendElement(NULL, result, Tcl_NewStringObj(names[i], -1));
+        Tcl_ListObjAppendElement(NULL, result, Tcl_NewStringObj(AttrTypeNames[attrPtr->type], -1));
+    }
+    ckfree((char*)names);
+    Tcl_SetObjResult(interp, result);
+    return TCL_OK;
+}
+
+/*
+ * [$graph attrs get nodes|edges <name> ?handles?]: without handles a dict of all members and their values,
+ * otherwise the list of values of the given members
+ */
+static int AttrCmdGet(Graph* graphPtr, int kind, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[])
+{
+    GraphsAttr* attrPtr;
+    Tcl_Obj* result;
+
+    if (objc < 1 || objc > 2) {
+        Tcl_WrongNumArgs(interp, 0, objv, "get nodes|edges <name> ?handles?");
+        return TCL_ERROR;
+    }
+    if ((attrPtr = AttrGetColumn(graphPtr, kind, objv[0], interp)) == NULL) {
+        return TCL_ERROR;
+    }
+
+    result = Tcl_NewListObj(0, NULL);
+    if (objc == 2) {
+        Tcl_Obj** handles;
+        int count, id;
+
+        if (Tcl_ListObjGetElements(interp, objv[1], &count, &handles) != TCL_OK) {
+            Tcl_DecrRefCount(result);
+            return TCL_ERROR;
+        }
+        for (int i = 0; i < count; i++) {
+            if (AttrMemberId(graphPtr, kind, handles[i], interp, &id) != TCL_OK) {
+                Tcl_DecrRefCount(result);
+                return TCL_ERROR;
+            }
+            Tcl_ListObjAppendElement(NULL, result, GraphsInt_AttrGetObj(attrPtr, id));
+        }
+    }
+    else {
+        Tcl_HashTable* membersPtr = (kind == AttrNodesIx) ? &graphPtr->nodes : &graphPtr->edges;
+        Tcl_HashSearch search;
+
+        for (Tcl_HashEntry* entry = Tcl_FirstHashEntry(membersPtr, &search); entry != NULL;
+            entry = Tcl_NextHashEntry(&search)) {
+            if (kind == AttrNodesIx) {
+                Node* nodePtr = (Node*)Tcl_GetHashValue(entry);
+                Tcl_ListObjAppendElement(NULL, result, GraphsInt_NodeHandleObj(nodePtr));
+                Tcl_ListObjAppendElement(NULL, result, GraphsInt_AttrGetObj(attrPtr, nodePtr->id));
+            }
+            else {
+                Edge* edgePtr = (Edge*)Tcl_GetHashValue(entry);
+                Tcl_ListObjAppendElement(NULL, result, GraphsInt_EdgeHandleObj(edgePtr));
+                Tcl_ListObjAppendElement(NULL, result, GraphsInt_AttrGetObj(attrPtr, edgePtr->id));
+            }
+        }
+    }
+    Tcl_SetObjResult(interp, result);
+    return TCL_OK;
+}
+
+/*
+ * [$graph attrs set nodes|edges <name> <dict>]: sets the values of the members in a dict of handles and
+ * values. All handles and values are checked before the first value is written.
+ */
+static int AttrCmdSet(Graph* graphPtr, int kind, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[])
+{
+    GraphsAttr* attrPtr;
+    Tcl_Obj** pairs;
+    int count, *ids;
+    void* values;
+    size_t size;
+
+    if (objc != 2) {
+        Tcl_WrongNumArgs(interp, 0, objv, "set nodes|edges <name> <dict>");
+        return TCL_ERROR;
+    }
+    if ((attrPtr = AttrGetColumn(graphPtr, kind, objv[0], interp)) == NULL
+        || Tcl_ListObjGetElements(interp, objv[1], &count, &pairs) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    if (count % 2) {
+        Tcl_SetObjResult(interp, Tcl_NewStringObj("missing value to go with handle", -1));
+        return TCL_ERROR;
+    }
+
+    size = AttrValueSize(attrPtr->type);
+    ids = (int*)ckalloc((count / 2) * sizeof(int) + 1);
+    values = ckalloc((count / 2) * size + 1);
+    for (int i = 0; i < count; i += 2) {
+        if (AttrMemberId(graphPtr, kind, pairs[i], interp, &ids[i / 2]) != TCL_OK
+            || AttrParse(interp, attrPtr->type, pairs[i + 1], (char*)values + (i / 2) * size) != TCL_OK) {
+            ckfree((char*)ids);
+            ckfree((char*)values);
+            return TCL_ERROR;
+        }
+    }
+    for (int i = 0; i < count / 2; i++) {
+        AttrReserve(attrPtr, ids[i]);
+        memcpy((char*)attrPtr->values.ptr + ids[i] * size, (char*)values + i * size, size);
+    }
+    ckfree((char*)ids);
+    ckfree((char*)values);
+    Tcl_SetObjResult(interp, Tcl_NewIntObj(count / 2));
+    return TCL_OK;
+}
+
+/*
+ * Implements [$graph attrs declare|forget|names|get|set nodes|edges ...]
+ */
+int GraphsInt_GraphCmdAttrs(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[])
+{
+    static const char* subCmds[] = { "declare", "forget", "names", "get", "set", NULL };
+    enum SubCmdIx
+    {
+        DeclareIx,
+        ForgetIx,
+        NamesIx,
+        GetIx,
+        SetIx
+    };
+    int cmdIdx, kind;
+
+    if (objc < 2) {
+        Tcl_WrongNumArgs(interp, 0, objv, "declare|forget|names|get|set nodes|edges ?arg ...?");
+        return TCL_ERROR;
+    }
+    if (Tcl_GetIndexFromObj(interp, objv[0], subCmds, "subcommand", 0, &cmdIdx) != TCL_OK
+        || Tcl_GetIndexFromObj(interp, objv[1], AttrKinds, "kind", 0, &kind) != TCL_OK) {
+        return TCL_ERROR;
+    }
+
+    switch (cmdIdx) {
+    case DeclareIx:
+        return AttrCmdDeclare(graphPtr, kind, interp, objc - 2, objv + 2);
+    case ForgetIx: {
+        Tcl_HashTable* tablePtr = (kind == AttrNodesIx) ? &graphPtr->nodeAttrs : &graphPtr->edgeAttrs;
+        Tcl_HashEntry* entry;
+
+        if (objc != 3) {
+            Tcl_WrongNumArgs(interp, 0, objv, "forget nodes|edges <name>");
+            return TCL_ERROR;
+        }
+        if (AttrGetColumn(graphPtr, kind, objv[2], interp) == NULL) {
+            return TCL_ERROR;
+        }
+        entry = Tcl_FindHashEntry(tablePtr, Tcl_GetString(objv[2]));
+        AttrFree((GraphsAttr*)Tcl_GetHashValue(entry));
+        Tcl_DeleteHashEntry(entry);
+        return TCL_OK;
+    }
+    case NamesIx:
+        if (objc != 2) {
+            Tcl_WrongNumArgs(interp, 0, objv, "names nodes|edges");
+            return TCL_ERROR;
+        }
+        return AttrCmdNames(graphPtr, kind, interp);
+    case GetIx:
+        return AttrCmdGet(graphPtr, kind, interp, objc - 2, objv + 2);
+    case SetIx:
+        return AttrCmdSet(graphPtr, kind, interp, objc - 2, objv + 2);
+    default:
+        break;
+    }
+    return TCL_ERROR;
+}
@@ -0,0 +1,475 @@
+/*
+ * Breadth-first search
+ *
+ * [$graph bfs <source> ?-direction out|in|both? ?-maxdepth <depth>? ?-threads <count>? ?filter?] finds the
+ * hop distances from a member node over the CSR snapshot of the graph, following the outgoing arcs (out, the
+ * default), the incoming arcs (in) or both. Hidden nodes and edges are skipped, and so are edges not matching
+ * the filter, one of -name <pattern>, -labels <label ...> or -notlabels <label ...>. With -maxdepth the
+ * search does not go beyond nodes that many hops away from the source.
+ *
+ * The search is direction optimizing: as long as the frontier is small it is expanded top-down, over the arcs
+ * leaving it. Once these arcs outnumber a fraction of the arcs of the unvisited nodes, the search switches to
+ * bottom-up steps, in which every unvisited node looks for a parent in the frontier over the arcs of the
+ * other direction and stops at the first one found, and back when the frontier has shrunk again. With
+ * -threads <count> the bottom-up steps on graphs with at least [::graphs::configure -parallelarcs] arcs are
+ * split into slices of nodes done by a fixed set of threads, which wait for the next bottom-up step in
+ * between. Every thread only writes to the nodes of its slice, so the result does not depend on the number
+ * of threads.
+ *
+ * The result is a dict of all reached nodes, ordered by level, to a list of their level, the node they are
+ * reached from and the edge through which, both empty for the source.
+ */
+#include "graphsInt.h"
+#include <string.h>
+
+/*
+ * Bottom-up steps start when the arcs of the frontier exceed 1/BFS_ALPHA of the arcs of the unvisited nodes
+ * and end when the frontier holds less than 1/BFS_BETA of the nodes
+ */
+#define BFS_ALPHA 14
+#define BFS_BETA 24
+
+/*
+ * The arcs of the snapshot in one direction. With a filter usable[] flags the arcs that may be followed.
+ */
+typedef struct _bfsArcs
+{
+    const int* offsets;
+    const int* ends;
+    Edge** edges;
+    const char* usable;
+} BfsArcs;
+
+/*
+ * A search: the forward arcs lead away from the source, backward[i] are the arcs of forward[i] seen from their
+ * other end. -direction both uses two lists of each. level[] is -1 for unvisited and -2 for hidden nodes.
+ */
+typedef struct _bfsSearch
+{
+    const GraphSnapshot* snapPtr;
+    BfsArcs forward[2];
+    BfsArcs backward[2];
+    int lists;
+    int* level;
+    int* parent;
+    Edge** via;
+} BfsSearch;
+
+/* A slice of the nodes for bottom-up steps, with the number of nodes it visited and their arcs */
+typedef struct _bfsSlice
+{
+    BfsSearch* searchPtr;
+    const char* frontier;
+    char* next;
+    int depth;
+    int from;
+    int to;
+    int count;
+    Tcl_WideInt arcs;
+} BfsSlice;
+
+static const char* BfsOptions[] = { "-direction", "-maxdepth", "-threads", "-name", "-labels", "-notlabels",
+    NULL };
+enum BfsOptionIx
+{
+    BfsDirectionIx,
+    BfsMaxDepthIx,
+    BfsThreadsIx,
+    BfsFilterIx
+};
+
+static void BfsArcsInit(BfsArcs* arcsPtr, const GraphSnapshot* snapPtr, int incoming, const char* usable)
+{
+    arcsPtr->offsets = incoming ? snapPtr->inOffsets : snapPtr->outOffsets;
+    arcsPtr->ends = incoming ? snapPtr->inSources : snapPtr->outTargets;
+    arcsPtr->edges = incoming ? snapPtr->inEdges : snapPtr->outEdges;
+    arcsPtr->usable = usable;
+}
+
+/* Flags the arcs whose edges are not hidden and match the filter */
+static char* BfsUsable(const GraphSnapshot* snapPtr, Edge** edges, const struct LabelFilter* lblFiltPtr)
+{
+    char* usable = (char*)ckalloc(snapPtr->edgeCount + 1);
+
+    for (int k = 0; k < snapPtr->edgeCount; k++) {
+        int matches = 0;
+
+        GraphsInt_MatchesLabels(&edges[k]->labels, edges[k]->name, lblFiltPtr, &matches);
+        usable[k] = matches && (edges[k]->marks & GRAPHS_MARK_HIDDEN) == 0;
+    }
+    return usable;
+}
+
+/* Whether an arc may be followed, the node it leads to is checked through its level */
+static int BfsArcUsable(const BfsArcs* arcsPtr, int k)
+{
+    if (arcsPtr->usable != NULL) {
+        return arcsPtr->usable[k];
+    }
+    return (arcsPtr->edges[k]->marks & GRAPHS_MARK_HIDDEN) == 0;
+}
+
+/* The number of forward arcs of a node */
+static int BfsDegree(const BfsSearch* searchPtr, int v)
+{
+    int degree = 0;
+
+    for (int l = 0; l < searchPtr->lists; l++) {
+        degree += searchPtr->forward[l].offsets[v + 1] - searchPtr->forward[l].offsets[v];
+    }
+    return degree;
+}
+
+static void BfsVisit(BfsSearch* searchPtr, int v, int depth, int u, Edge* edgePtr)
+{
+    searchPtr->level[v] = depth;
+    searchPtr->parent[v] = u;
+    searchPtr->via[v] = edgePtr;
+}
+
+/*
+ * Top-down step: visits the unvisited neighbors of the frontier queue[head .. *tailPtr-1] and appends them to
+ * the queue. Returns the number of forward arcs of the visited nodes.
+ */
+static Tcl_WideInt BfsTopDown(BfsSearch* searchPtr, int* queue, int head, int* tailPtr, int depth)
+{
+    Tcl_WideInt arcs = 0;
+    int end = *tailPtr, tail = *tailPtr;
+
+    for (int i = head; i < end; i++) {
+        int u = queue[i];
+
+        for (int l = 0; l < searchPtr->lists; l++) {
+            const BfsArcs* arcsPtr = &searchPtr->forward[l];
+
+            for (int k = arcsPtr->offsets[u]; k < arcsPtr->offsets[u + 1]; k++) {
+                int v = arcsPtr->ends[k];
+
+                if (searchPtr->level[v] == -1 && BfsArcUsable(arcsPtr, k)) {
+                    BfsVisit(searchPtr, v, depth, u, arcsPtr->edges[k]);
+                    queue[tail++] = v;
+                    arcs += BfsDegree(searchPtr, v);
+                }
+            }
+        }
+    }
+    *tailPtr = tail;
+    return arcs;
+}
+
+/* Bottom-up step on a slice: every unvisited node of the slice takes the first parent found in the frontier */
+static void BfsBottomUpRun(void* item)
+{
+    BfsSlice* slicePtr = (BfsSlice*)item;
+    BfsSearch* searchPtr = slicePtr->searchPtr;
+
+    slicePtr->count = 0;
+    slicePtr->arcs = 0;
+    for (int v = slicePtr->from; v < slicePtr->to; v++) {
+        slicePtr->next[v] = 0;
+        if (searchPtr->level[v] != -1) {
+            continue;
+        }
+        for (int l = 0; l < searchPtr->lists && slicePtr->next[v] == 0; l++) {
+            const BfsArcs* arcsPtr = &searchPtr->backward[l];
+
+            for (int k = arcsPtr->offsets[v]; k < arcsPtr->offsets[v + 1]; k++) {
+                int u = arcsPtr->ends[k];
+
+                if (slicePtr->frontier[u] && BfsArcUsable(arcsPtr, k)) {
+                    BfsVisit(searchPtr, v, slicePtr->depth, u, arcsPtr->edges[k]);
+                    slicePtr->next[v] = 1;
+                    slicePtr->count++;
+                    slicePtr->arcs += BfsDegree(searchPtr, v);
+                    break;
+                }
+            }
+        }
+    }
+}
+
+/*
+ * Bottom-up step over all slices, the first one by this thread and the others by the workers. Returns the
+ * number of forward arcs of the visited nodes, and their number in *countPtr.
+ */
+static Tcl_WideInt BfsBottomUp(BfsSlice* slices, GraphsWorkers* workers, int sliceCount, const char* frontier,
+    char* next, int depth, int* countPtr)
+{
+    Tcl_WideInt arcs = 0;
+
+    for (int t = 0; t < sliceCount; t++) {
+        slices[t].frontier = frontier;
+        slices[t].next = next;
+        slices[t].depth = depth;
+    }
+    GraphsInt_WorkersRun(workers);
+    *countPtr = 0;
+    for (int t = 0; t < sliceCount; t++) {
+        *countPtr += slices[t].count;
+        arcs += slices[t].arcs;
+    }
+    return arcs;
+}
+
+/* Splits the nodes into slices with about the same number of backward arcs */
+static void BfsSlicesInit(BfsSearch* searchPtr, BfsSlice* slices, int sliceCount)
+{
+    int n = searchPtr->snapPtr->nodeCount;
+    Tcl_WideInt total = 0;
+
+    for (int l = 0; l < searchPtr->lists; l++) {
+        total += searchPtr->backward[l].offsets[n];
+    }
+    for (int t = 0, v = 0; t < sliceCount; t++) {
+        slices[t].searchPtr = searchPtr;
+        slices[t].from = v;
+        while (v < n && t < sliceCount - 1) {
+            Tcl_WideInt before = 0;
+
+            for (int l = 0; l < searchPtr->lists; l++) {
+                before += searchPtr->backward[l].offsets[v];
+            }
+            if (before >= total * (t + 1) / sliceCount) {
+                break;
+            }
+            v++;
+        }
+        slices[t].to = (t == sliceCount - 1) ? n : v;
+    }
+}
+
+/*
+ * Runs the search from source, at most maxDepth levels deep if that is not negative. Graphs with less than
+ * parallelArcs arcs are searched by one thread. Returns the deepest level reached.
+ */
+static int BfsRun(BfsSearch* searchPtr, int source, int maxDepth, int threads, int parallelArcs)
+{
+    int n = searchPtr->snapPtr->nodeCount;
+    int* queue = (int*)ckalloc(n * sizeof(int) + 1);
+    char* frontier = NULL;
+    char* next = NULL;
+    BfsSlice* slices = NULL;
+    GraphsWorkers* workers = NULL;
+    Tcl_WideInt frontierArcs, unvisitedArcs = 0;
+    int head = 0, tail = 0, count = 1, depth = 0, bottomUp = 0;
+
+    for (int l = 0; l < searchPtr->lists; l++) {
+        unvisitedArcs += searchPtr->forward[l].offsets[n];
+    }
+    if (threads > 1 && unvisitedArcs < parallelArcs) {
+        threads = 1;
+    }
+    BfsVisit(searchPtr, source, 0, -1, NULL);
+    queue[tail++] = source;
+    frontierArcs = BfsDegree(searchPtr, source);
+    unvisitedArcs -= frontierArcs;
+
+    while (count > 0 && (maxDepth < 0 || depth < maxDepth)) {
+        depth++;
+        if (!bottomUp && frontierArcs > unvisitedArcs / BFS_ALPHA) {
+            if (frontier == NULL) {
+                frontier = ckalloc(n + 1);
+                next = ckalloc(n + 1);
+                slices = (BfsSlice*)ckalloc(threads * sizeof(BfsSlice));
+                BfsSlicesInit(searchPtr, slices, threads);
+                workers = GraphsInt_WorkersStart(threads, BfsBottomUpRun, slices, sizeof(BfsSlice));
+            }
+            memset(frontier, 0, n);
+            for (int i = head; i < tail; i++) {
+                frontier[queue[i]] = 1;
+            }
+            bottomUp = 1;
+        }
+        else if (bottomUp && count < n / BFS_BETA) {
+            head = tail = 0;
+            for (int v = 0; v < n; v++) {
+                if (frontier[v]) {
+                    queue[tail++] = v;
+                }
+            }
+            bottomUp = 0;
+        }
+
+        if (bottomUp) {
+            char* swap;
+
+            frontierArcs = BfsBottomUp(slices, workers, threads, frontier, next, depth, &count);
+            swap = frontier;
+            frontier = next;
+            next = swap;
+        }
+        else {
+            int end = tail;
+
+            frontierArcs = BfsTopDown(searchPtr, queue, head, &tail, depth);
+            head = end;
+            count = tail - head;
+        }
+        unvisitedArcs -= frontierArcs;
+    }
+    if (count == 0) {
+        depth--;
+    }
+
+    ckfree((char*)queue);
+    if (frontier != NULL) {
+        GraphsInt_WorkersStop(workers);
+        ckfree(frontier);
+        ckfree(next);
+        ckfree((char*)slices);
+    }
+    return depth;
+}
+
+/* The dict of reached nodes to {level parent edge}, ordered by level */
+static Tcl_Obj* BfsResultObj(const BfsSearch* searchPtr, int depth)
+{
+    const GraphSnapshot* snapPtr = searchPtr->snapPtr;
+    int n = snapPtr->nodeCount;
+    int* starts = (int*)ckalloc((depth + 2) * sizeof(int));
+    int* order = (int*)ckalloc(n * sizeof(int) + 1);
+    Tcl_Obj* result = Tcl_NewListObj(0, NULL);
+
+    memset(starts, 0, (depth + 2) * sizeof(int));
+    for (int v = 0; v < n; v++) {
+        if (searchPtr->level[v] >= 0) {
+            starts[searchPtr->level[v] + 1]++;
+        }
+    }
+    for (int d = 0; d <= depth; d++) {
+        starts[d + 1] += starts[d];
+    }
+    for (int v = 0; v < n; v++) {
+        if (searchPtr->level[v] >= 0) {
+            order[starts[searchPtr->level[v]]++] = v;
+        }
+    }
+
+    for (int i = 0; i < starts[depth]; i++) {
+        int v = order[i];
+        Tcl_Obj* triple[3];
+
+        triple[0] = Tcl_NewIntObj(searchPtr->level[v]);
+        triple[1] = (searchPtr->parent[v] < 0) ? Tcl_NewObj()
+                                               : GraphsInt_NodeHandleObj(snapPtr->nodes[searchPtr->parent[v]]);
+        triple[2] = (searchPtr->via[v] == NULL) ? Tcl_NewObj() : GraphsInt_EdgeHandleObj(searchPtr->via[v]);
+        Tcl_ListObjAppendElement(NULL, result, GraphsInt_NodeHandleObj(snapPtr->nodes[v]));
+        Tcl_ListObjAppendElement(NULL, result, Tcl_NewListObj(3, triple));
+    }
+    ckfree((char*)starts);
+    ckfree((char*)order);
+    return result;
+}
+
+/*
+ * Implements [$graph bfs <source> ?-direction out|in|both? ?-maxdepth <depth>? ?-threads <count>? ?filter?]
+ */
+int GraphsInt_GraphCmdBfs(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[])
+{
+    static const char* directions[] = { "out", "in", "both", NULL };
+    enum DirectionIx
+    {
+        OutIx,
+        InIx,
+        BothIx
+    };
+    const GraphSnapshot* snapPtr;
+    struct LabelFilter lblFilt;
+    BfsSearch search;
+    Node* nodePtr;
+    char* outUsable = NULL;
+    char* inUsable = NULL;
+    int source, direction = OutIx, maxDepth = -1, threads = 1, n, depth;
+
+    if (objc < 1) {
+        Tcl_WrongNumArgs(interp, 0, objv, "<source> ?-direction out|in|both? ?-maxdepth <depth>? "
+            "?-threads <count>? ?filter?");
+        return TCL_ERROR;
+    }
+    snapPtr = Graphs_GraphGetSnapshot(graphPtr);
+    nodePtr = Graphs_NodeGetFromObj(graphPtr->statePtr, objv[0]);
+    if (nodePtr == NULL || (source = GraphsInt_SnapshotNodeId(snapPtr, nodePtr)) < 0) {
+        Tcl_SetObjResult(interp, Tcl_ObjPrintf("%s is not a node of %s", Tcl_GetString(objv[0]),
+            graphPtr->cmdName));
+        return TCL_ERROR;
+    }
+    objc--;
+    objv++;
+
+    while (objc > 0) {
+        int optIdx, result;
+
+        if (Tcl_GetIndexFromObj(interp, objv[0], BfsOptions, "option", 0, &optIdx) != TCL_OK) {
+            return TCL_ERROR;
+        }
+        if (optIdx >= BfsFilterIx) {
+            break;
+        }
+        if (objc < 2) {
+            Tcl_SetObjResult(interp, Tcl_ObjPrintf("missing value for option %s", BfsOptions[optIdx]));
+            return TCL_ERROR;
+        }
+        switch (optIdx) {
+        case BfsDirectionIx:
+            result = Tcl_GetIndexFromObj(interp, objv[1], directions, "direction", 0, &direction);
+            break;
+        case BfsMaxDepthIx:
+            result = Tcl_GetIntFromObj(interp, objv[1], &maxDepth);
+            if (result == TCL_OK && maxDepth < 0) {
+                Tcl_SetObjResult(interp, Tcl_NewStringObj("-maxdepth must not be negative", -1));
+                result = TCL_ERROR;
+            }
+            break;
+        case BfsThreadsIx:
+            result = GraphsInt_PathsGetThreads(interp, objv[1], &threads);
+            break;
+        default:
+            result = TCL_ERROR;
+            break;
+        }
+        if (result != TCL_OK) {
+            return TCL_ERROR;
+        }
+        objc -= 2;
+        objv += 2;
+    }
+    if (GraphsInt_PathsFilterInit(graphPtr, interp, objc, objv, &lblFilt) != TCL_OK) {
+        return TCL_ERROR;
+    }
+
+    /* the filter is evaluated up front, the threads then only read flags */
+    if (lblFilt.filterType != LABELS_ALL_IDX) {
+        outUsable = BfsUsable(snapPtr, snapPtr->outEdges, &lblFilt);
+        inUsable = BfsUsable(snapPtr, snapPtr->inEdges, &lblFilt);
+    }
+    GraphsInt_LabelFilterFree(&lblFilt);
+
+    search.snapPtr = snapPtr;
+    search.lists = (direction == BothIx) ? 2 : 1;
+    BfsArcsInit(&search.forward[0], snapPtr, direction == InIx, direction == InIx ? inUsable : outUsable);
+    BfsArcsInit(&search.backward[0], snapPtr, direction != InIx, direction != InIx ? inUsable : outUsable);
+    if (direction == BothIx) {
+        BfsArcsInit(&search.forward[1], snapPtr, 1, inUsable);
+        BfsArcsInit(&search.backward[1], snapPtr, 0, outUsable);
+    }
+
+    n = snapPtr->nodeCount;
+    search.level = (int*)ckalloc(n * sizeof(int) + 1);
+    search.parent = (int*)ckalloc(n * sizeof(int) + 1);
+    search.via = (Edge**)ckalloc(n * sizeof(Edge*) + 1);
+    for (int v = 0; v < n; v++) {
+        search.level[v] = (snapPtr->nodes[v]->marks & GRAPHS_MARK_HIDDEN) != 0 ? -2 : -1;
+    }
+
+    depth = BfsRun(&search, source, maxDepth, threads, graphPtr->statePtr->parallelArcs);
+    Tcl_SetObjResult(interp, BfsResultObj(&search, depth));
+
+    ckfree((char*)search.level);
+    ckfree((char*)search.parent);
+    ckfree((char*)search.via);
+    if (outUsable != NULL) {
+        ckfree(outUsable);
+        ckfree(inUsable);
+    }
+    return TCL_OK;
+}
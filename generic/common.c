@@ -2,6 +2,7 @@
  * Common procedures for entities
  */
 #include "graphsInt.h"
+#include <string.h>
 
 int GraphsInt_CheckCommandExists(Tcl_Interp* interp, const char* cmdName)
 {
@@ -18,6 +19,38 @@ int GraphsInt_CheckCommandExists(Tcl_Interp* interp, const char* cmdName)
 
 }
 
+/*
+ * Whether a -name argument is a glob pattern, rather than a name to be looked up exactly
+ */
+int GraphsInt_IsGlobPattern(const char* pattern)
+{
+    return strpbrk(pattern, "*?[\\") != NULL;
+}
+
+/*
+ * Names of nodes and edges. Most entities have no name, they share one empty string instead of an allocation.
+ */
+static char emptyName[] = "";
+
+void GraphsInt_NameSet(char** nameRef, const char* name)
+{
+    size_t length = strlen(name);
+
+    GraphsInt_NameFree(nameRef);
+    if (length > 0) {
+        *nameRef = (char*)ckalloc(length + 1);
+        memcpy(*nameRef, name, length + 1);
+    }
+}
+
+void GraphsInt_NameFree(char** nameRef)
+{
+    if (*nameRef != NULL && *nameRef != emptyName) {
+        ckfree(*nameRef);
+    }
+    *nameRef = emptyName;
+}
+
 Graph* Graphs_GraphGetByCommand(const GraphState* statePtr, const char* gName)
 {
     Tcl_HashEntry* entry = Tcl_FindHashEntry(&((GraphState*)statePtr)->graphs, gName);
@@ -31,49 +64,122 @@ Graphs_NodeGetByCommand(const GraphState* statePtr, const char* nName)
     return (entry == NULL) ? NULL : (Node*)Tcl_GetHashValue(entry);
 }
 
-void Graphs_NodeAddToGraph(Graph* graphPtr, Node* nodePtr)
+Edge* GraphsInt_EdgeGetByCommand(const GraphState* statePtr, const char* eName)
+{
+    Tcl_HashEntry* entry = Tcl_FindHashEntry(&((GraphState*)statePtr)->edges, eName);
+    return (entry == NULL) ? NULL : (Edge*)Tcl_GetHashValue(entry);
+}
+
+/*
+ * Moves a node from its graph to graphPtr (which may be NULL) in the node tables and indexes of both
+ * graphs. The edges of the node are not touched, see NodeRefreshEdges().
+ */
+static void NodeSetGraph(Node* nodePtr, Graph* graphPtr)
 {
+    Graph* oldGraphPtr = nodePtr->graph;
     int new;
-    Tcl_HashEntry* entry;
 
-    /* remove  old graph, if present */
-    if (nodePtr->graph != NULL) {
-        Tcl_HashEntry* nodeEntry = Tcl_FindHashEntry(&nodePtr->graph->nodes, nodePtr->cmdName);
-        if (nodeEntry != NULL) {
-            Tcl_DeleteHashEntry(nodeEntry);
-        }
+    if (oldGraphPtr == graphPtr) {
+        return;
     }
+    GraphsInt_SnapshotInvalidate(oldGraphPtr);
+    GraphsInt_SnapshotInvalidate(graphPtr);
 
+    if (oldGraphPtr != NULL) {
+        Tcl_HashEntry* entry = Tcl_FindHashEntry(&oldGraphPtr->nodes, nodePtr->cmdName);
+        if (entry != NULL) {
+            Tcl_DeleteHashEntry(entry);
+            GraphsInt_LabelIndexUpdateAll(&oldGraphPtr->nodesByLabel, &nodePtr->labels, nodePtr, 0);
+            GraphsInt_IndexRemove(&oldGraphPtr->nodesByName, nodePtr->name, nodePtr);
+            GraphsInt_AttrsReset(&oldGraphPtr->nodeAttrs, nodePtr->id);
+            oldGraphPtr->order--;
+        }
+    }
     if (graphPtr != NULL) {
-        entry = Tcl_CreateHashEntry(&graphPtr->nodes, nodePtr->cmdName, &new);
+        Tcl_HashEntry* entry = Tcl_CreateHashEntry(&graphPtr->nodes, nodePtr->cmdName, &new);
         if (new) {
             Tcl_SetHashValue(entry, nodePtr);
+            GraphsInt_LabelIndexUpdateAll(&graphPtr->nodesByLabel, &nodePtr->labels, nodePtr, 1);
+            GraphsInt_IndexAdd(&graphPtr->nodesByName, nodePtr->name, nodePtr);
+            graphPtr->order++;
         }
-        graphPtr->order++;
     }
     nodePtr->graph = graphPtr;
 }
 
-void Graphs_NodeDeleteFromGraph(Graph* graphPtr, Node* nodePtr)
+/*
+ * Updates the edge tables and cuts of the old and the new graph of a node for all its edges, after
+ * the node was moved with NodeSetGraph(). O(degree of the node).
+ */
+static void NodeRefreshEdges(Node* nodePtr, Graph* oldGraphPtr)
 {
-    if (nodePtr->graph == graphPtr) {
-        Tcl_HashEntry* entry = Tcl_FindHashEntry(&graphPtr->nodes, (ClientData) nodePtr);
-        if (entry != NULL) {
-            Tcl_DeleteHashEntry(entry);
+    for (DeltaEntry* entry = nodePtr->outgoing; entry != NULL; entry = entry->next) {
+        GraphsInt_EdgeRefreshGraph(entry->edgePtr, oldGraphPtr);
+        GraphsInt_EdgeRefreshGraph(entry->edgePtr, nodePtr->graph);
+    }
+    for (DeltaEntry* entry = nodePtr->incoming; entry != NULL; entry = entry->next) {
+        GraphsInt_EdgeRefreshGraph(entry->edgePtr, oldGraphPtr);
+        GraphsInt_EdgeRefreshGraph(entry->edgePtr, nodePtr->graph);
+    }
+}
+
+void Graphs_NodeAddToGraph(Graph* graphPtr, Node* nodePtr)
+{
+    Graph* oldGraphPtr = nodePtr->graph;
+
+    if (oldGraphPtr != graphPtr) {
+        NodeSetGraph(nodePtr, graphPtr);
+        NodeRefreshEdges(nodePtr, oldGraphPtr);
+    }
+}
+
+/*
+ * Moves a batch of nodes into a graph. All nodes are moved before the edges are updated, so edges between
+ * nodes of the batch go to the new graph directly instead of passing through the cuts of the old graphs.
+ */
+void GraphsInt_NodesAddToGraph(Graph* graphPtr, Node* const nodes[], int count)
+{
+    Graph** oldGraphs = (Graph**)ckalloc(count * sizeof(Graph*) + 1);
+
+    for (int i = 0; i < count; i++) {
+        oldGraphs[i] = nodes[i]->graph;
+        NodeSetGraph(nodes[i], graphPtr);
+    }
+    for (int i = 0; i < count; i++) {
+        /* nodes listed twice were moved with their first occurrence */
+        if (oldGraphs[i] != graphPtr) {
+            NodeRefreshEdges(nodes[i], oldGraphs[i]);
         }
-        nodePtr->graph = NULL;
-        graphPtr->order--;
+    }
+    ckfree((char*)oldGraphs);
+}
+
+void Graphs_NodeDeleteFromGraph(Graph* graphPtr, Node* nodePtr)
+{
+    if (graphPtr != NULL && nodePtr->graph == graphPtr) {
+        NodeSetGraph(nodePtr, NULL);
+        NodeRefreshEdges(nodePtr, graphPtr);
     }
 }
 
 void Graphs_EdgeDeleteEdge(Edge* edgePtr, Tcl_Interp* interp)
 {
-    Tcl_DeleteCommandFromToken(interp, edgePtr->commandTkn);
+    if (edgePtr->commandTkn != NULL) {
+        Tcl_DeleteCommandFromToken(interp, edgePtr->commandTkn);
+    }
+    else {
+        GraphsInt_EdgeDestroyCmd((ClientData)edgePtr);
+    }
 }
 
 void Graphs_NodeDeleteNode(Node* nodePtr, Tcl_Interp* interp)
 {
-    Tcl_DeleteCommandFromToken(interp, nodePtr->commandTkn);
+    if (nodePtr->commandTkn != NULL) {
+        Tcl_DeleteCommandFromToken(interp, nodePtr->commandTkn);
+    }
+    else {
+        GraphsInt_NodeDestroyCmd((ClientData)nodePtr);
+    }
 }
 
 /*
@@ -81,50 +187,36 @@ void Graphs_NodeDeleteNode(Node* nodePtr, Tcl_Interp* interp)
  *
  * \param labels Hashtable with the labels
  * \param name Name to match
- * \param labelFilt The labelfilter with type and arguments to match against
+ * \param lblFiltPtr The labelfilter with type and arguments to match against
  * \param matchPtr int pointer for the result
  * 
  * \return TCL_OK or TCL_ERROR if the labels filter applies, 0 otherwise
  *
  */
-int GraphsInt_MatchesLabels(const Tcl_HashTable* labels, const char* name, struct LabelFilter lblFilt, int* matchPtr)
+int GraphsInt_MatchesLabels(const LabelSet* labels, const char* name, const struct LabelFilter* lblFiltPtr, int* matchPtr)
 {
     int result = 0;
 
-    switch (lblFilt.filterType) {
+    switch (lblFiltPtr->filterType) {
     case LABELS_NAME_IDX: {
-        if (lblFilt.objc != 1 || name == NULL) {
+        if (lblFiltPtr->objc != 1 || name == NULL) {
             return TCL_ERROR;
         }
-        result = Tcl_StringMatch(name, Tcl_GetString((Tcl_Obj*)lblFilt.objv[0]));
+        result = Tcl_StringMatch(name, Tcl_GetString((Tcl_Obj*)lblFiltPtr->objv[0]));
         break;
     }
     case LABELS_IDX: {
-        int found = 0;
         if (labels == NULL) {
             return TCL_ERROR;
         }
-        for (int i = 0; i < lblFilt.objc; i++) {
-            Tcl_HashEntry* lblEntry = Tcl_FindHashEntry((Tcl_HashTable*)labels, Tcl_GetString((Tcl_Obj*)lblFilt.objv[i]));
-            if (lblEntry != NULL) {
-                found++;
-            }
-        }
-        result = (found == lblFilt.objc);
+        result = !lblFiltPtr->unknown && GraphsInt_LabelSetHasAll(labels, &lblFiltPtr->mask);
         break;
     }
     case LABELS_NOT_IDX: {
-        result = 1;
         if (labels == NULL) {
             return TCL_ERROR;
         }
-        for (int i = 0; i < lblFilt.objc; i++) {
-            Tcl_HashEntry* lblEntry = Tcl_FindHashEntry((Tcl_HashTable*)labels, Tcl_GetString((Tcl_Obj*)lblFilt.objv[i]));
-            if (lblEntry != NULL) {
-                result = 0;
-                break;
-            }
-        }
+        result = !GraphsInt_LabelSetHasAny(labels, &lblFiltPtr->mask);
         break;
     }
     case LABELS_ALL_IDX:
@@ -139,18 +231,18 @@ int GraphsInt_MatchesLabels(const Tcl_HashTable* labels, const char* name, struc
 }
 
 
-int GraphsInt_GetNodes(Tcl_HashTable fromTbl, struct LabelFilter lblFilt, Tcl_Interp* interp)
+int GraphsInt_GetNodes(const Tcl_HashTable* fromTbl, const struct LabelFilter* lblFiltPtr, Tcl_Interp* interp)
 {
     Tcl_HashSearch search;
-    Tcl_HashEntry* entry = Tcl_FirstHashEntry(&fromTbl, &search);
+    Tcl_HashEntry* entry = Tcl_FirstHashEntry((Tcl_HashTable*)fromTbl, &search);
     Tcl_Obj* result = Tcl_NewObj();
 
     while (entry != NULL) {
         Node* neighborPtr = (Node*) Tcl_GetHashValue(entry);
         int matches = 0;
-        GraphsInt_MatchesLabels(&neighborPtr->labels, neighborPtr->name, lblFilt, &matches);
+        GraphsInt_MatchesLabels(&neighborPtr->labels, neighborPtr->name, lblFiltPtr, &matches);
         if (matches) {
-            Tcl_ListObjAppendElement(interp, result, Tcl_NewStringObj(neighborPtr->cmdName, -1));
+            Tcl_ListObjAppendElement(interp, result, GraphsInt_NodeHandleObj(neighborPtr));
         }
         entry = Tcl_NextHashEntry(&search);
     }
@@ -193,10 +285,9 @@ int GraphsInt_CheckLabelsOptions(LabelFilterT optIdx, Tcl_Interp* interp, int ob
     return TCL_OK;
 }
 
-int GraphsInt_LabelsCommand(Tcl_HashTable labelsTbl, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[])
+int GraphsInt_LabelsCommand(GraphState* statePtr, LabelSet* labelsPtr, Tcl_HashTable* const indexes[],
+    ClientData entity, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[])
 {
-    int new;
-    Tcl_HashEntry* entry;
     int cmdIdx;
     const char* subcmds[] = {
             "add",
@@ -228,9 +319,9 @@ int GraphsInt_LabelsCommand(Tcl_HashTable labelsTbl, Tcl_Interp* interp, int obj
     case LabelsAdd1:
     case LabelsAdd2: {
         for (int i = 1; i < objc; i++) {
-            entry = Tcl_CreateHashEntry(&labelsTbl, Tcl_GetString(objv[i]), &new);
-            if (new) {
-                Tcl_SetHashValue(entry, NULL);
+            int id = GraphsInt_LabelIntern(statePtr, objv[i]);
+            if (GraphsInt_LabelSetAdd(labelsPtr, id)) {
+                GraphsInt_LabelIndexUpdate(indexes, id, entity, 1);
             }
         }
         return TCL_OK;
@@ -238,9 +329,9 @@ int GraphsInt_LabelsCommand(Tcl_HashTable labelsTbl, Tcl_Interp* interp, int obj
     case LabelsDel1:
     case LabelsDel2: {
         for (int i = 1; i < objc; i++) {
-            entry = Tcl_FindHashEntry(&labelsTbl, Tcl_GetString(objv[i]));
-            if (entry != NULL) {
-                Tcl_DeleteHashEntry(entry);
+            int id = GraphsInt_LabelLookup(statePtr, objv[i]);
+            if (id >= 0 && GraphsInt_LabelSetRemove(labelsPtr, id)) {
+                GraphsInt_LabelIndexUpdate(indexes, id, entity, 0);
             }
         }
         return TCL_OK;
@@ -252,17 +343,8 @@ int GraphsInt_LabelsCommand(Tcl_HashTable labelsTbl, Tcl_Interp* interp, int obj
 
     }
 
-    labelsCommandReturnLabels: {
-        Tcl_HashSearch search;
-        Tcl_Obj* result = Tcl_NewObj();
-        entry = Tcl_FirstHashEntry(&labelsTbl, &search);
-        while (entry != NULL) {
-            Tcl_ListObjAppendElement(interp, result, Tcl_NewStringObj(Tcl_GetHashKey(&labelsTbl, entry), -1));
-            entry = Tcl_NextHashEntry(&search);
-        }
-        Tcl_SetObjResult(interp, result);
-
-    }
+    labelsCommandReturnLabels:
+    Tcl_SetObjResult(interp, GraphsInt_LabelSetToList(statePtr, labelsPtr));
     return TCL_OK;
 }
 
@@ -275,13 +357,13 @@ int GraphsInt_LabelsCommand(Tcl_HashTable labelsTbl, Tcl_Interp* interp, int obj
  * of the current node.
  */
 static int GraphsAppendDeltaToObj(const DeltaEntry* nodes, Graph* graphPtr, EdgeDirectionT directionType,
-    struct LabelFilter labelFilter, Tcl_Interp* interp, Tcl_Obj** listObjPtr)
+    const struct LabelFilter* labelFilterPtr, Tcl_Interp* interp, Tcl_Obj** listObjPtr)
 {
     const DeltaEntry* entry = nodes;
     while (entry != NULL) {
-        const Node* nodePtr = entry->nodePtr;
+        Node* nodePtr = entry->nodePtr;
         int matches = 0;
-        GraphsInt_MatchesLabels(&nodePtr->labels, nodePtr->name, labelFilter, &matches);
+        GraphsInt_MatchesLabels(&nodePtr->labels, nodePtr->name, labelFilterPtr, &matches);
         if (!matches) {
             entry = entry->next;
             continue;
@@ -293,14 +375,14 @@ static int GraphsAppendDeltaToObj(const DeltaEntry* nodes, Graph* graphPtr, Edge
                 /* otherNode is not in this graph. Append if it meets the direction*/
                 const Edge* edgePtr = entry->edgePtr;
                 if (edgePtr->directionType == directionType) {
-                    if (Tcl_ListObjAppendElement(interp, *listObjPtr, Tcl_NewStringObj(nodePtr->cmdName, -1)) != TCL_OK) {
+                    if (Tcl_ListObjAppendElement(interp, *listObjPtr, GraphsInt_NodeHandleObj(nodePtr)) != TCL_OK) {
                         return TCL_ERROR;
                     }
                 }
             }
         }
         else {
-            if (Tcl_ListObjAppendElement(interp, *listObjPtr, Tcl_NewStringObj(nodePtr->cmdName, -1)) != TCL_OK) {
+            if (Tcl_ListObjAppendElement(interp, *listObjPtr, GraphsInt_NodeHandleObj(nodePtr)) != TCL_OK) {
                 return TCL_ERROR;
             }
         }
@@ -326,33 +408,33 @@ static int GraphsAppendDeltaToObj(const DeltaEntry* nodes, Graph* graphPtr, Edge
  *                      or node delta only (graphPtr == NULL)
  * \param deltaT        The delta type that is to be returned. DELTA_PLUS are the outgoing nodes, DELTA_MINUS the incoming 
  *                      nodes and DELTA_ALL all connected nodes
- * \param labelFilter   A label filter to apply. Only delta nodes that match the specified label filter are returned
+ * \param labelFilterPtr A label filter to apply. Only delta nodes that match the specified label filter are returned
  * \param interp        The Tcl interp for setting error messages etc.
  * \param resultObj     The Tcl list object for the result. Is filled with the command names of the delta.
  */
-int GraphsInt_GetDelta(Node* nodePtr, Graph* graphPtr, DeltaT deltaT, struct LabelFilter labelFilter, Tcl_Interp* interp,
+int GraphsInt_GetDelta(Node* nodePtr, Graph* graphPtr, DeltaT deltaT, const struct LabelFilter* labelFilterPtr, Tcl_Interp* interp,
         Tcl_Obj** resultObj)
 {
     Tcl_Obj* resObj = *resultObj;
     switch (deltaT) {
     case DELTA_PLUS: {
-        if (GraphsAppendDeltaToObj(nodePtr->outgoing, graphPtr, EDGE_DIRECTED, labelFilter, interp, &resObj) != TCL_OK) {
+        if (GraphsAppendDeltaToObj(nodePtr->outgoing, graphPtr, EDGE_DIRECTED, labelFilterPtr, interp, &resObj) != TCL_OK) {
             return TCL_ERROR;
         }
         break;
     }
     case DELTA_MINUS: {
-        if (GraphsAppendDeltaToObj(nodePtr->incoming, graphPtr, EDGE_DIRECTED, labelFilter, interp, &resObj) != TCL_OK) {
+        if (GraphsAppendDeltaToObj(nodePtr->incoming, graphPtr, EDGE_DIRECTED, labelFilterPtr, interp, &resObj) != TCL_OK) {
             return TCL_ERROR;
         }
         break;
     }
     case DELTA_ALL:
     default: {
-        if (GraphsAppendDeltaToObj(nodePtr->outgoing, graphPtr, EDGE_UNDIRECTED, labelFilter, interp, &resObj) != TCL_OK) {
+        if (GraphsAppendDeltaToObj(nodePtr->outgoing, graphPtr, EDGE_UNDIRECTED, labelFilterPtr, interp, &resObj) != TCL_OK) {
             return TCL_ERROR;
         }
-        if (GraphsAppendDeltaToObj(nodePtr->incoming, graphPtr, EDGE_UNDIRECTED, labelFilter, interp, &resObj) != TCL_OK) {
+        if (GraphsAppendDeltaToObj(nodePtr->incoming, graphPtr, EDGE_UNDIRECTED, labelFilterPtr, interp, &resObj) != TCL_OK) {
             return TCL_ERROR;
         }
         break;
@@ -0,0 +1,634 @@
+/*
+ * Delta (neighborhood) lists of nodes
+ *
+ * The outgoing and incoming neighbors of a node are kept in doubly linked lists of DeltaEntry. The order
+ * of these lists is significant, it can be changed by [$node delta sort] and is preserved by all operations
+ * here. New entries are prepended to the list, unless the list keeps a weight order: then they are inserted
+ * behind the entries of lower or equal (DELTA_ORDER_WEIGHT_ASC) or higher or equal (DELTA_ORDER_WEIGHT_DESC)
+ * weight, and entries are moved when the weight of their edge changes. A list that keeps an order has a
+ * search tree over its entries, so that the place of an entry is found in O(log n) rather than by walking
+ * the list.
+ *
+ * Lookups by neighbor node walk the list as long as it is short. Once a list grows beyond
+ * GRAPHS_DELTA_INDEX_THRESHOLD entries, a hash index from neighbor Node* to DeltaEntry* is attached to the
+ * list, so that lookups, duplicate checks and deletes become O(1) on high degree nodes.
+ */
+#include "graphsInt.h"
+#include <string.h>
+
+static DeltaEntry** DeltaListHead(Node* nodePtr, DeltaT deltaType)
+{
+    return (deltaType == DELTA_MINUS) ? &nodePtr->incoming : &nodePtr->outgoing;
+}
+
+static Tcl_HashTable** DeltaListIndex(Node* nodePtr, DeltaT deltaType)
+{
+    return (deltaType == DELTA_MINUS) ? &nodePtr->incomingIndex : &nodePtr->outgoingIndex;
+}
+
+static DeltaOrderT* DeltaListOrder(Node* nodePtr, DeltaT deltaType)
+{
+    return (deltaType == DELTA_MINUS) ? &nodePtr->incomingOrder : &nodePtr->outgoingOrder;
+}
+
+static DeltaOrderIndex** DeltaListOrderIndex(Node* nodePtr, DeltaT deltaType)
+{
+    return (deltaType == DELTA_MINUS) ? &nodePtr->incomingOrderIndex : &nodePtr->outgoingOrderIndex;
+}
+
+/*
+ * Search tree over a list that keeps a weight order: a treap whose in-order sequence is the list. The
+ * entries are mapped to their tree nodes by a hash table, so that an entry that is deleted or reweighted is
+ * taken out of the tree without a search.
+ */
+typedef struct _deltaOrderNode
+{
+    DeltaEntry* entry;
+    struct _deltaOrderNode* parent;
+    struct _deltaOrderNode* child[2];
+    unsigned int priority;
+} DeltaOrderNode;
+
+struct _deltaOrderIndex
+{
+    DeltaOrderNode* root;
+    Tcl_HashTable nodes;
+    unsigned int seed;
+};
+
+/* Whether an entry of the list with listWeight stays in front of a new entry with weight */
+static int DeltaOrderPrecedes(DeltaOrderT order, double listWeight, double weight)
+{
+    return (order == DELTA_ORDER_WEIGHT_ASC) ? listWeight <= weight : listWeight >= weight;
+}
+
+static DeltaOrderNode* DeltaOrderNewNode(DeltaOrderIndex* indexPtr, DeltaEntry* entry)
+{
+    DeltaOrderNode* treeNode = (DeltaOrderNode*)ckalloc(sizeof(DeltaOrderNode));
+    int new;
+
+    /* xorshift, the priorities only have to be spread evenly */
+    indexPtr->seed ^= indexPtr->seed << 13;
+    indexPtr->seed ^= indexPtr->seed >> 17;
+    indexPtr->seed ^= indexPtr->seed << 5;
+
+    treeNode->entry = entry;
+    treeNode->parent = treeNode->child[0] = treeNode->child[1] = NULL;
+    treeNode->priority = indexPtr->seed;
+    Tcl_SetHashValue(Tcl_CreateHashEntry(&indexPtr->nodes, (ClientData)entry, &new), treeNode);
+    return treeNode;
+}
+
+/* Rotates a tree node above its parent */
+static void DeltaOrderRotateUp(DeltaOrderIndex* indexPtr, DeltaOrderNode* treeNode)
+{
+    DeltaOrderNode* parent = treeNode->parent;
+    DeltaOrderNode* grandParent = parent->parent;
+    int dir = (parent->child[1] == treeNode);
+
+    parent->child[dir] = treeNode->child[!dir];
+    if (treeNode->child[!dir] != NULL) {
+        treeNode->child[!dir]->parent = parent;
+    }
+    treeNode->child[!dir] = parent;
+    parent->parent = treeNode;
+    treeNode->parent = grandParent;
+    if (grandParent == NULL) {
+        indexPtr->root = treeNode;
+    }
+    else {
+        grandParent->child[grandParent->child[1] == parent] = treeNode;
+    }
+}
+
+/*
+ * Adds an entry at its place in the weight order to the tree. Returns the entry that precedes it in the
+ * list, or NULL if it goes to the front.
+ */
+static DeltaEntry* DeltaOrderInsert(DeltaOrderIndex* indexPtr, DeltaOrderT order, DeltaEntry* entry)
+{
+    DeltaOrderNode* treeNode = DeltaOrderNewNode(indexPtr, entry);
+    DeltaOrderNode* parent = NULL;
+    DeltaOrderNode* current = indexPtr->root;
+    DeltaEntry* prev = NULL;
+    double weight = entry->edgePtr->weight;
+    int dir = 0;
+
+    while (current != NULL) {
+        parent = current;
+        dir = DeltaOrderPrecedes(order, current->entry->edgePtr->weight, weight);
+        if (dir) {
+            prev = current->entry;
+        }
+        current = current->child[dir];
+    }
+    treeNode->parent = parent;
+    if (parent == NULL) {
+        indexPtr->root = treeNode;
+    }
+    else {
+        parent->child[dir] = treeNode;
+    }
+    while (treeNode->parent != NULL && treeNode->parent->priority < treeNode->priority) {
+        DeltaOrderRotateUp(indexPtr, treeNode);
+    }
+    return prev;
+}
+
+/* Takes an entry out of the tree */
+static void DeltaOrderRemove(DeltaOrderIndex* indexPtr, DeltaEntry* entry)
+{
+    Tcl_HashEntry* hashEntry = Tcl_FindHashEntry(&indexPtr->nodes, (ClientData)entry);
+    DeltaOrderNode* treeNode = (DeltaOrderNode*)Tcl_GetHashValue(hashEntry);
+    DeltaOrderNode* child;
+
+    /* rotate the node down until it has one child at most */
+    while (treeNode->child[0] != NULL && treeNode->child[1] != NULL) {
+        DeltaOrderRotateUp(indexPtr, treeNode->child[treeNode->child[1]->priority > treeNode->child[0]->priority]);
+    }
+    child = treeNode->child[treeNode->child[0] == NULL];
+    if (child != NULL) {
+        child->parent = treeNode->parent;
+    }
+    if (treeNode->parent == NULL) {
+        indexPtr->root = child;
+    }
+    else {
+        treeNode->parent->child[treeNode->parent->child[1] == treeNode] = child;
+    }
+    Tcl_DeleteHashEntry(hashEntry);
+    ckfree((char*)treeNode);
+}
+
+/* Builds the tree over a sorted list in O(n), along the right spine of the tree */
+static DeltaOrderIndex* DeltaOrderBuild(DeltaEntry* start)
+{
+    DeltaOrderIndex* indexPtr = (DeltaOrderIndex*)ckalloc(sizeof(DeltaOrderIndex));
+    DeltaOrderNode* last = NULL;
+
+    indexPtr->root = NULL;
+    indexPtr->seed = 2463534242u;
+    Tcl_InitHashTable(&indexPtr->nodes, TCL_ONE_WORD_KEYS);
+    for (DeltaEntry* entry = start; entry != NULL; entry = entry->next) {
+        DeltaOrderNode* treeNode = DeltaOrderNewNode(indexPtr, entry);
+        DeltaOrderNode* below = NULL;
+
+        while (last != NULL && last->priority < treeNode->priority) {
+            below = last;
+            last = last->parent;
+        }
+        treeNode->child[0] = below;
+        if (below != NULL) {
+            below->parent = treeNode;
+        }
+        treeNode->parent = last;
+        if (last != NULL) {
+            last->child[1] = treeNode;
+        }
+        else {
+            indexPtr->root = treeNode;
+        }
+        last = treeNode;
+    }
+    return indexPtr;
+}
+
+static void DeltaOrderFree(DeltaOrderIndex** indexRef)
+{
+    Tcl_HashSearch search;
+
+    if (*indexRef == NULL) {
+        return;
+    }
+    for (Tcl_HashEntry* hashEntry = Tcl_FirstHashEntry(&(*indexRef)->nodes, &search); hashEntry != NULL;
+         hashEntry = Tcl_NextHashEntry(&search)) {
+        ckfree((char*)Tcl_GetHashValue(hashEntry));
+    }
+    Tcl_DeleteHashTable(&(*indexRef)->nodes);
+    ckfree((char*)*indexRef);
+    *indexRef = NULL;
+}
+
+/*
+ * Links an unlinked entry into a list, at the front or at its place in the weight order of the list
+ */
+static void DeltaLink(Node* nodePtr, DeltaT deltaType, DeltaEntry* newEntry)
+{
+    DeltaEntry** startRef = DeltaListHead(nodePtr, deltaType);
+    DeltaOrderIndex* orderIndex = *DeltaListOrderIndex(nodePtr, deltaType);
+    DeltaEntry* prev = NULL;
+    DeltaEntry* next;
+
+    if (orderIndex != NULL) {
+        prev = DeltaOrderInsert(orderIndex, *DeltaListOrder(nodePtr, deltaType), newEntry);
+    }
+    next = (prev != NULL) ? prev->next : *startRef;
+
+    newEntry->prev = prev;
+    newEntry->next = next;
+    if (prev != NULL) {
+        prev->next = newEntry;
+    }
+    else {
+        *startRef = newEntry;
+    }
+    if (next != NULL) {
+        next->prev = newEntry;
+    }
+}
+
+static void DeltaUnlink(Node* nodePtr, DeltaT deltaType, DeltaEntry* entry)
+{
+    DeltaOrderIndex* orderIndex = *DeltaListOrderIndex(nodePtr, deltaType);
+
+    if (entry->prev != NULL) {
+        entry->prev->next = entry->next;
+    }
+    else {
+        *DeltaListHead(nodePtr, deltaType) = entry->next;
+    }
+    if (entry->next != NULL) {
+        entry->next->prev = entry->prev;
+    }
+    if (orderIndex != NULL) {
+        DeltaOrderRemove(orderIndex, entry);
+    }
+}
+
+static void DeltaIndexBuild(DeltaEntry* start, Tcl_HashTable** indexRef)
+{
+    int new;
+    Tcl_HashTable* index = (Tcl_HashTable*)ckalloc(sizeof(Tcl_HashTable));
+    Tcl_InitHashTable(index, TCL_ONE_WORD_KEYS);
+
+    for (DeltaEntry* entry = start; entry != NULL; entry = entry->next) {
+        Tcl_HashEntry* hashEntry = Tcl_CreateHashEntry(index, (ClientData)entry->nodePtr, &new);
+        Tcl_SetHashValue(hashEntry, entry);
+    }
+    *indexRef = index;
+}
+
+static void DeltaIndexFree(Tcl_HashTable** indexRef)
+{
+    if (*indexRef != NULL) {
+        Tcl_DeleteHashTable(*indexRef);
+        ckfree((char*)*indexRef);
+        *indexRef = NULL;
+    }
+}
+
+/*
+ * Finds the entry for a neighbor node in the outgoing (DELTA_PLUS) or incoming (DELTA_MINUS) list of
+ * nodePtr. Returns NULL if neighborPtr is not in the list.
+ */
+DeltaEntry* GraphsInt_DeltaFind(Node* nodePtr, DeltaT deltaType, const Node* neighborPtr)
+{
+    Tcl_HashTable* index = *DeltaListIndex(nodePtr, deltaType);
+    DeltaEntry* entry;
+    int count = 0;
+
+    if (index != NULL) {
+        Tcl_HashEntry* hashEntry = Tcl_FindHashEntry(index, (ClientData)neighborPtr);
+        return (hashEntry == NULL) ? NULL : (DeltaEntry*)Tcl_GetHashValue(hashEntry);
+    }
+
+    for (entry = *DeltaListHead(nodePtr, deltaType); entry != NULL; entry = entry->next) {
+        if (entry->nodePtr == neighborPtr) {
+            return entry;
+        }
+        count++;
+    }
+
+    /* The list was scanned completely anyway, so this is the cheapest point to switch the index on */
+    if (count >= GRAPHS_DELTA_INDEX_THRESHOLD) {
+        DeltaIndexBuild(*DeltaListHead(nodePtr, deltaType), DeltaListIndex(nodePtr, deltaType));
+    }
+    return NULL;
+}
+
+/*
+ * Prepends a new entry for neighborPtr/edgePtr to the delta list of nodePtr. The caller is responsible for
+ * checking that the neighbor is not yet in the list, see GraphsInt_DeltaFind()
+ */
+DeltaEntry* GraphsInt_DeltaInsert(Node* nodePtr, DeltaT deltaType, Node* neighborPtr, Edge* edgePtr)
+{
+    Tcl_HashTable* index = *DeltaListIndex(nodePtr, deltaType);
+    DeltaEntry* newEntry = (DeltaEntry*)GraphsInt_PoolAlloc(&nodePtr->statePtr->deltaPool);
+
+    newEntry->nodePtr = neighborPtr;
+    newEntry->edgePtr = edgePtr;
+    DeltaLink(nodePtr, deltaType, newEntry);
+
+    if (index != NULL) {
+        int new;
+        Tcl_HashEntry* hashEntry = Tcl_CreateHashEntry(index, (ClientData)neighborPtr, &new);
+        Tcl_SetHashValue(hashEntry, newEntry);
+    }
+    return newEntry;
+}
+
+/*
+ * Unlinks and frees the entry for neighborPtr from the delta list of nodePtr, if it exists.
+ */
+void GraphsInt_DeltaDelete(Node* nodePtr, DeltaT deltaType, const Node* neighborPtr)
+{
+    Tcl_HashTable** indexRef = DeltaListIndex(nodePtr, deltaType);
+    DeltaEntry* entry = GraphsInt_DeltaFind(nodePtr, deltaType, neighborPtr);
+
+    if (entry == NULL) {
+        return;
+    }
+
+    DeltaUnlink(nodePtr, deltaType, entry);
+
+    if (*indexRef != NULL) {
+        Tcl_DeleteHashEntry(Tcl_FindHashEntry(*indexRef, (ClientData)neighborPtr));
+        /* drop the index again only well below the threshold, to avoid thrashing around it */
+        if ((*indexRef)->numEntries < GRAPHS_DELTA_INDEX_THRESHOLD / 2) {
+            DeltaIndexFree(indexRef);
+        }
+    }
+    GraphsInt_PoolFree(&nodePtr->statePtr->deltaPool, entry);
+}
+
+int GraphsInt_DeltaCompareNodeName(const DeltaEntry* entry1, const DeltaEntry* entry2)
+{
+    return strcmp(entry1->nodePtr->name, entry2->nodePtr->name);
+}
+
+int GraphsInt_DeltaCompareEdgeName(const DeltaEntry* entry1, const DeltaEntry* entry2)
+{
+    return strcmp(entry1->edgePtr->name, entry2->edgePtr->name);
+}
+
+int GraphsInt_DeltaCompareWeight(const DeltaEntry* entry1, const DeltaEntry* entry2)
+{
+    if (entry1->edgePtr->weight < entry2->edgePtr->weight) {
+        return -1;
+    }
+    else if (entry1->edgePtr->weight > entry2->edgePtr->weight) {
+        return 1;
+    }
+    return 0;
+}
+
+/*
+ * Bottom up merge sort over the next links of a list. Stable, also in descending order. Returns the new head.
+ */
+static DeltaEntry* DeltaMergeSort(DeltaEntry* list, GraphsDeltaCompareProc* compareProc, int descending)
+{
+    for (int runLength = 1; list != NULL; runLength *= 2) {
+        DeltaEntry* head = NULL;
+        DeltaEntry** tailRef = &head;
+        DeltaEntry* left = list;
+        int merges = 0;
+
+        while (left != NULL) {
+            DeltaEntry* right = left;
+            int leftCount = 0;
+            int rightCount = runLength;
+
+            merges++;
+            while (leftCount < runLength && right != NULL) {
+                leftCount++;
+                right = right->next;
+            }
+            while (leftCount > 0 || (rightCount > 0 && right != NULL)) {
+                DeltaEntry* entry;
+                int takeLeft;
+
+                if (leftCount == 0) {
+                    takeLeft = 0;
+                }
+                else if (rightCount == 0 || right == NULL) {
+                    takeLeft = 1;
+                }
+                else {
+                    int cmp = compareProc(left, right);
+                    takeLeft = descending ? (cmp >= 0) : (cmp <= 0);
+                }
+                if (takeLeft) {
+                    entry = left;
+                    left = left->next;
+                    leftCount--;
+                }
+                else {
+                    entry = right;
+                    right = right->next;
+                    rightCount--;
+                }
+                *tailRef = entry;
+                tailRef = &entry->next;
+            }
+            left = right;
+        }
+        *tailRef = NULL;
+        list = head;
+        if (merges <= 1) {
+            break;
+        }
+    }
+    return list;
+}
+
+/*
+ * Sorts a delta list in O(n log n). The entries stay where they are, so the index of the list stays valid.
+ * Lists that keep a weight order are sorted by GraphsInt_DeltaSetOrder(), which also rebuilds their tree.
+ */
+void GraphsInt_DeltaSort(Node* nodePtr, DeltaT deltaType, GraphsDeltaCompareProc* compareProc, int descending)
+{
+    DeltaEntry** startRef = DeltaListHead(nodePtr, deltaType);
+    DeltaEntry* prev = NULL;
+
+    *startRef = DeltaMergeSort(*startRef, compareProc, descending);
+    for (DeltaEntry* entry = *startRef; entry != NULL; entry = entry->next) {
+        entry->prev = prev;
+        prev = entry;
+    }
+}
+
+/*
+ * Sets the order that is kept on a delta list. A weight order sorts the list right away and builds the
+ * search tree over it.
+ */
+void GraphsInt_DeltaSetOrder(Node* nodePtr, DeltaT deltaType, DeltaOrderT order)
+{
+    DeltaOrderIndex** orderIndexRef = DeltaListOrderIndex(nodePtr, deltaType);
+
+    *DeltaListOrder(nodePtr, deltaType) = order;
+    DeltaOrderFree(orderIndexRef);
+    if (order != DELTA_ORDER_NONE) {
+        GraphsInt_DeltaSort(nodePtr, deltaType, GraphsInt_DeltaCompareWeight, order == DELTA_ORDER_WEIGHT_DESC);
+        *orderIndexRef = DeltaOrderBuild(*DeltaListHead(nodePtr, deltaType));
+    }
+}
+
+/*
+ * Moves the entry for neighborPtr to its place in the weight order of the list, after the weight of its
+ * edge has changed. Nothing to do for lists without a kept order.
+ */
+void GraphsInt_DeltaReposition(Node* nodePtr, DeltaT deltaType, const Node* neighborPtr)
+{
+    DeltaOrderT order = *DeltaListOrder(nodePtr, deltaType);
+    DeltaEntry* entry;
+    double weight;
+
+    if (order == DELTA_ORDER_NONE || (entry = GraphsInt_DeltaFind(nodePtr, deltaType, neighborPtr)) == NULL) {
+        return;
+    }
+
+    /* the entry is in place if it would be inserted between its neighbors in the list again */
+    weight = entry->edgePtr->weight;
+    if ((entry->prev == NULL || DeltaOrderPrecedes(order, entry->prev->edgePtr->weight, weight))
+        && (entry->next == NULL || !DeltaOrderPrecedes(order, entry->next->edgePtr->weight, weight))) {
+        return;
+    }
+    DeltaUnlink(nodePtr, deltaType, entry);
+    DeltaLink(nodePtr, deltaType, entry);
+}
+
+/*
+ * Bounded heap for GraphsInt_DeltaTop(). The root is the entry that is ranked last among the entries kept
+ * so far, so a new entry only has to beat the root to get in. Ties in weight are ranked by list position.
+ */
+typedef struct _deltaTopItem
+{
+    const DeltaEntry* entry;
+    int position;
+} DeltaTopItem;
+
+/* Whether item1 is ranked behind item2 */
+static int DeltaTopBehind(const DeltaTopItem* item1, const DeltaTopItem* item2, int descending)
+{
+    double weight1 = item1->entry->edgePtr->weight;
+    double weight2 = item2->entry->edgePtr->weight;
+
+    if (weight1 != weight2) {
+        return descending ? (weight1 < weight2) : (weight1 > weight2);
+    }
+    return item1->position > item2->position;
+}
+
+static void DeltaTopSiftDown(DeltaTopItem* heap, int count, int i, int descending)
+{
+    for (;;) {
+        int last = i;
+        int left = 2 * i + 1;
+        int right = left + 1;
+        DeltaTopItem tmp;
+
+        if (left < count && DeltaTopBehind(&heap[left], &heap[last], descending)) {
+            last = left;
+        }
+        if (right < count && DeltaTopBehind(&heap[right], &heap[last], descending)) {
+            last = right;
+        }
+        if (last == i) {
+            return;
+        }
+        tmp = heap[i];
+        heap[i] = heap[last];
+        heap[last] = tmp;
+        i = last;
+    }
+}
+
+static void DeltaTopSiftUp(DeltaTopItem* heap, int i, int descending)
+{
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        DeltaTopItem tmp;
+
+        if (!DeltaTopBehind(&heap[i], &heap[parent], descending)) {
+            return;
+        }
+        tmp = heap[i];
+        heap[i] = heap[parent];
+        heap[parent] = tmp;
+        i = parent;
+    }
+}
+
+/*
+ * Collects the (at most) k entries with the lowest (or, if descending, highest) edge weights of a delta
+ * list that match a label filter, ranked best first, into topEntries. Ties keep the list order. O(n log k)
+ * on an unordered list; on a list that keeps the requested weight order this is a scan of the first
+ * matching entries. deltaType DELTA_ALL ranks the outgoing and incoming lists together. Returns the number
+ * of entries collected.
+ */
+int GraphsInt_DeltaTop(Node* nodePtr, DeltaT deltaType, int k, int descending,
+    const struct LabelFilter* lblFiltPtr, const DeltaEntry** topEntries)
+{
+    DeltaOrderT wanted = descending ? DELTA_ORDER_WEIGHT_DESC : DELTA_ORDER_WEIGHT_ASC;
+    DeltaTopItem* heap;
+    int count = 0, position = 0;
+
+    if (k <= 0) {
+        return 0;
+    }
+
+    if (deltaType != DELTA_ALL && *DeltaListOrder(nodePtr, deltaType) == wanted) {
+        for (const DeltaEntry* entry = *DeltaListHead(nodePtr, deltaType); entry != NULL && count < k;
+             entry = entry->next) {
+            int matches = 0;
+            GraphsInt_MatchesLabels(&entry->nodePtr->labels, entry->nodePtr->name, lblFiltPtr, &matches);
+            if (matches) {
+                topEntries[count++] = entry;
+            }
+        }
+        return count;
+    }
+
+    heap = (DeltaTopItem*)ckalloc(k * sizeof(DeltaTopItem));
+    for (DeltaT listType = DELTA_PLUS; listType <= DELTA_MINUS; listType++) {
+        if (deltaType != DELTA_ALL && deltaType != listType) {
+            continue;
+        }
+        for (const DeltaEntry* entry = *DeltaListHead(nodePtr, listType); entry != NULL; entry = entry->next) {
+            DeltaTopItem item;
+            int matches = 0;
+
+            GraphsInt_MatchesLabels(&entry->nodePtr->labels, entry->nodePtr->name, lblFiltPtr, &matches);
+            if (!matches) {
+                continue;
+            }
+            item.entry = entry;
+            item.position = position++;
+            if (count < k) {
+                heap[count] = item;
+                DeltaTopSiftUp(heap, count++, descending);
+            }
+            else if (DeltaTopBehind(&heap[0], &item, descending)) {
+                heap[0] = item;
+                DeltaTopSiftDown(heap, count, 0, descending);
+            }
+        }
+    }
+
+    /* pop the heap from the back, the entry ranked last comes out first */
+    for (int i = count - 1; i >= 0; i--) {
+        topEntries[i] = heap[0].entry;
+        heap[0] = heap[i];
+        DeltaTopSiftDown(heap, i, 0, descending);
+    }
+    ckfree((char*)heap);
+    return count;
+}
+
+/*
+ * Frees all entries and the index of a delta list, without touching the edges or neighbors.
+ */
+void GraphsInt_DeltaFree(Node* nodePtr, DeltaT deltaType)
+{
+    DeltaEntry** startRef = DeltaListHead(nodePtr, deltaType);
+    DeltaEntry* entry = *startRef;
+
+    while (entry != NULL) {
+        DeltaEntry* next = entry->next;
+        GraphsInt_PoolFree(&nodePtr->statePtr->deltaPool, entry);
+        entry = next;
+    }
+    *startRef = NULL;
+    DeltaIndexFree(DeltaListIndex(nodePtr, deltaType));
+    DeltaOrderFree(DeltaListOrderIndex(nodePtr, deltaType));
+}
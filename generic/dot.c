@@ -0,0 +1,1252 @@
+/*
+ * DOT export and import of graphs through Tcl channels
+ *
+ * [$graph write dot <channel> ?-name <name>? ?-mark <edges>? ?-pretty?] writes the member nodes and the edges
+ * of a graph in the DOT dialect of digraph-to-dot. The document is built in chunks of DOT_CHUNK_SIZE bytes
+ * that are passed to the channel as they fill up, so memory use does not grow with the size of the graph.
+ *
+ * Nodes are written by -name, or by their handle if they have no name. Every node gets a statement with
+ * its labels, data and the values of the node attribute columns of the graph, so isolated nodes survive
+ * a round trip. Edges carry label (the -name), weight, data, labels and the edge attribute columns. Graphs
+ * with only undirected edges are written as undirected graphs, otherwise undirected edges get dir=none.
+ * Edges given with -mark are drawn in red.
+ *
+ * [$graph read dot <channel>] and [$graph read dot -string <dot>] parse a DOT document and create its nodes
+ * and edges in the graph, see DotRead() below.
+ */
+#include "graphsInt.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Size from which on the buffered part of the document is written to the channel */
+#define DOT_CHUNK_SIZE 65536
+
+typedef struct _dotWriter
+{
+    Tcl_Channel chan;
+    Tcl_DString buffer;
+    int pretty;
+    int failed;
+} DotWriter;
+
+static void DotFlush(DotWriter* writerPtr)
+{
+    if (!writerPtr->failed && Tcl_DStringLength(&writerPtr->buffer) > 0) {
+        if (Tcl_WriteChars(writerPtr->chan, Tcl_DStringValue(&writerPtr->buffer),
+                Tcl_DStringLength(&writerPtr->buffer)) < 0) {
+            writerPtr->failed = 1;
+        }
+    }
+    Tcl_DStringSetLength(&writerPtr->buffer, 0);
+}
+
+static void DotAppend(DotWriter* writerPtr, const char* str)
+{
+    Tcl_DStringAppend(&writerPtr->buffer, str, -1);
+}
+
+/* Appends a DOT string in double quotes, with embedded quotes and backslashes escaped */
+static void DotAppendQuoted(DotWriter* writerPtr, const char* str)
+{
+    const char* special;
+
+    Tcl_DStringAppend(&writerPtr->buffer, "\"", 1);
+    while ((special = strpbrk(str, "\"\\")) != NULL) {
+        Tcl_DStringAppend(&writerPtr->buffer, str, (int)(special - str));
+        Tcl_DStringAppend(&writerPtr->buffer, "\\", 1);
+        Tcl_DStringAppend(&writerPtr->buffer, special, 1);
+        str = special + 1;
+    }
+    Tcl_DStringAppend(&writerPtr->buffer, str, -1);
+    Tcl_DStringAppend(&writerPtr->buffer, "\"", 1);
+}
+
+static void DotAppendAttr(DotWriter* writerPtr, int* firstPtr, const char* key, const char* value)
+{
+    DotAppend(writerPtr, *firstPtr ? "[" : ",");
+    DotAppend(writerPtr, key);
+    DotAppend(writerPtr, "=");
+    DotAppendQuoted(writerPtr, value);
+    *firstPtr = 0;
+}
+
+static void DotAppendObjAttr(DotWriter* writerPtr, int* firstPtr, const char* key, Tcl_Obj* valueObj)
+{
+    Tcl_IncrRefCount(valueObj);
+    DotAppendAttr(writerPtr, firstPtr, key, Tcl_GetString(valueObj));
+    Tcl_DecrRefCount(valueObj);
+}
+
+/* Ends a statement, and passes the buffer on to the channel once a chunk is full */
+static void DotEndStatement(DotWriter* writerPtr, int first)
+{
+    DotAppend(writerPtr, first ? ";" : "];");
+    if (writerPtr->pretty) {
+        DotAppend(writerPtr, "\n");
+    }
+    if (Tcl_DStringLength(&writerPtr->buffer) >= DOT_CHUNK_SIZE) {
+        DotFlush(writerPtr);
+    }
+}
+
+static const char* DotNodeId(const Node* nodePtr)
+{
+    return (nodePtr->name[0] != '\0') ? nodePtr->name : nodePtr->cmdName;
+}
+
+static int DotCompareNames(const void* a, const void* b)
+{
+    return strcmp(*(const char* const*)a, *(const char* const*)b);
+}
+
+/*
+ * Returns the names of the columns of an attribute table, sorted, so that attributes come out in the same
+ * order on every statement. The array must be freed with ckfree().
+ */
+static const char** DotAttrNames(Tcl_HashTable* tablePtr, GraphsAttr*** attrsPtr)
+{
+    const char** names = (const char**)ckalloc(tablePtr->numEntries * sizeof(char*) + 1);
+    GraphsAttr** attrs = (GraphsAttr**)ckalloc(tablePtr->numEntries * sizeof(GraphsAttr*) + 1);
+    Tcl_HashSearch search;
+    int count = 0;
+
+    for (Tcl_HashEntry* entry = Tcl_FirstHashEntry(tablePtr, &search); entry != NULL;
+        entry = Tcl_NextHashEntry(&search)) {
+        names[count++] = Tcl_GetHashKey(tablePtr, entry);
+    }
+    qsort(names, count, sizeof(char*), DotCompareNames);
+    for (int i = 0; i < count; i++) {
+        attrs[i] = GraphsInt_AttrFind(tablePtr, names[i]);
+    }
+    *attrsPtr = attrs;
+    return names;
+}
+
+static void DotAppendColumns(DotWriter* writerPtr, int* firstPtr, const char* names[], GraphsAttr* attrs[],
+    int count, int id)
+{
+    for (int i = 0; i < count; i++) {
+        DotAppendObjAttr(writerPtr, firstPtr, names[i], GraphsInt_AttrGetObj(attrs[i], id));
+    }
+}
+
+static void DotWriteNode(DotWriter* writerPtr, Node* nodePtr, const char* names[], GraphsAttr* attrs[], int count)
+{
+    int first = 1;
+
+    DotAppendQuoted(writerPtr, DotNodeId(nodePtr));
+    if (nodePtr->labels.bits != 0 || nodePtr->labels.extraCount > 0) {
+        DotAppendObjAttr(writerPtr, &first, "labels", GraphsInt_LabelSetToList(nodePtr->statePtr, &nodePtr->labels));
+    }
+    if (Tcl_GetString(nodePtr->data)[0] != '\0') {
+        DotAppendAttr(writerPtr, &first, "data", Tcl_GetString(nodePtr->data));
+    }
+    DotAppendColumns(writerPtr, &first, names, attrs, count, nodePtr->id);
+    DotEndStatement(writerPtr, first);
+}
+
+static void DotWriteEdge(DotWriter* writerPtr, Edge* edgePtr, int undirectedGraph, int marked, const char* names[],
+    GraphsAttr* attrs[], int count)
+{
+    char weight[TCL_DOUBLE_SPACE];
+    int first = 1;
+
+    DotAppendQuoted(writerPtr, DotNodeId(edgePtr->fromNode));
+    DotAppend(writerPtr, undirectedGraph ? "--" : "->");
+    DotAppendQuoted(writerPtr, DotNodeId(edgePtr->toNode));
+
+    Tcl_PrintDouble(NULL, edgePtr->weight, weight);
+    DotAppendAttr(writerPtr, &first, "label", edgePtr->name);
+    DotAppendAttr(writerPtr, &first, "weight", weight);
+    DotAppendAttr(writerPtr, &first, "data", Tcl_GetString(edgePtr->data));
+    if (edgePtr->labels.bits != 0 || edgePtr->labels.extraCount > 0) {
+        DotAppendObjAttr(writerPtr, &first, "labels", GraphsInt_LabelSetToList(edgePtr->statePtr, &edgePtr->labels));
+    }
+    else {
+        DotAppendAttr(writerPtr, &first, "labels", "");
+    }
+    DotAppendColumns(writerPtr, &first, names, attrs, count, edgePtr->id);
+    if (!undirectedGraph && edgePtr->directionType == EDGE_UNDIRECTED) {
+        DotAppend(writerPtr, ",dir=none");
+    }
+    if (marked) {
+        DotAppend(writerPtr, ",color=red,penwidth=2.0");
+    }
+    DotEndStatement(writerPtr, first);
+}
+
+/* Collects the edges given with -mark into a set of Edge* */
+static int DotMarkedEdges(Graph* graphPtr, Tcl_Interp* interp, Tcl_Obj* listObj, Tcl_HashTable* markedPtr)
+{
+    Tcl_Obj** handles;
+    int count, new;
+
+    if (Tcl_ListObjGetElements(interp, listObj, &count, &handles) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    for (int i = 0; i < count; i++) {
+        Edge* edgePtr = GraphsInt_EdgeGetFromObj(graphPtr->statePtr, handles[i]);
+        if (edgePtr == NULL) {
+            Tcl_SetObjResult(interp, Tcl_ObjPrintf("no such edge: %s", Tcl_GetString(handles[i])));
+            return TCL_ERROR;
+        }
+        Tcl_CreateHashEntry(markedPtr, (ClientData)edgePtr, &new);
+    }
+    return TCL_OK;
+}
+
+static int DotWrite(Graph* graphPtr, Tcl_Interp* interp, Tcl_Channel chan, const char* name, int pretty,
+    Tcl_HashTable* markedPtr)
+{
+    DotWriter writer;
+    Tcl_HashSearch search;
+    Tcl_HashEntry* entry;
+    GraphsAttr** nodeAttrs;
+    GraphsAttr** edgeAttrs;
+    const char** nodeAttrNames = DotAttrNames(&graphPtr->nodeAttrs, &nodeAttrs);
+    const char** edgeAttrNames = DotAttrNames(&graphPtr->edgeAttrs, &edgeAttrs);
+    int undirectedGraph = (graphPtr->edges.numEntries > 0);
+
+    for (entry = Tcl_FirstHashEntry(&graphPtr->edges, &search); entry != NULL && undirectedGraph;
+        entry = Tcl_NextHashEntry(&search)) {
+        undirectedGraph = (((Edge*)Tcl_GetHashValue(entry))->directionType == EDGE_UNDIRECTED);
+    }
+
+    writer.chan = chan;
+    writer.pretty = pretty;
+    writer.failed = 0;
+    Tcl_DStringInit(&writer.buffer);
+
+    DotAppend(&writer, undirectedGraph ? "graph " : "digraph ");
+    if (name != NULL) {
+        DotAppendQuoted(&writer, name);
+        DotAppend(&writer, " ");
+    }
+    DotAppend(&writer, pretty ? "{\n" : "{");
+
+    for (entry = Tcl_FirstHashEntry(&graphPtr->nodes, &search); entry != NULL && !writer.failed;
+        entry = Tcl_NextHashEntry(&search)) {
+        DotWriteNode(&writer, (Node*)Tcl_GetHashValue(entry), nodeAttrNames, nodeAttrs,
+            graphPtr->nodeAttrs.numEntries);
+    }
+    for (entry = Tcl_FirstHashEntry(&graphPtr->nodes, &search); entry != NULL && !writer.failed;
+        entry = Tcl_NextHashEntry(&search)) {
+        Node* nodePtr = (Node*)Tcl_GetHashValue(entry);
+
+        /*
+         * Walking the delta lists of the members instead of the edge table of the graph keeps one end of each
+         * edge in the cache. Every edge is written from its from node, or from its inner node for cut edges
+         * whose from node is outside of the graph.
+         */
+        for (DeltaEntry* deltaPtr = nodePtr->outgoing; deltaPtr != NULL; deltaPtr = deltaPtr->next) {
+            Edge* edgePtr = deltaPtr->edgePtr;
+            if (edgePtr->fromNode == nodePtr || edgePtr->fromNode->graph != graphPtr) {
+                DotWriteEdge(&writer, edgePtr, undirectedGraph,
+                    Tcl_FindHashEntry(markedPtr, (ClientData)edgePtr) != NULL, edgeAttrNames, edgeAttrs,
+                    graphPtr->edgeAttrs.numEntries);
+            }
+        }
+        for (DeltaEntry* deltaPtr = nodePtr->incoming; deltaPtr != NULL; deltaPtr = deltaPtr->next) {
+            Edge* edgePtr = deltaPtr->edgePtr;
+            if (edgePtr->fromNode->graph != graphPtr) {
+                DotWriteEdge(&writer, edgePtr, undirectedGraph,
+                    Tcl_FindHashEntry(markedPtr, (ClientData)edgePtr) != NULL, edgeAttrNames, edgeAttrs,
+                    graphPtr->edgeAttrs.numEntries);
+            }
+        }
+    }
+    DotAppend(&writer, pretty ? "}\n" : "}");
+    DotFlush(&writer);
+
+    Tcl_DStringFree(&writer.buffer);
+    ckfree((char*)nodeAttrNames);
+    ckfree((char*)nodeAttrs);
+    ckfree((char*)edgeAttrNames);
+    ckfree((char*)edgeAttrs);
+    if (writer.failed) {
+        Tcl_SetObjResult(interp, Tcl_ObjPrintf("error writing \"%s\": %s", Tcl_GetChannelName(chan),
+            Tcl_PosixError(interp)));
+        return TCL_ERROR;
+    }
+    return TCL_OK;
+}
+
+/*
+ * Implements [$graph write dot <channel> ?-name <name>? ?-mark <edges>? ?-pretty?]
+ */
+int GraphsInt_GraphCmdWrite(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[])
+{
+    static const char* formats[] = { "dot", NULL };
+    static const char* options[] = { "-name", "-mark", "-pretty", NULL };
+    enum OptionsIx
+    {
+        NameIx,
+        MarkIx,
+        PrettyIx
+    };
+    Tcl_HashTable marked;
+    Tcl_Channel chan;
+    const char* name = NULL;
+    int idx, mode, pretty = 0, result;
+
+    if (objc < 2) {
+        Tcl_WrongNumArgs(interp, 0, objv, "dot <channel> ?-name <name>? ?-mark <edges>? ?-pretty?");
+        return TCL_ERROR;
+    }
+    if (Tcl_GetIndexFromObj(interp, objv[0], formats, "format", 0, &idx) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    if ((chan = Tcl_GetChannel(interp, Tcl_GetString(objv[1]), &mode)) == NULL) {
+        return TCL_ERROR;
+    }
+    if ((mode & TCL_WRITABLE) == 0) {
+        Tcl_SetObjResult(interp, Tcl_ObjPrintf("channel \"%s\" wasn't opened for writing", Tcl_GetString(objv[1])));
+        return TCL_ERROR;
+    }
+
+    Tcl_InitHashTable(&marked, TCL_ONE_WORD_KEYS);
+    for (int i = 2; i < objc; i++) {
+        if (Tcl_GetIndexFromObj(interp, objv[i], options, "option", 0, &idx) != TCL_OK) {
+            Tcl_DeleteHashTable(&marked);
+            return TCL_ERROR;
+        }
+        if (idx == PrettyIx) {
+            pretty = 1;
+            continue;
+        }
+        if (i + 1 >= objc) {
+            Tcl_WrongNumArgs(interp, 0, objv, "dot <channel> ?-name <name>? ?-mark <edges>? ?-pretty?");
+            Tcl_DeleteHashTable(&marked);
+            return TCL_ERROR;
+        }
+        if (idx == NameIx) {
+            name = Tcl_GetString(objv[++i]);
+        }
+        else if (DotMarkedEdges(graphPtr, interp, objv[++i], &marked) != TCL_OK) {
+            Tcl_DeleteHashTable(&marked);
+            return TCL_ERROR;
+        }
+    }
+
+    result = DotWrite(graphPtr, interp, chan, name, pretty, &marked);
+    Tcl_DeleteHashTable(&marked);
+    return result;
+}
+
+/*
+ * DOT import
+ *
+ * The document is read in chunks of DOT_CHUNK_SIZE characters and split into tokens by a hand written
+ * scanner that keeps track of the line number, so that memory use does not depend on the size of the
+ * document. The parser handles the DOT grammar without subgraphs and ports: graph and digraph documents,
+ * node, edge and attribute statements, edge chains a -> b -> c, quoted strings with escapes and + concatenation,
+ * HTML strings and C, C++ and # comments.
+ *
+ * Nodes are looked up by -name in the graph, and created there if they are new. Of the attributes, label
+ * (the edge -name), weight, data, labels, dir=none (undirected edge) and the names of declared attribute
+ * columns are taken over, all others are ignored. Defaults from node [...] statements apply to the nodes
+ * created after them, also by edge statements, those from edge [...] statements to the edge statements after
+ * them. In a strict graph a repeated edge updates the attributes of the existing edge instead of failing.
+ * Errors are reported with the line they occur on. The nodes and edges of the statements before the error
+ * are kept, the failing statement leaves no nodes, edges or attribute values behind.
+ */
+
+typedef enum _DotTokenT {
+    DOT_TOK_EOF,
+    DOT_TOK_ID,
+    DOT_TOK_LBRACE,
+    DOT_TOK_RBRACE,
+    DOT_TOK_LBRACKET,
+    DOT_TOK_RBRACKET,
+    DOT_TOK_EQUAL,
+    DOT_TOK_SEMICOLON,
+    DOT_TOK_COMMA,
+    DOT_TOK_COLON,
+    DOT_TOK_ARROW,
+    DOT_TOK_DASHDASH
+} DotTokenT;
+
+typedef struct _dotReader
+{
+    Tcl_Interp* interp;
+    Graph* graphPtr;
+
+    /* Source: a channel read in chunks, or a string (chan == NULL) */
+    Tcl_Channel chan;
+    Tcl_Obj* chunkObj;
+    const char* pos;
+    const char* end;
+    int line;
+
+    /* Current token, its text for DOT_TOK_ID, whether it was quoted and the line it starts on */
+    DotTokenT token;
+    Tcl_DString text;
+    int quoted;
+    int tokenLine;
+
+    int undirectedGraph;
+    int strict;
+
+    /* Message of a failed read from the channel, NULL if none failed */
+    const char* readError;
+
+    /* Attributes of the node [...] and edge [...] statements, lists of keys and values */
+    Tcl_Obj* nodeDefaults;
+    Tcl_Obj* edgeDefaults;
+} DotReader;
+
+/* Returns the next character without consuming it, -1 at the end of the document */
+static int DotPeek(DotReader* readerPtr)
+{
+    if (readerPtr->pos == readerPtr->end) {
+        int length;
+
+        if (readerPtr->chan == NULL || readerPtr->readError != NULL) {
+            return -1;
+        }
+        if (Tcl_ReadChars(readerPtr->chan, readerPtr->chunkObj, DOT_CHUNK_SIZE, 0) < 0) {
+            readerPtr->readError = Tcl_ErrnoMsg(Tcl_GetErrno());
+            return -1;
+        }
+        if (Tcl_GetCharLength(readerPtr->chunkObj) == 0) {
+            return -1;
+        }
+        readerPtr->pos = Tcl_GetStringFromObj(readerPtr->chunkObj, &length);
+        readerPtr->end = readerPtr->pos + length;
+    }
+    return (unsigned char)*readerPtr->pos;
+}
+
+static int DotNext(DotReader* readerPtr)
+{
+    int c = DotPeek(readerPtr);
+
+    if (c >= 0) {
+        readerPtr->pos++;
+        if (c == '\n') {
+            readerPtr->line++;
+        }
+    }
+    return c;
+}
+
+/* A failed read cuts the document short, it is reported instead of the error that results from that */
+static int DotReadError(DotReader* readerPtr)
+{
+    Tcl_SetObjResult(readerPtr->interp, Tcl_ObjPrintf("line %d: error reading \"%s\": %s", readerPtr->line,
+        Tcl_GetChannelName(readerPtr->chan), readerPtr->readError));
+    return TCL_ERROR;
+}
+
+static int DotError(DotReader* readerPtr, const char* message)
+{
+    if (readerPtr->readError != NULL) {
+        return DotReadError(readerPtr);
+    }
+    Tcl_SetObjResult(readerPtr->interp, Tcl_ObjPrintf("line %d: %s", readerPtr->tokenLine, message));
+    return TCL_ERROR;
+}
+
+static int DotSyntaxError(DotReader* readerPtr)
+{
+    if (readerPtr->readError != NULL) {
+        return DotReadError(readerPtr);
+    }
+    const char* near = (readerPtr->token == DOT_TOK_EOF) ? "end of input" : Tcl_DStringValue(&readerPtr->text);
+    Tcl_SetObjResult(readerPtr->interp, Tcl_ObjPrintf("line %d: syntax error near \"%s\"", readerPtr->tokenLine,
+        near));
+    return TCL_ERROR;
+}
+
+static int DotIsIdChar(int c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c >= 128;
+}
+
+/* Skips white space and comments. Fails on an unterminated comment or a stray '/'. */
+static int DotSkipSpace(DotReader* readerPtr)
+{
+    int c;
+
+    while ((c = DotPeek(readerPtr)) >= 0) {
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f' || c == '\v') {
+            DotNext(readerPtr);
+        }
+        else if (c == '#') {
+            while ((c = DotNext(readerPtr)) >= 0 && c != '\n') {
+            }
+        }
+        else if (c == '/') {
+            DotNext(readerPtr);
+            c = DotNext(readerPtr);
+            if (c == '/') {
+                while ((c = DotNext(readerPtr)) >= 0 && c != '\n') {
+                }
+            }
+            else if (c == '*') {
+                int last = 0;
+                while ((c = DotNext(readerPtr)) >= 0 && !(last == '*' && c == '/')) {
+                    last = c;
+                }
+                if (c < 0) {
+                    return DotError(readerPtr, "unterminated comment");
+                }
+            }
+            else {
+                return DotError(readerPtr, "unexpected \"/\"");
+            }
+        }
+        else {
+            break;
+        }
+    }
+    return TCL_OK;
+}
+
+/* Scans the rest of a quoted string, the opening quote is consumed already */
+static int DotScanQuoted(DotReader* readerPtr)
+{
+    int c;
+
+    while ((c = DotNext(readerPtr)) != '"') {
+        char ch;
+
+        if (c < 0) {
+            return DotError(readerPtr, "unterminated string");
+        }
+        if (c == '\\') {
+            int escaped = DotPeek(readerPtr);
+            if (escaped == '"' || escaped == '\\') {
+                c = DotNext(readerPtr);
+            }
+            else if (escaped == '\n') {
+                /* line continuation */
+                DotNext(readerPtr);
+                continue;
+            }
+        }
+        ch = (char)c;
+        Tcl_DStringAppend(&readerPtr->text, &ch, 1);
+    }
+    return TCL_OK;
+}
+
+/* Scans an HTML string up to the matching '>', the opening '<' is consumed already */
+static int DotScanHtml(DotReader* readerPtr)
+{
+    int depth = 1, c;
+
+    while ((c = DotNext(readerPtr)) >= 0) {
+        char ch = (char)c;
+        if (c == '<') {
+            depth++;
+        }
+        else if (c == '>' && --depth == 0) {
+            return TCL_OK;
+        }
+        Tcl_DStringAppend(&readerPtr->text, &ch, 1);
+    }
+    return DotError(readerPtr, "unterminated HTML string");
+}
+
+/* Reads the next token into the reader */
+static int DotAdvance(DotReader* readerPtr)
+{
+    int c;
+    char ch;
+
+    Tcl_DStringSetLength(&readerPtr->text, 0);
+    readerPtr->quoted = 0;
+    if (DotSkipSpace(readerPtr) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    readerPtr->tokenLine = readerPtr->line;
+
+    c = DotNext(readerPtr);
+    ch = (char)c;
+    if (c >= 0) {
+        Tcl_DStringAppend(&readerPtr->text, &ch, 1);
+    }
+    switch (c) {
+    case -1:
+        readerPtr->token = DOT_TOK_EOF;
+        return (readerPtr->readError != NULL) ? DotReadError(readerPtr) : TCL_OK;
+    case '{':
+        readerPtr->token = DOT_TOK_LBRACE;
+        return TCL_OK;
+    case '}':
+        readerPtr->token = DOT_TOK_RBRACE;
+        return TCL_OK;
+    case '[':
+        readerPtr->token = DOT_TOK_LBRACKET;
+        return TCL_OK;
+    case ']':
+        readerPtr->token = DOT_TOK_RBRACKET;
+        return TCL_OK;
+    case '=':
+        readerPtr->token = DOT_TOK_EQUAL;
+        return TCL_OK;
+    case ';':
+        readerPtr->token = DOT_TOK_SEMICOLON;
+        return TCL_OK;
+    case ',':
+        readerPtr->token = DOT_TOK_COMMA;
+        return TCL_OK;
+    case ':':
+        readerPtr->token = DOT_TOK_COLON;
+        return TCL_OK;
+    case '"':
+        /* quoted strings, possibly concatenated with + */
+        Tcl_DStringSetLength(&readerPtr->text, 0);
+        readerPtr->token = DOT_TOK_ID;
+        readerPtr->quoted = 1;
+        for (;;) {
+            if (DotScanQuoted(readerPtr) != TCL_OK || DotSkipSpace(readerPtr) != TCL_OK) {
+                return TCL_ERROR;
+            }
+            if (DotPeek(readerPtr) != '+') {
+                return TCL_OK;
+            }
+            DotNext(readerPtr);
+            if (DotSkipSpace(readerPtr) != TCL_OK) {
+                return TCL_ERROR;
+            }
+            if (DotNext(readerPtr) != '"') {
+                return DotError(readerPtr, "expected a quoted string after \"+\"");
+            }
+        }
+    case '<':
+        Tcl_DStringSetLength(&readerPtr->text, 0);
+        readerPtr->token = DOT_TOK_ID;
+        readerPtr->quoted = 1;
+        return DotScanHtml(readerPtr);
+    case '-':
+        if (DotPeek(readerPtr) == '>' || DotPeek(readerPtr) == '-') {
+            ch = (char)DotNext(readerPtr);
+            Tcl_DStringAppend(&readerPtr->text, &ch, 1);
+            readerPtr->token = (ch == '>') ? DOT_TOK_ARROW : DOT_TOK_DASHDASH;
+            return TCL_OK;
+        }
+        break;
+    default:
+        break;
+    }
+
+    /* identifiers and numerals */
+    if (DotIsIdChar(c) || c == '-' || c == '.') {
+        while ((c = DotPeek(readerPtr)) >= 0 && (DotIsIdChar(c) || c == '.')) {
+            ch = (char)DotNext(readerPtr);
+            Tcl_DStringAppend(&readerPtr->text, &ch, 1);
+        }
+        readerPtr->token = DOT_TOK_ID;
+        return TCL_OK;
+    }
+    return DotSyntaxError(readerPtr);
+}
+
+/* Whether the current token is the unquoted keyword, DOT keywords are case independent */
+static int DotIsKeyword(const DotReader* readerPtr, const char* keyword)
+{
+    return readerPtr->token == DOT_TOK_ID && !readerPtr->quoted
+        && strcasecmp(Tcl_DStringValue(&readerPtr->text), keyword) == 0;
+}
+
+static Tcl_Obj* DotTokenObj(const DotReader* readerPtr)
+{
+    return Tcl_NewStringObj(Tcl_DStringValue(&readerPtr->text), Tcl_DStringLength(&readerPtr->text));
+}
+
+/* Parses one or more attribute lists [k=v, ...][...] into a list of keys and values */
+static int DotParseAttrs(DotReader* readerPtr, Tcl_Obj* attrsObj)
+{
+    while (readerPtr->token == DOT_TOK_LBRACKET) {
+        if (DotAdvance(readerPtr) != TCL_OK) {
+            return TCL_ERROR;
+        }
+        while (readerPtr->token == DOT_TOK_ID) {
+            Tcl_ListObjAppendElement(NULL, attrsObj, DotTokenObj(readerPtr));
+            if (DotAdvance(readerPtr) != TCL_OK) {
+                return TCL_ERROR;
+            }
+            if (readerPtr->token != DOT_TOK_EQUAL) {
+                return DotSyntaxError(readerPtr);
+            }
+            if (DotAdvance(readerPtr) != TCL_OK) {
+                return TCL_ERROR;
+            }
+            if (readerPtr->token != DOT_TOK_ID) {
+                return DotSyntaxError(readerPtr);
+            }
+            Tcl_ListObjAppendElement(NULL, attrsObj, DotTokenObj(readerPtr));
+            if (DotAdvance(readerPtr) != TCL_OK) {
+                return TCL_ERROR;
+            }
+            if (readerPtr->token == DOT_TOK_COMMA || readerPtr->token == DOT_TOK_SEMICOLON) {
+                if (DotAdvance(readerPtr) != TCL_OK) {
+                    return TCL_ERROR;
+                }
+            }
+        }
+        if (readerPtr->token != DOT_TOK_RBRACKET) {
+            return DotSyntaxError(readerPtr);
+        }
+        if (DotAdvance(readerPtr) != TCL_OK) {
+            return TCL_ERROR;
+        }
+    }
+    return TCL_OK;
+}
+
+/* Reads a node id and skips its port, if any */
+static int DotParseNodeId(DotReader* readerPtr, Tcl_Obj** idObjPtr)
+{
+    if (DotIsKeyword(readerPtr, "subgraph") || readerPtr->token == DOT_TOK_LBRACE) {
+        return DotError(readerPtr, "subgraphs are not supported");
+    }
+    if (readerPtr->token != DOT_TOK_ID) {
+        return DotSyntaxError(readerPtr);
+    }
+    *idObjPtr = DotTokenObj(readerPtr);
+    if (DotAdvance(readerPtr) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    while (readerPtr->token == DOT_TOK_COLON) {
+        if (DotAdvance(readerPtr) != TCL_OK) {
+            return TCL_ERROR;
+        }
+        if (readerPtr->token != DOT_TOK_ID) {
+            return DotSyntaxError(readerPtr);
+        }
+        if (DotAdvance(readerPtr) != TCL_OK) {
+            return TCL_ERROR;
+        }
+    }
+    return TCL_OK;
+}
+
+/* Adds the labels of a list to a label set and to one label index */
+static int DotAddLabels(DotReader* readerPtr, LabelSet* labelsPtr, Tcl_HashTable* indexPtr, ClientData entity,
+    Tcl_Obj* listObj)
+{
+    Tcl_HashTable* indexes[2];
+    Tcl_Obj** labels;
+    int count;
+
+    if (Tcl_ListObjGetElements(readerPtr->interp, listObj, &count, &labels) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    indexes[0] = indexPtr;
+    indexes[1] = NULL;
+    for (int i = 0; i < count; i++) {
+        int id = GraphsInt_LabelIntern(readerPtr->graphPtr->statePtr, labels[i]);
+        if (GraphsInt_LabelSetAdd(labelsPtr, id)) {
+            GraphsInt_LabelIndexUpdate(indexes, id, entity, 1);
+        }
+    }
+    return TCL_OK;
+}
+
+static void DotSetData(Tcl_Obj** dataRef, Tcl_Obj* valueObj)
+{
+    Tcl_DecrRefCount(*dataRef);
+    *dataRef = valueObj;
+    Tcl_IncrRefCount(valueObj);
+}
+
+static int DotApplyNodeAttrs(DotReader* readerPtr, Node* nodePtr, Tcl_Obj* attrsObj)
+{
+    Graph* graphPtr = readerPtr->graphPtr;
+    Tcl_Obj** attrs;
+    int count;
+
+    Tcl_ListObjGetElements(NULL, attrsObj, &count, &attrs);
+    for (int i = 0; i < count; i += 2) {
+        const char* key = Tcl_GetString(attrs[i]);
+        GraphsAttr* attrPtr;
+
+        if (strcmp(key, "labels") == 0) {
+            if (DotAddLabels(readerPtr, &nodePtr->labels, &graphPtr->nodesByLabel, nodePtr, attrs[i + 1]) != TCL_OK) {
+                return TCL_ERROR;
+            }
+        }
+        else if (strcmp(key, "data") == 0) {
+            DotSetData(&nodePtr->data, attrs[i + 1]);
+        }
+        else if ((attrPtr = GraphsInt_AttrFind(&graphPtr->nodeAttrs, key)) != NULL) {
+            if (GraphsInt_AttrSetFromObj(readerPtr->interp, attrPtr, nodePtr->id, attrs[i + 1]) != TCL_OK) {
+                return TCL_ERROR;
+            }
+        }
+    }
+    return TCL_OK;
+}
+
+static int DotApplyEdgeAttrs(DotReader* readerPtr, Edge* edgePtr, Tcl_Obj* attrsObj)
+{
+    Graph* graphPtr = readerPtr->graphPtr;
+    Tcl_Obj** attrs;
+    int count;
+
+    Tcl_ListObjGetElements(NULL, attrsObj, &count, &attrs);
+    for (int i = 0; i < count; i += 2) {
+        const char* key = Tcl_GetString(attrs[i]);
+        GraphsAttr* attrPtr;
+
+        if (strcmp(key, "label") == 0) {
+            GraphsInt_EdgeSetName(edgePtr, Tcl_GetString(attrs[i + 1]));
+        }
+        else if (strcmp(key, "weight") == 0) {
+            double weight;
+            if (Tcl_GetDoubleFromObj(readerPtr->interp, attrs[i + 1], &weight) != TCL_OK) {
+                return TCL_ERROR;
+            }
+            GraphsInt_EdgeSetWeight(edgePtr, weight);
+        }
+        else if (strcmp(key, "data") == 0) {
+            DotSetData(&edgePtr->data, attrs[i + 1]);
+        }
+        else if (strcmp(key, "labels") == 0) {
+            if (DotAddLabels(readerPtr, &edgePtr->labels, &graphPtr->edgesByLabel, edgePtr, attrs[i + 1]) != TCL_OK) {
+                return TCL_ERROR;
+            }
+        }
+        else if ((attrPtr = GraphsInt_AttrFind(&graphPtr->edgeAttrs, key)) != NULL) {
+            if (GraphsInt_AttrSetFromObj(readerPtr->interp, attrPtr, edgePtr->id, attrs[i + 1]) != TCL_OK) {
+                return TCL_ERROR;
+            }
+        }
+    }
+    return TCL_OK;
+}
+
+/* Whether the last dir attribute of a list says none */
+static int DotDirNone(Tcl_Obj* attrsObj, int dirNone)
+{
+    Tcl_Obj** attrs;
+    int count;
+
+    Tcl_ListObjGetElements(NULL, attrsObj, &count, &attrs);
+    for (int i = 0; i < count; i += 2) {
+        if (strcmp(Tcl_GetString(attrs[i]), "dir") == 0) {
+            dirNone = (strcmp(Tcl_GetString(attrs[i + 1]), "none") == 0);
+        }
+    }
+    return dirNone;
+}
+
+/*
+ * Checks the values of the attributes of a node (edges 0) or edge (edges 1) list that DotApplyNodeAttrs() or
+ * DotApplyEdgeAttrs() take over, so that applying them cannot fail half way through a statement
+ */
+/* The last weight in an attribute list, or weight if there is none. Bad values are caught by DotCheckAttrs(). */
+static double DotWeight(Tcl_Obj* attrsObj, double weight)
+{
+    Tcl_Obj** attrs;
+    int count;
+
+    Tcl_ListObjGetElements(NULL, attrsObj, &count, &attrs);
+    for (int i = 0; i < count; i += 2) {
+        if (strcmp(Tcl_GetString(attrs[i]), "weight") == 0) {
+            Tcl_GetDoubleFromObj(NULL, attrs[i + 1], &weight);
+        }
+    }
+    return weight;
+}
+
+static int DotCheckAttrs(DotReader* readerPtr, Tcl_Obj* attrsObj, int edges)
+{
+    Graph* graphPtr = readerPtr->graphPtr;
+    Tcl_Obj** attrs;
+    int count;
+
+    Tcl_ListObjGetElements(NULL, attrsObj, &count, &attrs);
+    for (int i = 0; i < count; i += 2) {
+        const char* key = Tcl_GetString(attrs[i]);
+        GraphsAttr* attrPtr;
+        double weight;
+        int length;
+
+        if (strcmp(key, "data") == 0 || (edges && strcmp(key, "label") == 0)) {
+            continue;
+        }
+        if (strcmp(key, "labels") == 0) {
+            if (Tcl_ListObjLength(readerPtr->interp, attrs[i + 1], &length) != TCL_OK) {
+                return TCL_ERROR;
+            }
+        }
+        else if (edges && strcmp(key, "weight") == 0) {
+            if (Tcl_GetDoubleFromObj(readerPtr->interp, attrs[i + 1], &weight) != TCL_OK) {
+                return TCL_ERROR;
+            }
+        }
+        else if ((attrPtr = GraphsInt_AttrFind(edges ? &graphPtr->edgeAttrs : &graphPtr->nodeAttrs, key)) != NULL) {
+            if (GraphsInt_AttrCheckObj(readerPtr->interp, attrPtr, attrs[i + 1]) != TCL_OK) {
+                return TCL_ERROR;
+            }
+        }
+    }
+    return TCL_OK;
+}
+
+/* In a strict graph, the edge that an edge from fromNodePtr to nodePtr would repeat, otherwise NULL */
+static Edge* DotStrictEdge(DotReader* readerPtr, Node* fromNodePtr, Node* nodePtr, int undirected)
+{
+    DeltaEntry* entry;
+
+    if (!readerPtr->strict) {
+        return NULL;
+    }
+    if ((entry = GraphsInt_DeltaFind(fromNodePtr, DELTA_PLUS, nodePtr)) != NULL) {
+        return entry->edgePtr;
+    }
+    if (undirected && (entry = GraphsInt_DeltaFind(nodePtr, DELTA_PLUS, fromNodePtr)) != NULL) {
+        return entry->edgePtr;
+    }
+    return NULL;
+}
+
+/*
+ * The nodes and edges a statement refers to, and which of them it created. A statement that fails deletes
+ * the ones it created again.
+ */
+typedef struct _dotStatement
+{
+    Node** nodes;
+    Edge** edges;
+    Node** newNodes;
+    Edge** newEdges;
+    int newNodeCount;
+    int newEdgeCount;
+} DotStatement;
+
+/* Looks up or creates the node with an id, new nodes get the defaults of the node [...] statements */
+static Node* DotNode(DotReader* readerPtr, DotStatement* stmtPtr, Tcl_Obj* idObj)
+{
+    Graph* graphPtr = readerPtr->graphPtr;
+    const char* name = Tcl_GetString(idObj);
+    Node* nodePtr;
+
+    if (GraphsInt_IndexGet(&graphPtr->nodesByName, name) != NULL) {
+        return GraphsInt_GraphGetOrCreateNode(graphPtr, name, readerPtr->interp);
+    }
+    if (DotCheckAttrs(readerPtr, readerPtr->nodeDefaults, 0) != TCL_OK
+        || (nodePtr = GraphsInt_GraphGetOrCreateNode(graphPtr, name, readerPtr->interp)) == NULL) {
+        return NULL;
+    }
+    stmtPtr->newNodes[stmtPtr->newNodeCount++] = nodePtr;
+    DotApplyNodeAttrs(readerPtr, nodePtr, readerPtr->nodeDefaults);
+    return nodePtr;
+}
+
+/*
+ * Finds (in a strict graph) or creates an edge of a chain, new edges get the defaults of edge [...] statements.
+ * New edges are created with the weight the statement ends up giving them.
+ */
+static Edge* DotEdge(DotReader* readerPtr, DotStatement* stmtPtr, Node* fromNodePtr, Node* nodePtr, int undirected,
+    double weight)
+{
+    Edge* edgePtr = DotStrictEdge(readerPtr, fromNodePtr, nodePtr, undirected);
+
+    if (edgePtr != NULL) {
+        return edgePtr;
+    }
+    if (DotCheckAttrs(readerPtr, readerPtr->edgeDefaults, 1) != TCL_OK
+        || (edgePtr = GraphsInt_EdgeCreateWeighted(readerPtr->graphPtr->statePtr, fromNodePtr, nodePtr, undirected,
+                weight, readerPtr->interp)) == NULL) {
+        return NULL;
+    }
+    stmtPtr->newEdges[stmtPtr->newEdgeCount++] = edgePtr;
+    DotApplyEdgeAttrs(readerPtr, edgePtr, readerPtr->edgeDefaults);
+    return edgePtr;
+}
+
+/* Deletes the edges and then the nodes a failing statement created, keeping the error message */
+static void DotUndo(DotReader* readerPtr, DotStatement* stmtPtr)
+{
+    Tcl_Obj* msg = Tcl_GetObjResult(readerPtr->interp);
+
+    Tcl_IncrRefCount(msg);
+    while (stmtPtr->newEdgeCount > 0) {
+        Graphs_EdgeDeleteEdge(stmtPtr->newEdges[--stmtPtr->newEdgeCount], readerPtr->interp);
+    }
+    while (stmtPtr->newNodeCount > 0) {
+        Graphs_NodeDeleteNode(stmtPtr->newNodes[--stmtPtr->newNodeCount], readerPtr->interp);
+    }
+    Tcl_SetObjResult(readerPtr->interp, msg);
+    Tcl_DecrRefCount(msg);
+}
+
+/*
+ * Creates the nodes and edges of a node or edge statement. ids holds the node ids, ops the edge operators
+ * between them. The attributes are checked first and applied last, so that a statement either takes effect
+ * completely or, if a node or edge cannot be created, not at all.
+ */
+static int DotCreate(DotReader* readerPtr, Tcl_Obj* ids[], const DotTokenT ops[], int idCount, Tcl_Obj* attrsObj)
+{
+    DotStatement stmt;
+    int dirNone = DotDirNone(attrsObj, DotDirNone(readerPtr->edgeDefaults, 0));
+    int result = TCL_ERROR;
+    double weight;
+
+    if (DotCheckAttrs(readerPtr, attrsObj, idCount > 1) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    weight = DotWeight(attrsObj, DotWeight(readerPtr->edgeDefaults, 0.));
+
+    stmt.nodes = (Node**)ckalloc(2 * idCount * sizeof(Node*));
+    stmt.newNodes = stmt.nodes + idCount;
+    stmt.edges = (Edge**)ckalloc(2 * idCount * sizeof(Edge*));
+    stmt.newEdges = stmt.edges + idCount;
+    stmt.newNodeCount = stmt.newEdgeCount = 0;
+
+    for (int i = 0; i < idCount; i++) {
+        if ((stmt.nodes[i] = DotNode(readerPtr, &stmt, ids[i])) == NULL) {
+            goto done;
+        }
+        if (i > 0) {
+            int undirected = (ops[i - 1] == DOT_TOK_DASHDASH) || dirNone;
+            if ((stmt.edges[i - 1] = DotEdge(readerPtr, &stmt, stmt.nodes[i - 1], stmt.nodes[i], undirected,
+                     weight)) == NULL) {
+                goto done;
+            }
+        }
+    }
+
+    if (idCount == 1) {
+        DotApplyNodeAttrs(readerPtr, stmt.nodes[0], attrsObj);
+    }
+    for (int i = 0; i < idCount - 1; i++) {
+        DotApplyEdgeAttrs(readerPtr, stmt.edges[i], attrsObj);
+    }
+    result = TCL_OK;
+
+done:
+    if (result != TCL_OK) {
+        DotUndo(readerPtr, &stmt);
+    }
+    ckfree((char*)stmt.nodes);
+    ckfree((char*)stmt.edges);
+    return result;
+}
+
+/* Parses one statement, the current token is its first one */
+static int DotParseStatement(DotReader* readerPtr)
+{
+    Tcl_Obj* attrsObj;
+    Tcl_Obj** ids = NULL;
+    DotTokenT* ops = NULL;
+    int idCount = 0, idSize = 0, result = TCL_ERROR, line = readerPtr->tokenLine;
+
+    /* attribute statements */
+    if (DotIsKeyword(readerPtr, "node") || DotIsKeyword(readerPtr, "edge") || DotIsKeyword(readerPtr, "graph")) {
+        Tcl_Obj** defaultsRef = DotIsKeyword(readerPtr, "node") ? &readerPtr->nodeDefaults
+            : DotIsKeyword(readerPtr, "edge") ? &readerPtr->edgeDefaults : NULL;
+
+        if (DotAdvance(readerPtr) != TCL_OK) {
+            return TCL_ERROR;
+        }
+        if (readerPtr->token != DOT_TOK_LBRACKET) {
+            return DotSyntaxError(readerPtr);
+        }
+        attrsObj = Tcl_NewListObj(0, NULL);
+        Tcl_IncrRefCount(attrsObj);
+        if (DotParseAttrs(readerPtr, attrsObj) == TCL_OK) {
+            if (defaultsRef != NULL) {
+                Tcl_Obj* defaultsObj = *defaultsRef;
+                if (Tcl_IsShared(defaultsObj)) {
+                    Tcl_DecrRefCount(defaultsObj);
+                    defaultsObj = Tcl_DuplicateObj(defaultsObj);
+                    Tcl_IncrRefCount(defaultsObj);
+                    *defaultsRef = defaultsObj;
+                }
+                Tcl_ListObjAppendList(NULL, defaultsObj, attrsObj);
+            }
+            result = TCL_OK;
+        }
+        Tcl_DecrRefCount(attrsObj);
+        return result;
+    }
+
+    attrsObj = Tcl_NewListObj(0, NULL);
+    Tcl_IncrRefCount(attrsObj);
+    for (;;) {
+        if (idCount == idSize) {
+            idSize = (idSize == 0) ? 4 : 2 * idSize;
+            ids = (Tcl_Obj**)ckrealloc((char*)ids, idSize * sizeof(Tcl_Obj*));
+            ops = (DotTokenT*)ckrealloc((char*)ops, idSize * sizeof(DotTokenT));
+        }
+        if (DotParseNodeId(readerPtr, &ids[idCount]) != TCL_OK) {
+            goto done;
+        }
+        Tcl_IncrRefCount(ids[idCount]);
+        idCount++;
+
+        /* graph attributes ID = ID are ignored */
+        if (idCount == 1 && readerPtr->token == DOT_TOK_EQUAL) {
+            if (DotAdvance(readerPtr) != TCL_OK) {
+                goto done;
+            }
+            if (readerPtr->token != DOT_TOK_ID) {
+                DotSyntaxError(readerPtr);
+                goto done;
+            }
+            result = DotAdvance(readerPtr);
+            goto done;
+        }
+        if (readerPtr->token != DOT_TOK_ARROW && readerPtr->token != DOT_TOK_DASHDASH) {
+            break;
+        }
+        if (readerPtr->token == DOT_TOK_ARROW && readerPtr->undirectedGraph) {
+            DotError(readerPtr, "\"->\" in an undirected graph");
+            goto done;
+        }
+        ops[idCount - 1] = readerPtr->token;
+        if (DotAdvance(readerPtr) != TCL_OK) {
+            goto done;
+        }
+    }
+    if (DotParseAttrs(readerPtr, attrsObj) != TCL_OK) {
+        goto done;
+    }
+    result = DotCreate(readerPtr, ids, ops, idCount, attrsObj);
+    if (result != TCL_OK) {
+        readerPtr->tokenLine = line;
+        DotError(readerPtr, Tcl_GetString(Tcl_GetObjResult(readerPtr->interp)));
+    }
+
+done:
+    for (int i = 0; i < idCount; i++) {
+        Tcl_DecrRefCount(ids[i]);
+    }
+    if (ids != NULL) {
+        ckfree((char*)ids);
+        ckfree((char*)ops);
+    }
+    Tcl_DecrRefCount(attrsObj);
+    return result;
+}
+
+/*
+ * Parses a whole document: ?strict? graph|digraph ?ID? { statements }. Leaves the ID of the graph in the
+ * interp result.
+ */
+static int DotParse(DotReader* readerPtr)
+{
+    Tcl_Obj* nameObj = NULL;
+    int result;
+
+    if (DotAdvance(readerPtr) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    readerPtr->strict = DotIsKeyword(readerPtr, "strict");
+    if (readerPtr->strict && DotAdvance(readerPtr) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    if (!DotIsKeyword(readerPtr, "graph") && !DotIsKeyword(readerPtr, "digraph")) {
+        return DotSyntaxError(readerPtr);
+    }
+    readerPtr->undirectedGraph = DotIsKeyword(readerPtr, "graph");
+    if (DotAdvance(readerPtr) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    if (readerPtr->token == DOT_TOK_ID) {
+        nameObj = DotTokenObj(readerPtr);
+        Tcl_IncrRefCount(nameObj);
+        if (DotAdvance(readerPtr) != TCL_OK) {
+            Tcl_DecrRefCount(nameObj);
+            return TCL_ERROR;
+        }
+    }
+    if (readerPtr->token != DOT_TOK_LBRACE) {
+        if (nameObj != NULL) {
+            Tcl_DecrRefCount(nameObj);
+        }
+        return DotSyntaxError(readerPtr);
+    }
+
+    result = DotAdvance(readerPtr);
+    while (result == TCL_OK && readerPtr->token != DOT_TOK_RBRACE) {
+        if (readerPtr->token == DOT_TOK_EOF) {
+            result = DotSyntaxError(readerPtr);
+        }
+        else if (readerPtr->token == DOT_TOK_SEMICOLON) {
+            result = DotAdvance(readerPtr);
+        }
+        else {
+            result = DotParseStatement(readerPtr);
+        }
+    }
+    if (result != TCL_OK) {
+        if (nameObj != NULL) {
+            Tcl_DecrRefCount(nameObj);
+        }
+        return TCL_ERROR;
+    }
+    Tcl_SetObjResult(readerPtr->interp, nameObj != NULL ? nameObj : Tcl_NewObj());
+    if (nameObj != NULL) {
+        Tcl_DecrRefCount(nameObj);
+    }
+    return TCL_OK;
+}
+
+/*
+ * Implements [$graph read dot <channel>] and [$graph read dot -string <dot>]. Returns the name of the graph
+ * in the document.
+ */
+int GraphsInt_GraphCmdRead(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[])
+{
+    static const char* formats[] = { "dot", NULL };
+    DotReader reader;
+    int idx, mode, result;
+
+    if ((objc != 2 && objc != 3) || (objc == 3 && strcmp(Tcl_GetString(objv[1]), "-string") != 0)) {
+        Tcl_WrongNumArgs(interp, 0, objv, "dot <channel> | dot -string <dot>");
+        return TCL_ERROR;
+    }
+    if (Tcl_GetIndexFromObj(interp, objv[0], formats, "format", 0, &idx) != TCL_OK) {
+        return TCL_ERROR;
+    }
+
+    reader.interp = interp;
+    reader.graphPtr = graphPtr;
+    reader.chan = NULL;
+    reader.line = 1;
+    reader.tokenLine = 1;
+    reader.token = DOT_TOK_EOF;
+    reader.quoted = 0;
+    reader.undirectedGraph = 0;
+    reader.strict = 0;
+    reader.readError = NULL;
+    if (objc == 3) {
+        int length;
+        reader.chunkObj = objv[2];
+        reader.pos = Tcl_GetStringFromObj(objv[2], &length);
+        reader.end = reader.pos + length;
+    }
+    else {
+        if ((reader.chan = Tcl_GetChannel(interp, Tcl_GetString(objv[1]), &mode)) == NULL) {
+            return TCL_ERROR;
+        }
+        if ((mode & TCL_READABLE) == 0) {
+            Tcl_SetObjResult(interp, Tcl_ObjPrintf("channel \"%s\" wasn't opened for reading",
+                Tcl_GetString(objv[1])));
+            return TCL_ERROR;
+        }
+        reader.chunkObj = Tcl_NewObj();
+        reader.pos = reader.end = NULL;
+    }
+    Tcl_IncrRefCount(reader.chunkObj);
+    Tcl_DStringInit(&reader.text);
+    reader.nodeDefaults = Tcl_NewListObj(0, NULL);
+    reader.edgeDefaults = Tcl_NewListObj(0, NULL);
+    Tcl_IncrRefCount(reader.nodeDefaults);
+    Tcl_IncrRefCount(reader.edgeDefaults);
+
+    result = DotParse(&reader);
+
+    Tcl_DecrRefCount(reader.nodeDefaults);
+    Tcl_DecrRefCount(reader.edgeDefaults);
+    Tcl_DStringFree(&reader.text);
+    Tcl_DecrRefCount(reader.chunkObj);
+    return result;
+}
@@ -41,6 +41,7 @@ static const char* EdgeCGetOptions[] = {
     "-weight",
     "-data",
     "-directed",
+    "-attr",
     NULL
 };
 
@@ -51,7 +52,8 @@ enum EdgeCGetOptionsIndex
     EdgeCGetOptionToIx,
     EdgeCGetOptionWeightIx,
     EdgeCGetOptionDataIx,
-    EdgeCGetOptionDirectedIx
+    EdgeCGetOptionDirectedIx,
+    EdgeCGetOptionAttrIx
 };
 
 static const char* EdgeGetOptions[] = {
@@ -63,12 +65,13 @@ enum EdgeGetOptionIndex
     EdgeGetOptionMarkIx
 };
 
-static const char* EdgeConfigureOptions[] = { "-name", "-weight", "-data", NULL };
+static const char* EdgeConfigureOptions[] = { "-name", "-weight", "-data", "-attr", NULL };
 enum EdgeConfigureOptionsIndex
 {
     ConfigureOptionNameIx,
     ConfigureOptionWeightIx,
-    ConfigureOptionDataIx
+    ConfigureOptionDataIx,
+    ConfigureOptionAttrIx
 };
 
 static const char* EdgeMarks[] = { "hidden", "cut", NULL };
@@ -78,51 +81,195 @@ enum EdgeMarksIndex
     EdgeMarkCutIx
 };
 
-static const DeltaEntry* FindDeltaEntryByNode(const DeltaEntry* start, const Node* nodePtr)
+/*
+ * An edge is listed in the edge tables (and label indexes) of the graphs of both of its nodes
+ */
+static void EdgeAddToGraph(Graph* graphPtr, Edge* edgePtr)
 {
-    const DeltaEntry* entry = start;
-    while (entry != NULL) {
-        if (entry->nodePtr == nodePtr) {
-            return entry;
+    int new;
+    Tcl_HashEntry* entry;
+
+    if (graphPtr != NULL) {
+        entry = Tcl_CreateHashEntry(&graphPtr->edges, (ClientData)edgePtr, &new);
+        if (new) {
+            Tcl_SetHashValue(entry, edgePtr);
+            GraphsInt_LabelIndexUpdateAll(&graphPtr->edgesByLabel, &edgePtr->labels, edgePtr, 1);
+            GraphsInt_IndexAdd(&graphPtr->edgesByName, edgePtr->name, edgePtr);
         }
-        entry = entry->next;
     }
+}
 
-    return NULL;
+static void EdgeRemoveFromGraph(Graph* graphPtr, Edge* edgePtr)
+{
+    if (graphPtr != NULL) {
+        Tcl_HashEntry* entry = Tcl_FindHashEntry(&graphPtr->edges, (ClientData)edgePtr);
+        if (entry != NULL) {
+            Tcl_DeleteHashEntry(entry);
+            GraphsInt_LabelIndexUpdateAll(&graphPtr->edgesByLabel, &edgePtr->labels, edgePtr, 0);
+            GraphsInt_IndexRemove(&graphPtr->edgesByName, edgePtr->name, edgePtr);
+            GraphsInt_AttrsReset(&graphPtr->edgeAttrs, edgePtr->id);
+        }
+        entry = Tcl_FindHashEntry(&graphPtr->cut, (ClientData)edgePtr);
+        if (entry != NULL) {
+            Tcl_DeleteHashEntry(entry);
+        }
+    }
 }
 
-static void FindAndDeleteDeltaEntryByNode(DeltaEntry** start, const Node* nodePtr)
+/*
+ * Brings the membership of an edge in the edge table, the edge indexes and the cut of a graph in line with
+ * the graphs of its nodes: graphs list the edges with at least one node in them, and their cut holds the
+ * edges with exactly one node in them.
+ */
+void GraphsInt_EdgeRefreshGraph(Edge* edgePtr, Graph* graphPtr)
 {
-    DeltaEntry* now = *start;
-    DeltaEntry* prev = NULL;
+    int inside;
 
-    while (now != NULL) {
-        if (now->nodePtr == nodePtr) {
-            if (prev != NULL) {
-                prev->next = now->next;
-            }
-            else {
-                *start = now->next;
-            }
-            ckfree((ClientData)now);
-            break;
+    if (graphPtr == NULL) {
+        return;
+    }
+    inside = (edgePtr->fromNode->graph == graphPtr) + (edgePtr->toNode->graph == graphPtr);
+    if (inside == 0) {
+        EdgeRemoveFromGraph(graphPtr, edgePtr);
+        return;
+    }
+    EdgeAddToGraph(graphPtr, edgePtr);
+    if (inside == 1) {
+        int new;
+        Tcl_HashEntry* entry = Tcl_CreateHashEntry(&graphPtr->cut, (ClientData)edgePtr, &new);
+        Tcl_SetHashValue(entry, edgePtr);
+    }
+    else {
+        Tcl_HashEntry* entry = Tcl_FindHashEntry(&graphPtr->cut, (ClientData)edgePtr);
+        if (entry != NULL) {
+            Tcl_DeleteHashEntry(entry);
+        }
+    }
+}
+
+/*
+ * Collects the (at most two) graphs whose edge tables list the edge. Returns their number.
+ */
+static int EdgeListingGraphs(const Edge* edgePtr, Graph* graphs[2])
+{
+    Graph* candidates[2];
+    int count = 0;
+
+    candidates[0] = (edgePtr->fromNode != NULL) ? edgePtr->fromNode->graph : NULL;
+    candidates[1] = (edgePtr->toNode != NULL && edgePtr->toNode->graph != candidates[0]) ? edgePtr->toNode->graph : NULL;
+    for (int i = 0; i < 2; i++) {
+        if (candidates[i] != NULL && Tcl_FindHashEntry(&candidates[i]->edges, (ClientData)edgePtr) != NULL) {
+            graphs[count++] = candidates[i];
+        }
+    }
+    return count;
+}
+
+/*
+ * Sets the -name of an edge and keeps the name indexes of the graphs listing the edge up to date
+ */
+void GraphsInt_EdgeSetName(Edge* edgePtr, const char* name)
+{
+    Graph* graphs[2];
+    int count = EdgeListingGraphs(edgePtr, graphs);
+
+    for (int i = 0; i < count; i++) {
+        GraphsInt_IndexRemove(&graphs[i]->edgesByName, edgePtr->name, edgePtr);
+    }
+    GraphsInt_NameSet(&edgePtr->name, name);
+    for (int i = 0; i < count; i++) {
+        GraphsInt_IndexAdd(&graphs[i]->edgesByName, edgePtr->name, edgePtr);
+    }
+}
+
+/*
+ * Sets the -weight of an edge. Moves the edge in the delta lists of its nodes that are kept sorted by weight.
+ */
+void GraphsInt_EdgeSetWeight(Edge* edgePtr, double weight)
+{
+    Node* fromNodePtr = edgePtr->fromNode;
+    Node* toNodePtr = edgePtr->toNode;
+
+    if (edgePtr->weight == weight) {
+        return;
+    }
+    edgePtr->weight = weight;
+    /* weights are copied into snapshots */
+    GraphsInt_SnapshotInvalidate(fromNodePtr->graph);
+    GraphsInt_SnapshotInvalidate(toNodePtr->graph);
+
+    GraphsInt_DeltaReposition(fromNodePtr, DELTA_PLUS, toNodePtr);
+    if (edgePtr->directionType == EDGE_UNDIRECTED) {
+        if (toNodePtr != fromNodePtr) {
+            GraphsInt_DeltaReposition(toNodePtr, DELTA_PLUS, fromNodePtr);
         }
-        prev = now;
-        now = now->next;
+    }
+    else {
+        GraphsInt_DeltaReposition(toNodePtr, DELTA_MINUS, fromNodePtr);
     }
 }
 
+/*
+ * Labels of the edge, keeps the label indexes of the graphs listing the edge up to date
+ */
+static int EdgeLabelsCommand(Edge* edgePtr, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[])
+{
+    Tcl_HashTable* indexes[3];
+    Graph* graphs[2];
+    int count = EdgeListingGraphs(edgePtr, graphs);
+
+    for (int i = 0; i < count; i++) {
+        indexes[i] = &graphs[i]->edgesByLabel;
+    }
+    indexes[count] = NULL;
+    return GraphsInt_LabelsCommand(edgePtr->statePtr, &edgePtr->labels, indexes, edgePtr, interp, objc, objv);
+}
+
+/*
+ * Finds an attribute column for an edge in the graphs of its nodes, see attrs.c. An edge between two graphs
+ * has a value in both graphs that declare the name, this is an error rather than a silent choice of one.
+ */
+static GraphsAttr* EdgeGetAttr(Edge* edgePtr, Tcl_Obj* nameObj, Tcl_Interp* interp)
+{
+    const char* name = Tcl_GetString(nameObj);
+    Graph* fromGraphPtr = edgePtr->fromNode->graph;
+    Graph* toGraphPtr = edgePtr->toNode->graph;
+    GraphsAttr* fromAttrPtr = NULL;
+    GraphsAttr* toAttrPtr = NULL;
+
+    if (fromGraphPtr != NULL) {
+        fromAttrPtr = GraphsInt_AttrFind(&fromGraphPtr->edgeAttrs, name);
+    }
+    if (toGraphPtr != NULL && toGraphPtr != fromGraphPtr) {
+        toAttrPtr = GraphsInt_AttrFind(&toGraphPtr->edgeAttrs, name);
+    }
+    if (fromAttrPtr != NULL && toAttrPtr != NULL) {
+        Tcl_SetObjResult(interp, Tcl_ObjPrintf("edge attribute \"%s\" of %s is declared in both %s and %s", name,
+            edgePtr->cmdName, fromGraphPtr->cmdName, toGraphPtr->cmdName));
+        return NULL;
+    }
+    if (fromAttrPtr == NULL && toAttrPtr == NULL) {
+        Tcl_SetObjResult(interp, Tcl_ObjPrintf("no edge attribute \"%s\" in the graphs of %s", name,
+            edgePtr->cmdName));
+        return NULL;
+    }
+    return (fromAttrPtr != NULL) ? fromAttrPtr : toAttrPtr;
+}
 
 int EdgeCmdCget(Edge* edgePtr, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[])
 {
     int optIdx;
-    if (objc != 1) {
-        Tcl_WrongNumArgs(interp, 0, objv, "option arg");
+    if (objc < 1 || objc > 2) {
+        Tcl_WrongNumArgs(interp, 0, objv, "option ?name?");
         return TCL_ERROR;
     }
     if (Tcl_GetIndexFromObj(interp, objv[0], EdgeCGetOptions, "option", 0, &optIdx) != TCL_OK) {
         return TCL_ERROR;
     }
+    if ((optIdx == EdgeCGetOptionAttrIx) != (objc == 2)) {
+        Tcl_WrongNumArgs(interp, 0, objv, optIdx == EdgeCGetOptionAttrIx ? "-attr name" : "option");
+        return TCL_ERROR;
+    }
 
     switch (optIdx) {
     case EdgeCGetOptionNameIx: {
@@ -130,11 +277,11 @@ int EdgeCmdCget(Edge* edgePtr, Tcl_Interp* interp, int objc, Tcl_Obj* const objv
         return TCL_OK;
     }
     case EdgeCGetOptionFromIx: {
-        Tcl_SetObjResult(interp, Tcl_NewStringObj(edgePtr->fromNode->cmdName, -1));
+        Tcl_SetObjResult(interp, GraphsInt_NodeHandleObj(edgePtr->fromNode));
         return TCL_OK;
     }
     case EdgeCGetOptionToIx: {
-        Tcl_SetObjResult(interp, Tcl_NewStringObj(edgePtr->toNode->cmdName, -1));
+        Tcl_SetObjResult(interp, GraphsInt_NodeHandleObj(edgePtr->toNode));
         return TCL_OK;
     }
     case EdgeCGetOptionWeightIx: {
@@ -149,6 +296,14 @@ int EdgeCmdCget(Edge* edgePtr, Tcl_Interp* interp, int objc, Tcl_Obj* const objv
         Tcl_SetObjResult(interp, Tcl_NewBooleanObj(edgePtr->directionType == EDGE_DIRECTED));
         return TCL_OK;
     }
+    case EdgeCGetOptionAttrIx: {
+        GraphsAttr* attrPtr = EdgeGetAttr(edgePtr, objv[1], interp);
+        if (attrPtr == NULL) {
+            return TCL_ERROR;
+        }
+        Tcl_SetObjResult(interp, GraphsInt_AttrGetObj(attrPtr, edgePtr->id));
+        return TCL_OK;
+    }
     default: {
         break;
     }
@@ -161,7 +316,7 @@ int EdgeCmdConfigure(Edge* edgePtr, Tcl_Interp* interp, int objc, Tcl_Obj* const
 {
     int i, optIdx;
 
-    if (objc < 1 || objc > 12 || (objc % 2) != 0) {
+    if (objc < 1) {
         Tcl_WrongNumArgs(interp, 1, objv, "option ?arg ...?");
         return TCL_ERROR;
     }
@@ -169,15 +324,22 @@ int EdgeCmdConfigure(Edge* edgePtr, Tcl_Interp* interp, int objc, Tcl_Obj* const
         if (Tcl_GetIndexFromObj(interp, objv[i], EdgeConfigureOptions, "option", 0, &optIdx) != TCL_OK) {
             return TCL_ERROR;
         }
+        /* -attr takes a name and a value */
+        if (i + 1 >= objc || (optIdx == ConfigureOptionAttrIx && i + 2 >= objc)) {
+            Tcl_WrongNumArgs(interp, 1, objv, "option ?arg ...?");
+            return TCL_ERROR;
+        }
         switch (optIdx) {
         case ConfigureOptionNameIx: {
-            sprintf(edgePtr->name, "%s", Tcl_GetString(objv[i + 1]));
+            GraphsInt_EdgeSetName(edgePtr, Tcl_GetString(objv[i + 1]));
             break;
         }
         case ConfigureOptionWeightIx: {
-            if (Tcl_GetDoubleFromObj(interp, objv[i + 1], &edgePtr->weight) != TCL_OK) {
+            double weight;
+            if (Tcl_GetDoubleFromObj(interp, objv[i + 1], &weight) != TCL_OK) {
                 return TCL_ERROR;
             }
+            GraphsInt_EdgeSetWeight(edgePtr, weight);
             break;
         }
         case ConfigureOptionDataIx: {
@@ -186,6 +348,14 @@ int EdgeCmdConfigure(Edge* edgePtr, Tcl_Interp* interp, int objc, Tcl_Obj* const
             Tcl_IncrRefCount(edgePtr->data);
             break;
         }
+        case ConfigureOptionAttrIx: {
+            GraphsAttr* attrPtr = EdgeGetAttr(edgePtr, objv[i + 1], interp);
+            if (attrPtr == NULL || GraphsInt_AttrSetFromObj(interp, attrPtr, edgePtr->id, objv[i + 2]) != TCL_OK) {
+                return TCL_ERROR;
+            }
+            i++;
+            break;
+        }
         default: {
             Tcl_SetObjResult(interp, Tcl_NewStringObj("Wrong options in edge configure", -1));
             return TCL_ERROR;
@@ -199,7 +369,7 @@ int EdgeCmdConfigure(Edge* edgePtr, Tcl_Interp* interp, int objc, Tcl_Obj* const
 
 int EdgeCmdDestroy(Edge* edgePtr, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[])
 {
-    Tcl_DeleteCommandFromToken(interp, edgePtr->commandTkn);
+    Graphs_EdgeDeleteEdge(edgePtr, interp);
     return TCL_OK;
 }
 
@@ -254,7 +424,7 @@ static int EdgeCmd(Edge* edgePtr, enum EdgeSubCommandIndex cmdIdx, Tcl_Interp* i
     case EdgeDestroyIx:
         return EdgeCmdDestroy(edgePtr, interp, objc, objv);
     case EdgeLabelsIx:
-        return GraphsInt_LabelsCommand(edgePtr->labels, interp, objc, objv);
+        return EdgeLabelsCommand(edgePtr, interp, objc, objv);
     case EdgeMarkIx:
     case EdgeUnmarkIx:
     case EdgeIsmarkedIx:
@@ -289,21 +459,28 @@ static int EdgeSubCmd(ClientData clientData, Tcl_Interp* interp, int objc, Tcl_O
     return EdgeCmd(edgePtr, cmdIdx, interp, objc - 2, objv + 2);
 }
 
-static void EdgeDestroyCmd(ClientData clientData)
+/*
+ * Command Delete callback. Called directly for edges that have no command.
+ */
+void GraphsInt_EdgeDestroyCmd(ClientData clientData)
 {
     Edge* edgePtr = (Edge*)clientData;
 
     if (edgePtr->fromNode != NULL && edgePtr->toNode != NULL) {
-        FindAndDeleteDeltaEntryByNode(&edgePtr->fromNode->outgoing, edgePtr->toNode);
-        FindAndDeleteDeltaEntryByNode(&edgePtr->toNode->incoming, edgePtr->fromNode);
+        GraphsInt_SnapshotInvalidate(edgePtr->fromNode->graph);
+        GraphsInt_SnapshotInvalidate(edgePtr->toNode->graph);
+        EdgeRemoveFromGraph(edgePtr->fromNode->graph, edgePtr);
+        EdgeRemoveFromGraph(edgePtr->toNode->graph, edgePtr);
+        GraphsInt_DeltaDelete(edgePtr->fromNode, DELTA_PLUS, edgePtr->toNode);
+        GraphsInt_DeltaDelete(edgePtr->toNode, DELTA_MINUS, edgePtr->fromNode);
 
         /*
          * Undirected edges are linked to the other side (from toNode to fromNode) as well.
          * Delete this link without any further intervention.
          */
         if (edgePtr->directionType == EDGE_UNDIRECTED) {
-            FindAndDeleteDeltaEntryByNode(&edgePtr->toNode->outgoing, edgePtr->fromNode);
-            FindAndDeleteDeltaEntryByNode(&edgePtr->fromNode->incoming, edgePtr->toNode);
+            GraphsInt_DeltaDelete(edgePtr->toNode, DELTA_PLUS, edgePtr->fromNode);
+            GraphsInt_DeltaDelete(edgePtr->fromNode, DELTA_MINUS, edgePtr->toNode);
             edgePtr->fromNode->degreeundir--;
             edgePtr->toNode->degreeundir--;
         } else {
@@ -316,13 +493,16 @@ static void EdgeDestroyCmd(ClientData clientData)
         Tcl_DecrRefCount(edgePtr->data);
     }
 
-    Tcl_DeleteHashTable(&edgePtr->labels);
+    GraphsInt_LabelSetFree(&edgePtr->labels);
+    GraphsInt_NameFree(&edgePtr->name);
     edgePtr->fromNode = edgePtr->toNode = NULL;
 
     Tcl_HashEntry* entry = Tcl_FindHashEntry(&edgePtr->statePtr->edges, edgePtr->cmdName);
     Tcl_DeleteHashEntry(entry);
+    GraphsInt_HandleObjFree(&edgePtr->handleObj);
+    GraphsInt_IdRelease(&edgePtr->statePtr->edgeIds, edgePtr->id);
 
-    Tcl_Free((char*) edgePtr);
+    GraphsInt_PoolFree(&edgePtr->statePtr->edgePool, edgePtr);
 }
 
 
@@ -372,6 +552,10 @@ static int EdgeParseMarks(const char* marksSpec, unsigned int* marksMaskOut) {
  *
  *  edge destroy e
  *  - deletes the edge with token/command e
+ *
+ *  edge e cget -weight
+ *  - calls a method on the edge with handle e. This works for all edges, but is the only way to address
+ *    edges that were created without a command of their own
  */
 int GraphsInt_EdgeCmd(ClientData clientData, Tcl_Interp *interp, int objc, Tcl_Obj * const objv[])
 {
@@ -390,6 +574,16 @@ int GraphsInt_EdgeCmd(ClientData clientData, Tcl_Interp *interp, int objc, Tcl_O
         UndirIx
     };
 
+    if (objc >= 3 && Tcl_GetIndexFromObj(NULL, objv[1], EdgeSubCmommands, "method", TCL_EXACT, &cmdIdx) != TCL_OK) {
+        edgePtr = GraphsInt_EdgeGetFromObj(gState, objv[1]);
+        if (edgePtr != NULL) {
+            if (Tcl_GetIndexFromObj(interp, objv[2], EdgeSubCmommands, "method", 0, &cmdIdx) != TCL_OK) {
+                return TCL_ERROR;
+            }
+            return EdgeCmd(edgePtr, cmdIdx, interp, objc - 3, objv + 3);
+        }
+    }
+
     if (objc < 5) {
         Tcl_WrongNumArgs(interp, 1, objv, "[new | create <name> | get] <node> [-> | <->] <node> ?arg ...?");
         return TCL_ERROR;
@@ -418,18 +612,18 @@ int GraphsInt_EdgeCmd(ClientData clientData, Tcl_Interp *interp, int objc, Tcl_O
     */
     switch (directionIdx) {
     case OutIx: {
-        fromNodePtr = Graphs_NodeGetByCommand(gState, Tcl_GetString(objv[2 + pOffset]));
-        toNodePtr = Graphs_NodeGetByCommand(gState, Tcl_GetString(objv[4 + pOffset]));
+        fromNodePtr = Graphs_NodeGetFromObj(gState, objv[2 + pOffset]);
+        toNodePtr = Graphs_NodeGetFromObj(gState, objv[4 + pOffset]);
         break;
     }
     case InIx: {
-        fromNodePtr = Graphs_NodeGetByCommand(gState, Tcl_GetString(objv[4 + pOffset]));
-        toNodePtr = Graphs_NodeGetByCommand(gState, Tcl_GetString(objv[2 + pOffset]));
+        fromNodePtr = Graphs_NodeGetFromObj(gState, objv[4 + pOffset]);
+        toNodePtr = Graphs_NodeGetFromObj(gState, objv[2 + pOffset]);
         break;
     }
     case UndirIx: {
-        fromNodePtr = Graphs_NodeGetByCommand(gState, Tcl_GetString(objv[2 + pOffset]));
-        toNodePtr = Graphs_NodeGetByCommand(gState, Tcl_GetString(objv[4 + pOffset]));
+        fromNodePtr = Graphs_NodeGetFromObj(gState, objv[2 + pOffset]);
+        toNodePtr = Graphs_NodeGetFromObj(gState, objv[4 + pOffset]);
         unDirected = 1;
         break;
     }
@@ -472,7 +666,7 @@ int GraphsInt_EdgeCmd(ClientData clientData, Tcl_Interp *interp, int objc, Tcl_O
             Tcl_SetObjResult(interp, Tcl_NewStringObj("", -1));
             return TCL_OK;
         }
-        Tcl_SetObjResult(interp, Tcl_NewStringObj(edgePtr->cmdName, -1));
+        Tcl_SetObjResult(interp, GraphsInt_EdgeHandleObj(edgePtr));
         return TCL_OK;
     }
     case EdgeNewIx:
@@ -482,7 +676,7 @@ int GraphsInt_EdgeCmd(ClientData clientData, Tcl_Interp *interp, int objc, Tcl_O
         if (edgePtr == NULL) {
             return TCL_ERROR;
         }
-        Tcl_SetObjResult(interp, Tcl_NewStringObj(edgePtr->cmdName, -1));
+        Tcl_SetObjResult(interp, GraphsInt_EdgeHandleObj(edgePtr));
         return TCL_OK;
     default: {
         Tcl_Obj* errRes = Tcl_NewObj();
@@ -494,116 +688,147 @@ int GraphsInt_EdgeCmd(ClientData clientData, Tcl_Interp *interp, int objc, Tcl_O
 
 }
 
-static int CreateAndInsertNewDeltaEntry(Node* fromNodePtr, DeltaEntry** startRef, Node* nodePtr, Edge* edgePtr, Tcl_Interp* interp)
+static int CheckNewDeltaEntry(Node* fromNodePtr, DeltaT deltaType, Node* nodePtr, Tcl_Interp* interp)
 {
-    DeltaEntry* newEntry;
-
-    const DeltaEntry* entry = FindDeltaEntryByNode(*startRef, nodePtr);
-    if (entry != NULL) {
+    if (GraphsInt_DeltaFind(fromNodePtr, deltaType, nodePtr) != NULL) {
         Tcl_Obj* result = Tcl_NewObj();
         Tcl_AppendStringsToObj(result, nodePtr->cmdName, " is already neighbor of ", fromNodePtr->cmdName, NULL);
         Tcl_SetObjResult(interp, result);
-        Tcl_Free((char*)edgePtr);
         return TCL_ERROR;
     }
-
-    newEntry = (DeltaEntry*) ckalloc(sizeof(DeltaEntry));
-    newEntry->nodePtr = nodePtr;
-    newEntry->edgePtr = edgePtr;
-    newEntry->next = *startRef;
-    *startRef = newEntry;
     return TCL_OK;
 }
 
-static void EdgeAddToGraph(Graph* graphPtr, Edge* edgePtr)
+/*
+ * Frees an edge that failed to be created before it was linked to its nodes. Values that -attr options
+ * wrote already are reset in the graphs of both nodes.
+ */
+static void EdgeFreeUnlinked(Edge* edgePtr)
 {
-    int new;
-    Tcl_HashEntry* entry;
+    GraphState* gState = edgePtr->statePtr;
 
-    if (graphPtr != NULL) {
-        entry = Tcl_CreateHashEntry(&graphPtr->edges, (ClientData)edgePtr, &new);
-        if (new) {
-            Tcl_SetHashValue(entry, edgePtr);
-        }
+    if (edgePtr->fromNode != NULL && edgePtr->fromNode->graph != NULL) {
+        GraphsInt_AttrsReset(&edgePtr->fromNode->graph->edgeAttrs, edgePtr->id);
+    }
+    if (edgePtr->toNode != NULL && edgePtr->toNode->graph != NULL) {
+        GraphsInt_AttrsReset(&edgePtr->toNode->graph->edgeAttrs, edgePtr->id);
     }
+    Tcl_DecrRefCount(edgePtr->data);
+    GraphsInt_NameFree(&edgePtr->name);
+    GraphsInt_IdRelease(&gState->edgeIds, edgePtr->id);
+    GraphsInt_PoolFree(&gState->edgePool, edgePtr);
 }
 
-Edge*
-Graphs_EdgeCreateEdge(GraphState* gState, Node* fromNodePtr, Node* toNodePtr, int unDirected, Tcl_Interp* interp,
-    const char* cmdName, int objc, Tcl_Obj* const objv[])
+/*
+ * Creates an edge with an initial weight, which is in place before the edge is linked into the delta lists of
+ * its nodes, so that lists keeping a weight order take it in once.
+ */
+static Edge* EdgeCreate(GraphState* gState, Node* fromNodePtr, Node* toNodePtr, int unDirected, double weight,
+    Tcl_Interp* interp, const char* cmdName, int objc, Tcl_Obj* const objv[])
 {
     Tcl_HashEntry* entryPtr;
     int new;
     Edge* edgePtr;
+    /* whether the edge gets a command is decided by the graph of its from node */
+    int withCommand = (fromNodePtr->graph != NULL) ? fromNodePtr->graph->createCommands : gState->createCommands;
 
-    edgePtr = (Edge*)Tcl_Alloc(sizeof(Edge));
+    edgePtr = (Edge*)GraphsInt_PoolAlloc(&gState->edgePool);
     edgePtr->statePtr = gState;
+    edgePtr->id = GraphsInt_IdAlloc(&gState->edgeIds, edgePtr);
+    edgePtr->commandTkn = NULL;
+    edgePtr->handleObj = NULL;
+    edgePtr->fromNode = edgePtr->toNode = NULL;
+    edgePtr->name = NULL;
+    GraphsInt_NameFree(&edgePtr->name);
     edgePtr->data = Tcl_NewListObj(0, NULL);
+    Tcl_IncrRefCount(edgePtr->data);
 
-    if (Tcl_StringMatch(cmdName, "new")) {
-        sprintf(edgePtr->cmdName, "::graphs::Edge%d", gState->edgeUid);
-        gState->edgeUid++;
+    if (strcmp(cmdName, "new") == 0) {
+        do {
+            sprintf(edgePtr->cmdName, "::graphs::Edge%d", gState->edgeUid++);
+        } while (GraphsInt_EdgeGetByCommand(gState, edgePtr->cmdName) != NULL);
     }
     else {
         sprintf(edgePtr->cmdName, "%s", cmdName);
     }
 
-    if (GraphsInt_CheckCommandExists(interp, edgePtr->cmdName)) {
+    if (GraphsInt_EdgeGetByCommand(gState, edgePtr->cmdName) != NULL
+        || (withCommand && GraphsInt_CheckCommandExists(interp, edgePtr->cmdName))) {
         Tcl_Obj* result = Tcl_NewObj();
         Tcl_AppendStringsToObj(result, edgePtr->cmdName, " exists already", NULL);
         Tcl_SetObjResult(interp, result);
-        Tcl_Free((char*)edgePtr);
+        EdgeFreeUnlinked(edgePtr);
         return NULL;
     }
 
-    sprintf(edgePtr->name, "%s", "");
-    edgePtr->weight = 0.;
+    edgePtr->weight = weight;
     edgePtr->directionType = EDGE_DIRECTED;
     edgePtr->fromNode = fromNodePtr;
     edgePtr->toNode = toNodePtr;
     edgePtr->marks = 0;
+    GraphsInt_LabelSetInit(&edgePtr->labels);
 
     if (objc > 0 && EdgeCmdConfigure(edgePtr, interp, objc, objv) != TCL_OK) {
-        Tcl_Free((char*)edgePtr);
+        EdgeFreeUnlinked(edgePtr);
         return NULL;
     }
 
-    /* create neighbor and check if exists */
-    {
-        if (CreateAndInsertNewDeltaEntry(fromNodePtr, &fromNodePtr->outgoing, toNodePtr, edgePtr, interp)) {
-            return NULL;
-        }
+    /*
+     * Check both sides before linking anything, so that a failing undirected edge does not leave a
+     * dangling entry in the first list. Undirected edges are outgoing from both sides, and are flagged
+     * as EDGE_UNDIRECTED
+     */
+    if (CheckNewDeltaEntry(fromNodePtr, DELTA_PLUS, toNodePtr, interp) != TCL_OK
+        || CheckNewDeltaEntry(toNodePtr, unDirected ? DELTA_PLUS : DELTA_MINUS, fromNodePtr, interp) != TCL_OK) {
+        EdgeFreeUnlinked(edgePtr);
+        return NULL;
+    }
 
-        if (unDirected) {
-            /*
-             * undirected edges are outgoing from both sides, and are flagged as EDGE_UNDIRECTED
-             */
-            if (CreateAndInsertNewDeltaEntry(toNodePtr, &toNodePtr->outgoing, fromNodePtr, edgePtr, interp)) {
-                return NULL;
-            }
-            edgePtr->directionType = EDGE_UNDIRECTED;
-            fromNodePtr->degreeundir++;
-            toNodePtr->degreeundir++;
-        }
-        else {
-            if (CreateAndInsertNewDeltaEntry(toNodePtr, &toNodePtr->incoming, fromNodePtr, edgePtr, interp)) {
-                return NULL;
-            }
-            fromNodePtr->degreeplus++;
-            toNodePtr->degreeminus++;
+    GraphsInt_DeltaInsert(fromNodePtr, DELTA_PLUS, toNodePtr, edgePtr);
+    if (unDirected) {
+        if (toNodePtr != fromNodePtr) {
+            GraphsInt_DeltaInsert(toNodePtr, DELTA_PLUS, fromNodePtr, edgePtr);
         }
+        edgePtr->directionType = EDGE_UNDIRECTED;
+        fromNodePtr->degreeundir++;
+        toNodePtr->degreeundir++;
+    }
+    else {
+        GraphsInt_DeltaInsert(toNodePtr, DELTA_MINUS, fromNodePtr, edgePtr);
+        fromNodePtr->degreeplus++;
+        toNodePtr->degreeminus++;
     }
 
-    Tcl_InitHashTable(&edgePtr->labels, TCL_STRING_KEYS);
-    EdgeAddToGraph(fromNodePtr->graph, edgePtr);
-    EdgeAddToGraph(toNodePtr->graph, edgePtr);
+    GraphsInt_SnapshotInvalidate(fromNodePtr->graph);
+    GraphsInt_SnapshotInvalidate(toNodePtr->graph);
+    GraphsInt_EdgeRefreshGraph(edgePtr, fromNodePtr->graph);
+    GraphsInt_EdgeRefreshGraph(edgePtr, toNodePtr->graph);
 
-    edgePtr->commandTkn = Tcl_CreateObjCommand(interp, edgePtr->cmdName, EdgeSubCmd, edgePtr, EdgeDestroyCmd);
+    if (withCommand) {
+        edgePtr->commandTkn = Tcl_CreateObjCommand(interp, edgePtr->cmdName, EdgeSubCmd, edgePtr,
+            GraphsInt_EdgeDestroyCmd);
+    }
     entryPtr = Tcl_CreateHashEntry(&gState->edges, edgePtr->cmdName, &new);
     Tcl_SetHashValue(entryPtr, edgePtr);
     return edgePtr;
 }
 
+Edge*
+Graphs_EdgeCreateEdge(GraphState* gState, Node* fromNodePtr, Node* toNodePtr, int unDirected, Tcl_Interp* interp,
+    const char* cmdName, int objc, Tcl_Obj* const objv[])
+{
+    return EdgeCreate(gState, fromNodePtr, toNodePtr, unDirected, 0., interp, cmdName, objc, objv);
+}
+
+/*
+ * Creates an edge with a generated command name and a weight, for readers that know the weight up front
+ */
+Edge* GraphsInt_EdgeCreateWeighted(GraphState* gState, Node* fromNodePtr, Node* toNodePtr, int unDirected,
+    double weight, Tcl_Interp* interp)
+{
+    return EdgeCreate(gState, fromNodePtr, toNodePtr, unDirected, weight, interp, "new", 0, NULL);
+}
+
 
 int Graphs_EdgeHasMarks(const Edge* edgePtr, unsigned marksMask)
 {
@@ -625,14 +850,14 @@ int Graphs_EdgeHasMarks(const Edge* edgePtr, unsigned marksMask)
 Edge*
 Graphs_EdgeGetEdge(const GraphState* gState, CONST Node* fromNodePtr, CONST Node* toNodePtr, int unDirected, unsigned int marksMask)
 {
-    const DeltaEntry* entry = FindDeltaEntryByNode((CONST DeltaEntry*)fromNodePtr->outgoing, toNodePtr);
+    const DeltaEntry* entry = GraphsInt_DeltaFind((Node*)fromNodePtr, DELTA_PLUS, toNodePtr);
     if (entry == NULL) {
         return NULL;
     }
     Edge* edgePtr1 = entry->edgePtr;
 
     if (unDirected) {
-        entry = FindDeltaEntryByNode((CONST DeltaEntry*)toNodePtr->outgoing, fromNodePtr);
+        entry = GraphsInt_DeltaFind((Node*)toNodePtr, DELTA_PLUS, fromNodePtr);
         if (entry == NULL) {
             return NULL;
         }
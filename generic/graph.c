@@ -17,6 +17,17 @@ static const char* GraphSubCommands[] = {
         "subgraphs",
         "info",
         "mark",
+        "freeze",
+        "load",
+        "attrs",
+        "edges",
+        "write",
+        "read",
+        "shortestpath",
+        "negativecycle",
+        "allpaths",
+        "apsp",
+        "bfs",
         NULL
 };
 enum GraphSubCommandIndex
@@ -29,7 +40,18 @@ enum GraphSubCommandIndex
     GraphNodesIx,
     GraphSubgraphsIx,
     GraphInfoIx,
-    GraphMarkIx
+    GraphMarkIx,
+    GraphFreezeIx,
+    GraphLoadIx,
+    GraphAttrsIx,
+    GraphEdgesIx,
+    GraphWriteIx,
+    GraphReadIx,
+    GraphShortestPathIx,
+    GraphNegativeCycleIx,
+    GraphAllPathsIx,
+    GraphApspIx,
+    GraphBfsIx
 };
 
 static const char* GraphInfoOptions[] = {
@@ -42,6 +64,7 @@ static const char* GraphInfoOptions[] = {
         "delta",
         "subgraphs",
         "order",
+        "frozen",
         NULL
 };
 
@@ -55,7 +78,8 @@ enum GraphInfoOptionIndex
     GraphInfoDeltaMinus2Ix,
     GraphInfoDeltaIx,
     GraphInfoSubgraphsIx,
-    GraphInfoOrderIx
+    GraphInfoOrderIx,
+    GraphInfoFrozenIx
 };
 
 static const char* GraphMarks[] = { "hidden", NULL };
@@ -70,6 +94,8 @@ static const char* LabelFilterOptions[] = { "-name", "-labels", "-notlabels", "-
 static int GraphNodesGetNodes(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[])
 {
     int optIdx = LABELS_ALL_IDX;
+    Tcl_HashTable* candidates;
+
     if (objc > 0) {
         if (Tcl_GetIndexFromObj(interp, objv[0], LabelFilterOptions, "option", 0, &optIdx) != TCL_OK) {
             return TCL_ERROR;
@@ -82,26 +108,48 @@ static int GraphNodesGetNodes(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl
     lblFilt.filterType = optIdx;
     lblFilt.objc = objc - 1;
     lblFilt.objv = objv + 1;
-    return GraphsInt_GetNodes(graphPtr->nodes, lblFilt, interp);
+    GraphsInt_LabelFilterInit(graphPtr->statePtr, &lblFilt);
+    if (lblFilt.filterType == LABELS_IDX) {
+        /* only the nodes carrying the rarest of the labels need to be checked */
+        candidates = GraphsInt_LabelIndexCandidates(&graphPtr->nodesByLabel, &lblFilt);
+    }
+    else if (lblFilt.filterType == LABELS_NAME_IDX && !GraphsInt_IsGlobPattern(Tcl_GetString(lblFilt.objv[0]))) {
+        /* an exact name, only a glob pattern needs a scan */
+        candidates = GraphsInt_IndexGet(&graphPtr->nodesByName, Tcl_GetString(lblFilt.objv[0]));
+    }
+    else {
+        candidates = &graphPtr->nodes;
+    }
+
+    if (candidates == NULL) {
+        Tcl_SetObjResult(interp, Tcl_NewObj());
+    }
+    else {
+        GraphsInt_GetNodes(candidates, &lblFilt, interp);
+    }
+    GraphsInt_LabelFilterFree(&lblFilt);
+    return TCL_OK;
 }
 
 static int GraphNodesAddNodes(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[])
 {
+    Node** nodes;
+
     /* Validation first. No node is added unless all nodes are valid */
     for (int j = 0; j < objc; j++) {
-        const char* nName = Tcl_GetString(objv[j]);
-        if (Graphs_NodeGetByCommand(graphPtr->statePtr, nName) == NULL) {
+        if (Graphs_NodeGetFromObj(graphPtr->statePtr, objv[j]) == NULL) {
             Tcl_Obj* res = Tcl_NewStringObj("No such node: ", -1);
             Tcl_AppendObjToObj(res, objv[j]);
             Tcl_SetObjResult(interp, res);
             return TCL_ERROR;
         }
     }
+    nodes = (Node**)ckalloc(objc * sizeof(Node*) + 1);
     for (int j = 0; j < objc; j++) {
-        const char* nName = Tcl_GetString(objv[j]);
-        Node* nodePtr = Graphs_NodeGetByCommand(graphPtr->statePtr, nName);
-        Graphs_NodeAddToGraph(graphPtr, nodePtr);
+        nodes[j] = Graphs_NodeGetFromObj(graphPtr->statePtr, objv[j]);
     }
+    GraphsInt_NodesAddToGraph(graphPtr, nodes, objc);
+    ckfree((char*)nodes);
 
     return TCL_OK;
 }
@@ -110,8 +158,7 @@ static int GraphNodesDeleteNodes(Graph* graphPtr, Tcl_Interp* interp, int objc,
 {
     /* Validation first. No node is added unless all nodes are valid */
     for (int j = 0; j < objc; j++) {
-        const char* nName = Tcl_GetString(objv[j]);
-        if (Graphs_NodeGetByCommand(graphPtr->statePtr, nName) == NULL) {
+        if (Graphs_NodeGetFromObj(graphPtr->statePtr, objv[j]) == NULL) {
             Tcl_Obj* res = Tcl_NewStringObj("No such node: ", -1);
             Tcl_AppendObjToObj(res, objv[j]);
             Tcl_SetObjResult(interp, res);
@@ -119,17 +166,45 @@ static int GraphNodesDeleteNodes(Graph* graphPtr, Tcl_Interp* interp, int objc,
         }
     }
     for (int j = 0; j < objc; j++) {
-        const char* nName = Tcl_GetString(objv[j]);
-        Node* nodePtr = Graphs_NodeGetByCommand(graphPtr->statePtr, nName);
+        Node* nodePtr = Graphs_NodeGetFromObj(graphPtr->statePtr, objv[j]);
         Graphs_NodeDeleteFromGraph(graphPtr, nodePtr);
     }
     return TCL_OK;
 }
 
+/*
+ * Returns a member node with the given -name, looked up through the name index of the graph, or creates one
+ */
+Node* GraphsInt_GraphGetOrCreateNode(Graph* graphPtr, const char* name, Tcl_Interp* interp)
+{
+    Tcl_HashTable* nodesPtr = GraphsInt_IndexGet(&graphPtr->nodesByName, name);
+    if (nodesPtr != NULL) {
+        Tcl_HashSearch search;
+        return (Node*)Tcl_GetHashValue(Tcl_FirstHashEntry(nodesPtr, &search));
+    }
+    return GraphsInt_NodeCreateNode(graphPtr->statePtr, graphPtr, name, interp);
+}
+
+static int GraphNodesGetOrCreate(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[])
+{
+    Node* nodePtr;
+
+    if (objc != 1) {
+        Tcl_WrongNumArgs(interp, 0, objv, "get-or-create <name>");
+        return TCL_ERROR;
+    }
+
+    if ((nodePtr = GraphsInt_GraphGetOrCreateNode(graphPtr, Tcl_GetString(objv[0]), interp)) == NULL) {
+        return TCL_ERROR;
+    }
+    Tcl_SetObjResult(interp, GraphsInt_NodeHandleObj(nodePtr));
+    return TCL_OK;
+}
+
 static int GraphCmdNodes(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[])
 {
     int cmdIdx;
-    const char* subCmds[] = { "add", "+", "delete", "-", "get",
+    const char* subCmds[] = { "add", "+", "delete", "-", "get", "get-or-create",
     NULL };
     enum subCmdIdx
     {
@@ -137,7 +212,8 @@ static int GraphCmdNodes(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj*
         GraphAddNodes2Ix,
         GraphDeleteNodes1Ix,
         GraphDeleteNodes2Ix,
-        GraphGetNodesIx
+        GraphGetNodesIx,
+        GraphGetOrCreateIx
     };
 
     if (objc < 1) {
@@ -157,6 +233,9 @@ static int GraphCmdNodes(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj*
     case GraphDeleteNodes2Ix: {
         return GraphNodesDeleteNodes(graphPtr, interp, objc - 1, objv + 1);
     }
+    case GraphGetOrCreateIx: {
+        return GraphNodesGetOrCreate(graphPtr, interp, objc - 1, objv + 1);
+    }
     case GraphGetNodesIx:
     default: {
         break;
@@ -170,14 +249,15 @@ static int GraphCmdNodes(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj*
 static int GraphCmdConfigure(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[])
 {
     int i, optIdx;
-    const char* opts[] = { "-name", "-data", NULL};
+    const char* opts[] = { "-name", "-data", "-commands", NULL};
     enum OptsIx
     {
         NameIx,
-        DataIx
+        DataIx,
+        CommandsIx
     };
 
-    if (objc < 2 || objc > 4) {
+    if (objc < 2 || objc > 6 || (objc % 2) != 0) {
         Tcl_WrongNumArgs(interp, 1, objv, "option ?arg ...?");
         return TCL_ERROR;
     }
@@ -197,6 +277,12 @@ static int GraphCmdConfigure(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_
             Tcl_IncrRefCount(graphPtr->data);
             break;
         }
+        case CommandsIx: {
+            if (Tcl_GetBooleanFromObj(interp, objv[i + 1], &graphPtr->createCommands) != TCL_OK) {
+                return TCL_ERROR;
+            }
+            break;
+        }
         default: {
             Tcl_SetObjResult(interp, Tcl_NewStringObj("Wrong options in graph configure", -1));
             return TCL_ERROR;
@@ -210,11 +296,12 @@ static int GraphCmdConfigure(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_
 static int GraphCmdCget(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[])
 {
     int optIdx;
-    const char* opts[] = { "-name", "-data", NULL};
+    const char* opts[] = { "-name", "-data", "-commands", NULL};
     enum OptsIx
     {
         NameIx,
-        DataIx
+        DataIx,
+        CommandsIx
     };
 
     if (objc != 1) {
@@ -234,6 +321,10 @@ static int GraphCmdCget(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj*
         Tcl_SetObjResult(interp, graphPtr->data);
         return TCL_OK;
     }
+    case CommandsIx: {
+        Tcl_SetObjResult(interp, Tcl_NewBooleanObj(graphPtr->createCommands));
+        return TCL_OK;
+    }
     default: {
         break;
     }
@@ -241,6 +332,98 @@ static int GraphCmdCget(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj*
     return TCL_ERROR;
 }
 
+/*
+ * Collects the edges incident to nodePtr from one of its delta lists that GraphDestroyNodes() has to delete.
+ * Every edge is collected exactly once over all nodes of the graph: edges starting inside the graph from
+ * the outgoing list of their from node, edges coming from outside from the list of their to node.
+ */
+static void GraphCollectEdges(Graph* graphPtr, Node* nodePtr, DeltaEntry* entry, int outgoing, Edge*** edgesRef,
+    int* countPtr, int* sizePtr)
+{
+    for (; entry != NULL; entry = entry->next) {
+        Edge* edgePtr = entry->edgePtr;
+
+        if ((outgoing && edgePtr->fromNode == nodePtr) || edgePtr->fromNode->graph != graphPtr) {
+            if (*countPtr == *sizePtr) {
+                *sizePtr = (*sizePtr == 0) ? 64 : 2 * *sizePtr;
+                *edgesRef = (Edge**)ckrealloc((char*)*edgesRef, *sizePtr * sizeof(Edge*));
+            }
+            (*edgesRef)[(*countPtr)++] = edgePtr;
+        }
+    }
+}
+
+/*
+ * Deletes all nodes of a graph together with their edges. Deleting the nodes one by one would unlink
+ * every edge from the delta lists of both of its nodes, although both lists are about to be freed anyway.
+ * Here only edges to nodes outside the graph are unlinked. Edges between two nodes of the graph are
+ * detached from their nodes before they are deleted, the delta lists are then freed as a whole, and the
+ * node and edge tables and indexes of the graph are dropped at once instead of entry by entry.
+ */
+static void GraphDestroyNodes(Graph* graphPtr, Tcl_Interp* interp)
+{
+    Tcl_HashSearch search;
+    Tcl_HashEntry* entry;
+    Node** nodes = (Node**)ckalloc(graphPtr->nodes.numEntries * sizeof(Node*) + 1);
+    Edge** edges = NULL;
+    int nodeCount = 0, edgeCount = 0, edgesSize = 0;
+
+    GraphsInt_SnapshotInvalidate(graphPtr);
+    for (entry = Tcl_FirstHashEntry(&graphPtr->nodes, &search); entry != NULL; entry = Tcl_NextHashEntry(&search)) {
+        Node* nodePtr = (Node*)Tcl_GetHashValue(entry);
+        nodes[nodeCount++] = nodePtr;
+        GraphCollectEdges(graphPtr, nodePtr, nodePtr->outgoing, 1, &edges, &edgeCount, &edgesSize);
+        GraphCollectEdges(graphPtr, nodePtr, nodePtr->incoming, 0, &edges, &edgeCount, &edgesSize);
+    }
+
+    for (int i = 0; i < edgeCount; i++) {
+        Edge* edgePtr = edges[i];
+        if (edgePtr->fromNode->graph == graphPtr && edgePtr->toNode->graph == graphPtr) {
+            /* without nodes, the edge delete callback leaves the delta lists alone */
+            edgePtr->fromNode = edgePtr->toNode = NULL;
+        }
+        Graphs_EdgeDeleteEdge(edgePtr, interp);
+    }
+
+    for (int i = 0; i < nodeCount; i++) {
+        Node* nodePtr = nodes[i];
+        /* the remaining entries point to deleted edges */
+        GraphsInt_DeltaFree(nodePtr, DELTA_PLUS);
+        GraphsInt_DeltaFree(nodePtr, DELTA_MINUS);
+        nodePtr->degreeplus = nodePtr->degreeminus = nodePtr->degreeundir = 0;
+        nodePtr->graph = NULL;
+        Graphs_NodeDeleteNode(nodePtr, interp);
+    }
+
+    Tcl_DeleteHashTable(&graphPtr->nodes);
+    Tcl_DeleteHashTable(&graphPtr->edges);
+    GraphsInt_IndexFree(&graphPtr->nodesByLabel);
+    GraphsInt_IndexFree(&graphPtr->edgesByLabel);
+    GraphsInt_IndexFree(&graphPtr->nodesByName);
+    GraphsInt_IndexFree(&graphPtr->edgesByName);
+    Tcl_DeleteHashTable(&graphPtr->cut);
+    Tcl_InitHashTable(&graphPtr->nodes, TCL_STRING_KEYS);
+    Tcl_InitHashTable(&graphPtr->edges, TCL_ONE_WORD_KEYS);
+    GraphsInt_IndexInit(&graphPtr->nodesByLabel, TCL_ONE_WORD_KEYS);
+    GraphsInt_IndexInit(&graphPtr->edgesByLabel, TCL_ONE_WORD_KEYS);
+    GraphsInt_IndexInit(&graphPtr->nodesByName, TCL_STRING_KEYS);
+    GraphsInt_IndexInit(&graphPtr->edgesByName, TCL_STRING_KEYS);
+    Tcl_InitHashTable(&graphPtr->cut, TCL_ONE_WORD_KEYS);
+    GraphsInt_AttrsClear(&graphPtr->nodeAttrs);
+    GraphsInt_AttrsClear(&graphPtr->edgeAttrs);
+    graphPtr->order = 0;
+
+    if (edges != NULL) {
+        ckfree((char*)edges);
+    }
+    ckfree((char*)nodes);
+
+    /* give the memory of the deleted entities back */
+    GraphsInt_PoolTrim(&graphPtr->statePtr->nodePool);
+    GraphsInt_PoolTrim(&graphPtr->statePtr->edgePool);
+    GraphsInt_PoolTrim(&graphPtr->statePtr->deltaPool);
+}
+
 static int GraphCmdDestroy(Graph* graphPtr, Tcl_Interp *interp, int objc, Tcl_Obj * const objv[])
 {
     int optIdx;
@@ -260,14 +443,7 @@ static int GraphCmdDestroy(Graph* graphPtr, Tcl_Interp *interp, int objc, Tcl_Ob
         if (Tcl_GetIndexFromObj(interp, objv[0], opts, "option", 1, &optIdx) != TCL_OK) {
             return TCL_ERROR;
         }
-        Tcl_HashEntry* entry;
-        Tcl_HashSearch search;
-        entry = Tcl_FirstHashEntry(&graphPtr->nodes, &search);
-        while (entry != NULL) {
-            Node* nodePtr = Tcl_GetHashValue(entry);
-            Graphs_NodeDeleteNode(nodePtr, interp);
-            entry = Tcl_FirstHashEntry(&graphPtr->nodes, &search);
-        }
+        GraphDestroyNodes(graphPtr, interp);
     }
 
     Tcl_DeleteCommandFromToken(interp, graphPtr->commandTkn);
@@ -293,6 +469,72 @@ static int GraphParseMarks(const char* marksSpec, unsigned* marksMaskOut)
     return TCL_OK;
 }
 
+/*
+ * Fields of the rows returned by [$graph info edges -format <fields>]
+ */
+static const char* GraphEdgeFields[] = {
+    "edge", "from", "to", "fromname", "toname", "weight", "name", "data", "labels", "marks", "directed", NULL
+};
+enum GraphEdgeFieldIndex
+{
+    EdgeFieldEdgeIx,
+    EdgeFieldFromIx,
+    EdgeFieldToIx,
+    EdgeFieldFromNameIx,
+    EdgeFieldToNameIx,
+    EdgeFieldWeightIx,
+    EdgeFieldNameIx,
+    EdgeFieldDataIx,
+    EdgeFieldLabelsIx,
+    EdgeFieldMarksIx,
+    EdgeFieldDirectedIx
+};
+
+/* Appends the fields of one edge to a flat, row oriented list */
+static void GraphAppendEdgeRow(Edge* edgePtr, const int fields[], int fieldCount, Tcl_Obj* listObj)
+{
+    for (int i = 0; i < fieldCount; i++) {
+        Tcl_Obj* valueObj;
+
+        switch (fields[i]) {
+        case EdgeFieldEdgeIx:
+            valueObj = GraphsInt_EdgeHandleObj(edgePtr);
+            break;
+        case EdgeFieldFromIx:
+            valueObj = GraphsInt_NodeHandleObj(edgePtr->fromNode);
+            break;
+        case EdgeFieldToIx:
+            valueObj = GraphsInt_NodeHandleObj(edgePtr->toNode);
+            break;
+        case EdgeFieldFromNameIx:
+            valueObj = Tcl_NewStringObj(edgePtr->fromNode->name, -1);
+            break;
+        case EdgeFieldToNameIx:
+            valueObj = Tcl_NewStringObj(edgePtr->toNode->name, -1);
+            break;
+        case EdgeFieldWeightIx:
+            valueObj = Tcl_NewDoubleObj(edgePtr->weight);
+            break;
+        case EdgeFieldNameIx:
+            valueObj = Tcl_NewStringObj(edgePtr->name, -1);
+            break;
+        case EdgeFieldDataIx:
+            valueObj = edgePtr->data;
+            break;
+        case EdgeFieldLabelsIx:
+            valueObj = GraphsInt_LabelSetToList(edgePtr->statePtr, &edgePtr->labels);
+            break;
+        case EdgeFieldMarksIx:
+            valueObj = Tcl_NewStringObj((edgePtr->marks & GRAPHS_MARK_HIDDEN) ? "hidden" : "", -1);
+            break;
+        default:
+            valueObj = Tcl_NewBooleanObj(edgePtr->directionType == EDGE_DIRECTED);
+            break;
+        }
+        Tcl_ListObjAppendElement(NULL, listObj, valueObj);
+    }
+}
+
 static int GraphInfoEdges(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[])
 {
     const char* infoEdgesOptions[] = {
@@ -300,6 +542,7 @@ static int GraphInfoEdges(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj
         "-name",
         "-labels",
         "-notlabels",
+        "-format",
         NULL
     };
     enum infoEdgesOptionIndex
@@ -307,21 +550,26 @@ static int GraphInfoEdges(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj
         GraphInfoEdgesOptionMarksIx,
         GraphInfoEdgesOptionNameIx,
         GraphInfoEdgesOptionLabelsIx,
-        GraphInfoEdgesOptionNotLabelsIx
+        GraphInfoEdgesOptionNotLabelsIx,
+        GraphInfoEdgesOptionFormatIx
     };
 
     unsigned edgeMarksMask = 0;
     char* edgeName = NULL;
     Tcl_HashSearch search;
     Tcl_HashEntry* entry = NULL;
+    Tcl_HashTable* edgesTbl;
     Tcl_Obj* result = Tcl_NewObj();
     Tcl_Obj** labelsObjv = NULL;
     int labelObjc = 0;
+    int* fields = NULL;
+    int fieldCount = 0;
     int cmdIdx;
     int returnCode = TCL_OK;
 
     struct LabelFilter lblFilt;
     lblFilt.filterType = LABELS_ALL_IDX;
+    GraphsInt_LabelSetInit(&lblFilt.mask);
 
     while (objc > 0) {
         if (Tcl_GetIndexFromObj(interp, objv[0], infoEdgesOptions, "option", 0, &cmdIdx) != TCL_OK) {
@@ -393,21 +641,57 @@ static int GraphInfoEdges(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj
             objv += labelObjc;
             break;
         }
+        case GraphInfoEdgesOptionFormatIx: {
+            Tcl_Obj** fieldObjv;
+
+            objc--;
+            objv++;
+            if (objc < 1) {
+                Tcl_WrongNumArgs(interp, objc, objv, "-format <fields>");
+                returnCode = TCL_ERROR;
+                goto cleanUp;
+            }
+            if (Tcl_ListObjGetElements(interp, objv[0], &fieldCount, &fieldObjv) != TCL_OK) {
+                returnCode = TCL_ERROR;
+                goto cleanUp;
+            }
+            fields = (int*)ckalloc(fieldCount * sizeof(int) + 1);
+            for (int i = 0; i < fieldCount; i++) {
+                if (Tcl_GetIndexFromObj(interp, fieldObjv[i], GraphEdgeFields, "field", 0, &fields[i]) != TCL_OK) {
+                    returnCode = TCL_ERROR;
+                    goto cleanUp;
+                }
+            }
+            objc--;
+            objv++;
+            break;
+        }
         default:
             break;
         }
     }
 
-    /* collect edges */
-    entry = Tcl_FirstHashEntry(&graphPtr->edges, &search);
+    /* collect edges, for -name only those with the name, for -labels those carrying the rarest label */
+    GraphsInt_LabelFilterInit(graphPtr->statePtr, &lblFilt);
+    edgesTbl = &graphPtr->edges;
+    if (edgeName != NULL) {
+        edgesTbl = GraphsInt_IndexGet(&graphPtr->edgesByName, edgeName);
+    }
+    else if (lblFilt.filterType == LABELS_IDX) {
+        edgesTbl = GraphsInt_LabelIndexCandidates(&graphPtr->edgesByLabel, &lblFilt);
+    }
+    entry = (edgesTbl == NULL) ? NULL : Tcl_FirstHashEntry(edgesTbl, &search);
     while (entry != NULL) {
-        Edge* edgePtr = (Edge*)Tcl_GetHashKey(&graphPtr->edges, entry);
+        Edge* edgePtr = (Edge*)Tcl_GetHashKey(edgesTbl, entry);
         if (Graphs_EdgeHasMarks(edgePtr, edgeMarksMask)) {
             if (edgeName == NULL || strcmp(edgePtr->name, edgeName) == 0) {
                 int matches = 0;
-                GraphsInt_MatchesLabels(&edgePtr->labels, edgePtr->name, lblFilt, &matches);
-                if (matches) {
-                    Tcl_ListObjAppendElement(interp, result, Tcl_NewStringObj(edgePtr->cmdName, -1));
+                GraphsInt_MatchesLabels(&edgePtr->labels, edgePtr->name, &lblFilt, &matches);
+                if (matches && fields == NULL) {
+                    Tcl_ListObjAppendElement(interp, result, GraphsInt_EdgeHandleObj(edgePtr));
+                }
+                else if (matches) {
+                    GraphAppendEdgeRow(edgePtr, fields, fieldCount, result);
                 }
             }
         }
@@ -417,9 +701,16 @@ static int GraphInfoEdges(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj
     Tcl_SetObjResult(interp, result);
 
 cleanUp:
+    GraphsInt_LabelFilterFree(&lblFilt);
     if (labelsObjv != NULL) {
         ckfree((ClientData)labelsObjv);
     }
+    if (fields != NULL) {
+        ckfree((char*)fields);
+    }
+    if (returnCode != TCL_OK) {
+        Tcl_DecrRefCount(result);
+    }
     return returnCode;
 }
 
@@ -436,15 +727,37 @@ static int GraphInfoDelta(Graph* graphPtr, DeltaT deltaType, Tcl_Interp* interp,
     lblFilt.filterType = optIdx;
     lblFilt.objc = objc - 1;
     lblFilt.objv = (Tcl_Obj**) objv + 1;
+    GraphsInt_LabelFilterInit(graphPtr->statePtr, &lblFilt);
 
+    /*
+     * Only the cut has edges to nodes outside of the graph. delta+ and delta- are the outer nodes of the
+     * directed edges leaving resp. entering the graph, delta those of the undirected edges
+     */
     Tcl_HashSearch search;
-    Tcl_HashEntry* entry = Tcl_FirstHashEntry(&graphPtr->nodes, &search);
+    Tcl_HashEntry* entry = Tcl_FirstHashEntry(&graphPtr->cut, &search);
     Tcl_Obj * resultObj = Tcl_NewObj();
     while (entry != NULL) {
-        Node* nodePtr = Tcl_GetHashValue(entry);
-        GraphsInt_GetDelta(nodePtr, graphPtr, deltaType, lblFilt, interp, &resultObj);
+        Edge* edgePtr = Tcl_GetHashValue(entry);
+        int fromInside = (edgePtr->fromNode->graph == graphPtr);
+        Node* outerPtr = fromInside ? edgePtr->toNode : edgePtr->fromNode;
+        int wanted;
+        int matches = 0;
+
+        if (edgePtr->directionType == EDGE_UNDIRECTED) {
+            wanted = (deltaType == DELTA_ALL);
+        }
+        else {
+            wanted = (deltaType == (fromInside ? DELTA_PLUS : DELTA_MINUS));
+        }
+        if (wanted) {
+            GraphsInt_MatchesLabels(&outerPtr->labels, outerPtr->name, &lblFilt, &matches);
+            if (matches) {
+                Tcl_ListObjAppendElement(interp, resultObj, GraphsInt_NodeHandleObj(outerPtr));
+            }
+        }
         entry = Tcl_NextHashEntry(&search);
     }
+    GraphsInt_LabelFilterFree(&lblFilt);
 
     Tcl_SetObjResult(interp, resultObj);
     return TCL_OK;
@@ -485,6 +798,10 @@ static int GraphCmdInfo(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj*
         Tcl_SetObjResult(interp, Tcl_NewIntObj(graphPtr->order));
         return TCL_OK;
     }
+    case GraphInfoFrozenIx: {
+        Tcl_SetObjResult(interp, Tcl_NewBooleanObj(graphPtr->snapshot != NULL));
+        return TCL_OK;
+    }
     }
 
     return TCL_OK;
@@ -529,6 +846,73 @@ static int GraphCmdMark(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj*
     return TCL_OK;
 }
 
+/* Appends a key and an int array as list to a dict list */
+static void GraphFreezeIntArray(Tcl_Obj* dictObj, const char* key, const int* values, int count)
+{
+    Tcl_Obj* listObj = Tcl_NewListObj(0, NULL);
+
+    for (int i = 0; i < count; i++) {
+        Tcl_ListObjAppendElement(NULL, listObj, Tcl_NewIntObj(values[i]));
+    }
+    Tcl_ListObjAppendElement(NULL, dictObj, Tcl_NewStringObj(key, -1));
+    Tcl_ListObjAppendElement(NULL, dictObj, listObj);
+}
+
+static void GraphFreezeDoubleArray(Tcl_Obj* dictObj, const char* key, const double* values, int count)
+{
+    Tcl_Obj* listObj = Tcl_NewListObj(0, NULL);
+
+    for (int i = 0; i < count; i++) {
+        Tcl_ListObjAppendElement(NULL, listObj, Tcl_NewDoubleObj(values[i]));
+    }
+    Tcl_ListObjAppendElement(NULL, dictObj, Tcl_NewStringObj(key, -1));
+    Tcl_ListObjAppendElement(NULL, dictObj, listObj);
+}
+
+/*
+ * Builds the CSR snapshot of the graph (if there is no valid one yet) and returns the nodes in the order of
+ * their dense ids in the snapshot. With -arrays the result is a dict of the nodes and the offset, target or
+ * source and weight arrays of the outgoing and incoming rows.
+ */
+static int GraphCmdFreeze(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[])
+{
+    static const char* options[] = { "-arrays", NULL };
+    GraphSnapshot* snapPtr;
+    Tcl_Obj* nodesObj;
+    Tcl_Obj* result;
+    int optIdx;
+
+    if (objc > 1) {
+        Tcl_WrongNumArgs(interp, 0, objv, "?-arrays?");
+        return TCL_ERROR;
+    }
+    if (objc == 1 && Tcl_GetIndexFromObj(interp, objv[0], options, "option", 0, &optIdx) != TCL_OK) {
+        return TCL_ERROR;
+    }
+
+    snapPtr = Graphs_GraphGetSnapshot(graphPtr);
+    nodesObj = Tcl_NewListObj(0, NULL);
+    for (int i = 0; i < snapPtr->nodeCount; i++) {
+        Tcl_ListObjAppendElement(interp, nodesObj, GraphsInt_NodeHandleObj(snapPtr->nodes[i]));
+    }
+    if (objc == 0) {
+        Tcl_SetObjResult(interp, nodesObj);
+        return TCL_OK;
+    }
+
+    result = Tcl_NewListObj(0, NULL);
+    Tcl_ListObjAppendElement(interp, result, Tcl_NewStringObj("nodes", -1));
+    Tcl_ListObjAppendElement(interp, result, nodesObj);
+    GraphFreezeIntArray(result, "outOffsets", snapPtr->outOffsets, snapPtr->nodeCount + 1);
+    GraphFreezeIntArray(result, "outTargets", snapPtr->outTargets, snapPtr->edgeCount);
+    GraphFreezeDoubleArray(result, "outWeights", snapPtr->outWeights, snapPtr->edgeCount);
+    GraphFreezeIntArray(result, "inOffsets", snapPtr->inOffsets, snapPtr->nodeCount + 1);
+    GraphFreezeIntArray(result, "inSources", snapPtr->inSources, snapPtr->edgeCount);
+    GraphFreezeDoubleArray(result, "inWeights", snapPtr->inWeights, snapPtr->edgeCount);
+    Tcl_SetObjResult(interp, result);
+    return TCL_OK;
+}
+
 static int GraphSubCmd(Graph* graphPtr, Tcl_Obj* cmd, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[])
 {
     int cmdIdx;
@@ -555,6 +939,28 @@ static int GraphSubCmd(Graph* graphPtr, Tcl_Obj* cmd, Tcl_Interp* interp, int ob
         return GraphCmdInfo(graphPtr, interp, objc, objv);
     case GraphMarkIx:
         return GraphCmdMark(graphPtr, interp, objc, objv);
+    case GraphFreezeIx:
+        return GraphCmdFreeze(graphPtr, interp, objc, objv);
+    case GraphLoadIx:
+        return GraphsInt_GraphCmdLoad(graphPtr, interp, objc, objv);
+    case GraphAttrsIx:
+        return GraphsInt_GraphCmdAttrs(graphPtr, interp, objc, objv);
+    case GraphEdgesIx:
+        return GraphsInt_GraphCmdEdges(graphPtr, interp, objc, objv);
+    case GraphWriteIx:
+        return GraphsInt_GraphCmdWrite(graphPtr, interp, objc, objv);
+    case GraphReadIx:
+        return GraphsInt_GraphCmdRead(graphPtr, interp, objc, objv);
+    case GraphShortestPathIx:
+        return GraphsInt_GraphCmdShortestPath(graphPtr, interp, objc, objv);
+    case GraphNegativeCycleIx:
+        return GraphsInt_GraphCmdNegativeCycle(graphPtr, interp, objc, objv);
+    case GraphAllPathsIx:
+        return GraphsInt_GraphCmdAllPaths(graphPtr, interp, objc, objv);
+    case GraphApspIx:
+        return GraphsInt_GraphCmdApsp(graphPtr, interp, objc, objv);
+    case GraphBfsIx:
+        return GraphsInt_GraphCmdBfs(graphPtr, interp, objc, objv);
     default:
         break;
     }
@@ -590,9 +996,19 @@ static void GraphDestroyCmd(ClientData clientData)
     /* Delete the graph from global state */
     entry1 = Tcl_FindHashEntry(&g->statePtr->graphs, g->cmdName);
     Tcl_DeleteHashEntry(entry1);
+    GraphsInt_StateNewEpoch(g->statePtr);
 
     /* free the nodes and edges */
+    GraphsInt_SnapshotInvalidate(g);
     Tcl_DeleteHashTable(&g->nodes);
+    Tcl_DeleteHashTable(&g->edges);
+    GraphsInt_IndexFree(&g->nodesByLabel);
+    GraphsInt_IndexFree(&g->edgesByLabel);
+    GraphsInt_IndexFree(&g->nodesByName);
+    GraphsInt_IndexFree(&g->edgesByName);
+    Tcl_DeleteHashTable(&g->cut);
+    GraphsInt_AttrsFree(g);
+    GraphsInt_HandleObjFree(&g->handleObj);
     Tcl_Free((char*) g);
 }
 
@@ -623,6 +1039,9 @@ int GraphsInt_GraphCmd(ClientData clientData, Tcl_Interp *interp, int objc, Tcl_
         sprintf(graphPtr->name, "%s", "");
         graphPtr->order = 0;
         graphPtr->marks = 0;
+        graphPtr->snapshot = NULL;
+        graphPtr->handleObj = NULL;
+        graphPtr->createCommands = gState->createCommands;
         graphPtr->data = Tcl_NewListObj(0, NULL);
 
         if (Tcl_StringMatch(Tcl_GetString(objv[1]), "new")) {
@@ -646,6 +1065,12 @@ int GraphsInt_GraphCmd(ClientData clientData, Tcl_Interp *interp, int objc, Tcl_
 
         Tcl_InitHashTable(&graphPtr->nodes, TCL_STRING_KEYS);
         Tcl_InitHashTable(&graphPtr->edges, TCL_ONE_WORD_KEYS);
+        GraphsInt_IndexInit(&graphPtr->nodesByLabel, TCL_ONE_WORD_KEYS);
+        GraphsInt_IndexInit(&graphPtr->edgesByLabel, TCL_ONE_WORD_KEYS);
+        GraphsInt_IndexInit(&graphPtr->nodesByName, TCL_STRING_KEYS);
+        GraphsInt_IndexInit(&graphPtr->edgesByName, TCL_STRING_KEYS);
+        Tcl_InitHashTable(&graphPtr->cut, TCL_ONE_WORD_KEYS);
+        GraphsInt_AttrsInit(graphPtr);
         entryPtr = Tcl_CreateHashEntry(&gState->graphs, graphPtr->cmdName, &new);
         Tcl_SetHashValue(entryPtr, (ClientData )graphPtr);
         if (objc > paramOffset) {
@@ -657,7 +1082,7 @@ int GraphsInt_GraphCmd(ClientData clientData, Tcl_Interp *interp, int objc, Tcl_
 
         graphPtr->commandTkn = Tcl_CreateObjCommand(interp, graphPtr->cmdName, Graph_GraphSubCmd, graphPtr,
                 GraphDestroyCmd);
-        Tcl_SetObjResult(interp, Tcl_NewStringObj(graphPtr->cmdName, -1));
+        Tcl_SetObjResult(interp, GraphsInt_GraphHandleObj(graphPtr));
         return TCL_OK;
     }
     default: {
@@ -10,6 +10,142 @@ GraphState* Graphs_GetState(Tcl_Interp* interp)
     return graphState;
 }
 
+/*
+ * Implements [::graphs::allocstats]
+ *
+ * Returns a dict with the allocator statistics of the node, edge and delta entry pools.
+ */
+static int GraphsAllocStatsCmd(ClientData clientData, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[])
+{
+    GraphState* statePtr = (GraphState*)clientData;
+    Tcl_Obj* result;
+
+    if (objc != 1) {
+        Tcl_WrongNumArgs(interp, 1, objv, "");
+        return TCL_ERROR;
+    }
+
+    result = Tcl_NewListObj(0, NULL);
+    Tcl_ListObjAppendElement(interp, result, Tcl_NewStringObj("nodes", -1));
+    GraphsInt_PoolStats(&statePtr->nodePool, interp, result);
+    Tcl_ListObjAppendElement(interp, result, Tcl_NewStringObj("edges", -1));
+    GraphsInt_PoolStats(&statePtr->edgePool, interp, result);
+    Tcl_ListObjAppendElement(interp, result, Tcl_NewStringObj("deltas", -1));
+    GraphsInt_PoolStats(&statePtr->deltaPool, interp, result);
+    Tcl_SetObjResult(interp, result);
+    return TCL_OK;
+}
+
+/*
+ * Implements [::graphs::configure ?option? ?value option value ...?], which is not exported from ::graphs
+ *
+ * Package wide settings. -commands is the default for new graphs and for nodes and edges outside of graphs:
+ * whether they get a Tcl command of their own or are only addressed by handle through [node <handle> ...]
+ * and [edge <handle> ...]. -parallelarcs is the number of arcs a graph needs for -threads to split the work
+ * of an algorithm between threads, smaller graphs are done by the calling thread alone.
+ */
+static const char* GraphsConfigureOptions[] = { "-commands", "-parallelarcs", NULL };
+enum GraphsConfigureIx
+{
+    GraphsCommandsIx,
+    GraphsParallelArcsIx
+};
+
+static Tcl_Obj* GraphsConfigureValue(const GraphState* statePtr, int optIdx)
+{
+    if (optIdx == GraphsCommandsIx) {
+        return Tcl_NewBooleanObj(statePtr->createCommands);
+    }
+    return Tcl_NewIntObj(statePtr->parallelArcs);
+}
+
+static int GraphsConfigureCmd(ClientData clientData, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[])
+{
+    GraphState* statePtr = (GraphState*)clientData;
+    int optIdx;
+
+    if (objc == 1) {
+        Tcl_Obj* result = Tcl_NewListObj(0, NULL);
+        for (optIdx = 0; GraphsConfigureOptions[optIdx] != NULL; optIdx++) {
+            Tcl_ListObjAppendElement(interp, result, Tcl_NewStringObj(GraphsConfigureOptions[optIdx], -1));
+            Tcl_ListObjAppendElement(interp, result, GraphsConfigureValue(statePtr, optIdx));
+        }
+        Tcl_SetObjResult(interp, result);
+        return TCL_OK;
+    }
+    if (objc == 2) {
+        if (Tcl_GetIndexFromObj(interp, objv[1], GraphsConfigureOptions, "option", 0, &optIdx) != TCL_OK) {
+            return TCL_ERROR;
+        }
+        Tcl_SetObjResult(interp, GraphsConfigureValue(statePtr, optIdx));
+        return TCL_OK;
+    }
+    if ((objc % 2) != 1) {
+        Tcl_WrongNumArgs(interp, 1, objv, "?option? ?value option value ...?");
+        return TCL_ERROR;
+    }
+
+    for (int i = 1; i < objc; i += 2) {
+        int parallelArcs;
+
+        if (Tcl_GetIndexFromObj(interp, objv[i], GraphsConfigureOptions, "option", 0, &optIdx) != TCL_OK) {
+            return TCL_ERROR;
+        }
+        switch (optIdx) {
+        case GraphsCommandsIx:
+            if (Tcl_GetBooleanFromObj(interp, objv[i + 1], &statePtr->createCommands) != TCL_OK) {
+                return TCL_ERROR;
+            }
+            break;
+        case GraphsParallelArcsIx:
+            if (Tcl_GetIntFromObj(interp, objv[i + 1], &parallelArcs) != TCL_OK) {
+                return TCL_ERROR;
+            }
+            if (parallelArcs < 0) {
+                Tcl_SetObjResult(interp, Tcl_NewStringObj("-parallelarcs must not be negative", -1));
+                return TCL_ERROR;
+            }
+            statePtr->parallelArcs = parallelArcs;
+            break;
+        }
+    }
+    return TCL_OK;
+}
+
+/*
+ * Frees the state when the interpreter is deleted. Tcl deletes the assoc data after all commands, so all
+ * graphs and all nodes and edges with a command are gone by now. Nodes and edges without a command are
+ * destroyed here.
+ */
+static void GraphsDeleteState(ClientData clientData, Tcl_Interp* interp)
+{
+    GraphState* statePtr = (GraphState*)clientData;
+    Tcl_HashSearch search;
+    Tcl_HashEntry* entry;
+
+    while ((entry = Tcl_FirstHashEntry(&statePtr->nodes, &search)) != NULL) {
+        GraphsInt_NodeDestroyCmd(Tcl_GetHashValue(entry));
+    }
+    while ((entry = Tcl_FirstHashEntry(&statePtr->edges, &search)) != NULL) {
+        GraphsInt_EdgeDestroyCmd(Tcl_GetHashValue(entry));
+    }
+
+    Tcl_DeleteHashTable(&statePtr->graphs);
+    Tcl_DeleteHashTable(&statePtr->nodes);
+    Tcl_DeleteHashTable(&statePtr->edges);
+    GraphsInt_LabelsFree(statePtr);
+    GraphsInt_PoolRelease(&statePtr->nodePool);
+    GraphsInt_PoolRelease(&statePtr->edgePool);
+    GraphsInt_PoolRelease(&statePtr->deltaPool);
+    GraphsInt_IdsFree(&statePtr->nodeIds);
+    GraphsInt_IdsFree(&statePtr->edgeIds);
+
+    if (graphState == statePtr) {
+        graphState = NULL;
+    }
+    Tcl_Free((char*)statePtr);
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -47,6 +183,17 @@ int Graphs_Init(Tcl_Interp *interp)
     graphState->graphUid = 0;
     graphState->nodeUid = 0;
     graphState->edgeUid = 0;
+    graphState->createCommands = 1;
+    graphState->parallelArcs = GRAPHS_PARALLEL_MIN_ARCS;
+    GraphsInt_StateNewEpoch(graphState);
+    GraphsInt_LabelsInit(graphState);
+    GraphsInt_HandleTypesInit();
+    GraphsInt_PoolInit(&graphState->nodePool, sizeof(Node));
+    GraphsInt_PoolInit(&graphState->edgePool, sizeof(Edge));
+    GraphsInt_PoolInit(&graphState->deltaPool, sizeof(DeltaEntry));
+    GraphsInt_IdsInit(&graphState->nodeIds);
+    GraphsInt_IdsInit(&graphState->edgeIds);
+    Tcl_SetAssocData(interp, PACKAGE_NAME, GraphsDeleteState, graphState);
 
     if ((graphsNS = Tcl_CreateNamespace(interp, "::graphs", NULL, NULL)) == NULL) {
         Tcl_SetObjResult(interp, Tcl_NewStringObj("Cannot create ::graphs namespace", -1));
@@ -59,9 +206,16 @@ int Graphs_Init(Tcl_Interp *interp)
             (Tcl_CmdDeleteProc *) GraphsInt_NodeCleanupCmd);
     Tcl_CreateObjCommand(interp, "::graphs::edge", (Tcl_ObjCmdProc *) GraphsInt_EdgeCmd, (ClientData)graphState,
             (Tcl_CmdDeleteProc *) GraphsInt_EdgeCleanupCmd);
+    Tcl_CreateObjCommand(interp, "::graphs::configure", GraphsConfigureCmd, (ClientData)graphState, NULL);
+    Tcl_CreateObjCommand(interp, "::graphs::allocstats", GraphsAllocStatsCmd, (ClientData)graphState, NULL);
     Tcl_Export(interp, graphsNS, "graph", 0);
     Tcl_Export(interp, graphsNS, "node", 0);
     Tcl_Export(interp, graphsNS, "edge", 0);
+    Tcl_Export(interp, graphsNS, "allocstats", 0);
+    /*
+     * configure is not exported: [namespace import graphs::*] next to [namespace import tcltest::*], or any
+     * other package with a configure command, would fail. It is called as ::graphs::configure.
+     */
 
     if (Tcl_PkgProvideEx(interp, PACKAGE_NAME, PACKAGE_VERSION, &graphsStubs) != TCL_OK) {
         return TCL_ERROR;
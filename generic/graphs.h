@@ -32,6 +32,7 @@ DLLEXPORT CONST char* Graphs_InitStubs _ANSI_ARGS_((Tcl_Interp* interp, CONST ch
 #endif
 
 typedef struct _deltaEntry DeltaEntry;
+typedef struct _deltaOrderIndex DeltaOrderIndex;
 /* 
  * Marks that can be set wit the [graph mark], [edge mark] or [node mark] commands.
  * These are useful for filtering these entities in algorithms.
@@ -40,6 +41,89 @@ typedef enum _GraphsMarkT {
     GRAPHS_MARK_HIDDEN = 0x01
 } GraphsMarkT;
 
+/*
+ * Order that is maintained on a delta list while edges are added or reweighted, see delta.c
+ */
+typedef enum _DeltaOrderT {
+    DELTA_ORDER_NONE,
+    DELTA_ORDER_WEIGHT_ASC,
+    DELTA_ORDER_WEIGHT_DESC
+} DeltaOrderT;
+
+/*
+ * Slab allocator for entities of one fixed size, see pool.c
+ */
+typedef struct _graphsPool
+{
+    size_t blockSize;
+    void* slabs;
+    void* freeList;
+    int slabCount;
+    Tcl_WideInt usedCount;
+    Tcl_WideInt freeCount;
+} GraphsPool;
+
+/*
+ * Allocator of dense ids for nodes and edges, released ids are reused first, see attrs.c
+ */
+typedef struct _graphsIds
+{
+    int next;
+    int* free;
+    int freeCount;
+    int freeSize;
+
+    /* The entity and its handle generation by id, the generation of a free id is 0. See handle.c */
+    void** entities;
+    size_t* generations;
+    int capacity;
+
+    /* Block of generations reserved for this allocator: nextGeneration up to lastGeneration - 1 */
+    size_t nextGeneration;
+    size_t lastGeneration;
+} GraphsIds;
+
+/*
+ * Value types of attribute columns
+ */
+typedef enum _GraphsAttrT {
+    GRAPHS_ATTR_DOUBLE,
+    GRAPHS_ATTR_INT64,
+    GRAPHS_ATTR_FLOAT
+} GraphsAttrT;
+
+/*
+ * Typed numeric attribute column of a graph, see attrs.c. Values are stored densely by node or edge id.
+ * Slots beyond capacity and slots of entities that are not members of the graph hold the default.
+ */
+typedef struct _graphsAttr
+{
+    GraphsAttrT type;
+    int capacity;
+    union {
+        double d;
+        Tcl_WideInt w;
+        float f;
+    } defaultValue;
+    union {
+        double* d;
+        Tcl_WideInt* w;
+        float* f;
+        void* ptr;
+    } values;
+} GraphsAttr;
+
+/*
+ * Labels of a node or edge as ids of the label dictionary of the state, see labels.c.
+ * Ids below 64 are bits of a word, the others are kept in a sorted array.
+ */
+typedef struct _labelSet
+{
+    Tcl_WideUInt bits;
+    int* extra;
+    int extraCount;
+} LabelSet;
+
 typedef struct _graphState
 {
     Tcl_Interp* interp;
@@ -49,40 +133,135 @@ typedef struct _graphState
     int graphUid;
     int nodeUid;
     int edgeUid;
+
+    /* Changes on every deletion of a graph. Validates graph handles cached in Tcl_Objs */
+    size_t epoch;
+
+    /* Label dictionary: label string to id, and the names by id */
+    Tcl_HashTable labelIds;
+    Tcl_Obj** labelNames;
+    int labelCount;
+
+    /* Default for new graphs: whether nodes and edges get a Tcl command of their own */
+    int createCommands;
+
+    /* Number of arcs of a snapshot from which on -threads uses more than one thread */
+    int parallelArcs;
+
+    /* Memory for nodes, edges and delta entries */
+    GraphsPool nodePool;
+    GraphsPool edgePool;
+    GraphsPool deltaPool;
+
+    /* Dense ids of nodes and edges, index the attribute columns of graphs */
+    GraphsIds nodeIds;
+    GraphsIds edgeIds;
 } GraphState;
 
+/*
+ * Frozen compressed sparse row view of the nodes of a graph and the edges between them.
+ * Built on demand with Graphs_GraphGetSnapshot() and dropped on the next mutation of the graph.
+ * Row i of the out* arrays holds the arcs leaving node i at positions outOffsets[i] .. outOffsets[i+1]-1,
+ * the in* arrays are the transpose of that.
+ */
+typedef struct _graphSnapshot
+{
+    int nodeCount;
+    int edgeCount;
+
+    /* dense node ids, and the reverse mapping from Node* to id */
+    struct _node** nodes;
+    Tcl_HashTable ids;
+
+    int* outOffsets;
+    int* outTargets;
+    struct _edge** outEdges;
+    double* outWeights;
+
+    int* inOffsets;
+    int* inSources;
+    struct _edge** inEdges;
+    double* inWeights;
+} GraphSnapshot;
+
 typedef struct _graph
 {
     char cmdName[30];
     char name[30];
     Tcl_Command commandTkn;
     GraphState* statePtr;
+
+    /* Shared Tcl_Obj of cmdName returned in results, created on first use, see handle.c */
+    Tcl_Obj* handleObj;
     Tcl_HashTable nodes;
     Tcl_HashTable edges;
     int order;
 
+    /* Inverted label indexes: label id to the set of member nodes / edges with that label */
+    Tcl_HashTable nodesByLabel;
+    Tcl_HashTable edgesByLabel;
+
+    /* Name indexes: -name of member nodes / edges to the set of nodes / edges with that name */
+    Tcl_HashTable nodesByName;
+    Tcl_HashTable edgesByName;
+
+    /* Cut: the edges between a member node and a node outside of the graph, Edge* to Edge* */
+    Tcl_HashTable cut;
+
+    /* Attribute columns of the member nodes / edges: name to GraphsAttr* */
+    Tcl_HashTable nodeAttrs;
+    Tcl_HashTable edgeAttrs;
+
     /* Arbitrary data that can be attached to the graph */
     Tcl_Obj* data;
 
     /* OR-combined flag of marks that can be set to the graph */
     unsigned int marks;
+
+    /* Whether nodes created in this graph and edges from its nodes get a Tcl command of their own */
+    int createCommands;
+
+    /* CSR snapshot for read only algorithms, NULL if not built or invalidated by a mutation */
+    GraphSnapshot* snapshot;
 } Graph;
 
 typedef struct _node
 {
     char cmdName[30];
-    char name[30];
+
+    /* The -name, allocated to its length, see GraphsInt_NameSet() */
+    char* name;
     GraphState* statePtr;
+
+    /* Dense id, unique among the live nodes of the state. Indexes attribute columns */
+    int id;
+
+    /* The node command, NULL if the node is only addressed by its handle through [node <handle> ...] */
     Tcl_Command commandTkn;
 
+    /* Shared Tcl_Obj of cmdName returned in results, created on first use, see handle.c */
+    Tcl_Obj* handleObj;
+
     /* Neighbor nodes reachable from this node. Map of nodes to edges */
     DeltaEntry* outgoing;
 
     /* Nodes with incoming edges, mapped to their edges. Mainly used for cleanup */
     DeltaEntry* incoming;
 
+    /* Hash indexes from neighbor Node* to DeltaEntry*, only present on high degree nodes */
+    Tcl_HashTable* outgoingIndex;
+    Tcl_HashTable* incomingIndex;
+
+    /* Whether the outgoing / incoming list is kept sorted by edge weight, set by [$node delta sort -keep] */
+    DeltaOrderT outgoingOrder;
+    DeltaOrderT incomingOrder;
+
+    /* Search trees over the lists that keep a weight order, NULL for the other lists, see delta.c */
+    DeltaOrderIndex* outgoingOrderIndex;
+    DeltaOrderIndex* incomingOrderIndex;
+
     /* labels assigned to the node. Can be used for filtering */
-    Tcl_HashTable labels;
+    LabelSet labels;
 
     /* graph where the node is part of */
     Graph* graph;
@@ -114,9 +293,19 @@ typedef enum DeltaType
 typedef struct _edge
 {
     char cmdName[30];
-    char name[30];
+
+    /* The -name, allocated to its length, see GraphsInt_NameSet() */
+    char* name;
     GraphState* statePtr;
+
+    /* Dense id, unique among the live edges of the state. Indexes attribute columns */
+    int id;
+
+    /* The edge command, NULL if the edge is only addressed by its handle through [edge <handle> ...] */
     Tcl_Command commandTkn;
+
+    /* Shared Tcl_Obj of cmdName returned in results, created on first use, see handle.c */
+    Tcl_Obj* handleObj;
     Node* fromNode;
     Node* toNode;
 
@@ -124,7 +313,7 @@ typedef struct _edge
     Tcl_Obj* data;
 
     /* Labels for the edge */
-    Tcl_HashTable labels;
+    LabelSet labels;
 
     double weight;
 
@@ -152,6 +341,10 @@ struct LabelFilter
     LabelFilterT filterType;
     int objc;
     Tcl_Obj* const* objv;
+
+    /* The labels of objv as ids, and whether one of them is not known. Set by GraphsInt_LabelFilterInit() */
+    LabelSet mask;
+    int unknown;
 };
 
 struct _deltaEntry
@@ -159,6 +352,7 @@ struct _deltaEntry
     Node* nodePtr;
     Edge* edgePtr;
     struct _deltaEntry* next;
+    struct _deltaEntry* prev;
 };
 
 #include "graphsDecls.h"
@@ -41,6 +41,14 @@ GRAPHSAPI Edge*		Graphs_EdgeCreateEdge(GraphState*statePtr,
 /* 9 */
 GRAPHSAPI void		Graphs_EdgeDeleteEdge(Edge*nodePtr,
 				Tcl_Interp*interp);
+/* 10 */
+GRAPHSAPI GraphSnapshot* Graphs_GraphGetSnapshot(Graph*graphPtr);
+/* 11 */
+GRAPHSAPI Graph*	Graphs_GraphGetFromObj(const GraphState*statePtr,
+				Tcl_Obj*objPtr);
+/* 12 */
+GRAPHSAPI Node*		Graphs_NodeGetFromObj(const GraphState*statePtr,
+				Tcl_Obj*objPtr);
 
 typedef struct GraphsStubs {
     int magic;
@@ -56,6 +64,9 @@ typedef struct GraphsStubs {
     int (*graphs_EdgeHasMarks) (const Edge*edgePtr, unsigned marksMask); /* 7 */
     Edge* (*graphs_EdgeCreateEdge) (GraphState*statePtr, Node*fromNodePtr, Node*toNodePtr, int undirected, Tcl_Interp*interp, const char*cmdName, int objc, Tcl_Obj* const objv[]); /* 8 */
     void (*graphs_EdgeDeleteEdge) (Edge*nodePtr, Tcl_Interp*interp); /* 9 */
+    GraphSnapshot* (*graphs_GraphGetSnapshot) (Graph*graphPtr); /* 10 */
+    Graph* (*graphs_GraphGetFromObj) (const GraphState*statePtr, Tcl_Obj*objPtr); /* 11 */
+    Node* (*graphs_NodeGetFromObj) (const GraphState*statePtr, Tcl_Obj*objPtr); /* 12 */
 } GraphsStubs;
 
 extern const GraphsStubs *graphsStubsPtr;
@@ -90,6 +101,12 @@ extern const GraphsStubs *graphsStubsPtr;
 	(graphsStubsPtr->graphs_EdgeCreateEdge) /* 8 */
 #define Graphs_EdgeDeleteEdge \
 	(graphsStubsPtr->graphs_EdgeDeleteEdge) /* 9 */
+#define Graphs_GraphGetSnapshot \
+	(graphsStubsPtr->graphs_GraphGetSnapshot) /* 10 */
+#define Graphs_GraphGetFromObj \
+	(graphsStubsPtr->graphs_GraphGetFromObj) /* 11 */
+#define Graphs_NodeGetFromObj \
+	(graphsStubsPtr->graphs_NodeGetFromObj) /* 12 */
 
 #endif /* defined(USE_GRAPHS_STUBS) */
 
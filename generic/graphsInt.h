@@ -3,20 +3,97 @@
 
 #include "graphs.h"
 
+/*
+ * Length of a delta list from which on lookups by neighbor node go through a hash index
+ */
+#define GRAPHS_DELTA_INDEX_THRESHOLD 32
+
+/*
+ * Number of blocks allocated at once by the entity pools
+ */
+#define GRAPHS_POOL_SLAB_BLOCKS 256
+
+/*
+ * Number of label ids kept in the bit word of a LabelSet
+ */
+#define GRAPHS_LABEL_BITS 64
+
+/*
+ * Default number of arcs from which on -threads splits the work of an algorithm between threads, see
+ * [::graphs::configure -parallelarcs]
+ */
+#define GRAPHS_PARALLEL_MIN_ARCS 65536
+
 int GraphsInt_CheckCommandExists(Tcl_Interp* interp, const char* cmdName);
+int GraphsInt_IsGlobPattern(const char* pattern);
+void GraphsInt_NameSet(char** nameRef, const char* name);
+void GraphsInt_NameFree(char** nameRef);
 
-int GraphsInt_MatchesLabels(const Tcl_HashTable* labels, const char* name, struct LabelFilter lblFilt, int* matchPtr);
+int GraphsInt_MatchesLabels(const LabelSet* labels, const char* name, const struct LabelFilter* lblFiltPtr, int* matchPtr);
 
-int GraphsInt_GetNodes(Tcl_HashTable fromTbl, struct LabelFilter lblFilt, Tcl_Interp* interp);
+int GraphsInt_GetNodes(const Tcl_HashTable* fromTbl, const struct LabelFilter* lblFiltPtr, Tcl_Interp* interp);
 
 int GraphsInt_GraphCmd(ClientData clientData, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[]);
+int GraphsInt_GraphCmdLoad(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[]);
+Node* GraphsInt_GraphGetOrCreateNode(Graph* graphPtr, const char* name, Tcl_Interp* interp);
+int GraphsInt_GraphCmdRead(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[]);
+int GraphsInt_GraphCmdWrite(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[]);
+int GraphsInt_GraphCmdEdges(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[]);
+int GraphsInt_GraphCmdShortestPath(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[]);
+int GraphsInt_GraphCmdNegativeCycle(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[]);
+int GraphsInt_GraphCmdAllPaths(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[]);
+int GraphsInt_PathsFilterInit(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[],
+    struct LabelFilter* lblFiltPtr);
+int GraphsInt_PathsGetThreads(Tcl_Interp* interp, Tcl_Obj* valueObj, int* threadsPtr);
+int GraphsInt_GraphCmdApsp(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[]);
+int GraphsInt_GraphCmdBfs(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[]);
 void GraphsInt_GraphCleanupCmd(ClientData data);
 
 int GraphsInt_NodeCmd(ClientData clientData, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[]);
 void GraphsInt_NodeCleanupCmd(ClientData data);
+void GraphsInt_NodeDestroyCmd(ClientData data);
 
 int GraphsInt_EdgeCmd(ClientData clientData, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[]);
 void GraphsInt_EdgeCleanupCmd(ClientData data);
+void GraphsInt_EdgeDestroyCmd(ClientData data);
+Edge* GraphsInt_EdgeGetByCommand(const GraphState* statePtr, const char* eName);
+void GraphsInt_EdgeSetName(Edge* edgePtr, const char* name);
+void GraphsInt_EdgeSetWeight(Edge* edgePtr, double weight);
+Edge* GraphsInt_EdgeCreateWeighted(GraphState* gState, Node* fromNodePtr, Node* toNodePtr, int unDirected,
+    double weight, Tcl_Interp* interp);
+void GraphsInt_EdgeRefreshGraph(Edge* edgePtr, Graph* graphPtr);
+void GraphsInt_NodesAddToGraph(Graph* graphPtr, Node* const nodes[], int count);
+Node* GraphsInt_NodeCreateNode(GraphState* gState, Graph* graphPtr, const char* name, Tcl_Interp* interp);
+
+/*
+ * Dense entity ids and typed attribute columns, see attrs.c
+ */
+void GraphsInt_IdsInit(GraphsIds* idsPtr);
+void GraphsInt_IdsFree(GraphsIds* idsPtr);
+int GraphsInt_IdAlloc(GraphsIds* idsPtr, void* entity);
+void GraphsInt_IdRelease(GraphsIds* idsPtr, int id);
+void GraphsInt_AttrsInit(Graph* graphPtr);
+void GraphsInt_AttrsFree(Graph* graphPtr);
+void GraphsInt_AttrsReset(Tcl_HashTable* tablePtr, int id);
+void GraphsInt_AttrsClear(Tcl_HashTable* tablePtr);
+GraphsAttr* GraphsInt_AttrFind(const Tcl_HashTable* tablePtr, const char* name);
+double GraphsInt_AttrGet(const GraphsAttr* attrPtr, int id);
+Tcl_Obj* GraphsInt_AttrGetObj(const GraphsAttr* attrPtr, int id);
+int GraphsInt_AttrCheckObj(Tcl_Interp* interp, const GraphsAttr* attrPtr, Tcl_Obj* valueObj);
+int GraphsInt_AttrSetFromObj(Tcl_Interp* interp, GraphsAttr* attrPtr, int id, Tcl_Obj* valueObj);
+int GraphsInt_GraphCmdAttrs(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[]);
+
+/*
+ * Handle object types caching resolved entities, see handle.c
+ */
+void GraphsInt_HandleTypesInit(void);
+void GraphsInt_StateNewEpoch(GraphState* statePtr);
+size_t GraphsInt_HandleReserveGenerations(size_t count);
+Edge* GraphsInt_EdgeGetFromObj(const GraphState* statePtr, Tcl_Obj* objPtr);
+Tcl_Obj* GraphsInt_GraphHandleObj(Graph* graphPtr);
+Tcl_Obj* GraphsInt_NodeHandleObj(Node* nodePtr);
+Tcl_Obj* GraphsInt_EdgeHandleObj(Edge* edgePtr);
+void GraphsInt_HandleObjFree(Tcl_Obj** objRef);
 
 /*
  * \brief Checks the argument count for label filters.
@@ -29,11 +106,85 @@ int GraphsInt_CheckLabelsOptions(LabelFilterT, Tcl_Interp*, int, Tcl_Obj* const
 /*
  * Common procedure to add/remove or get labels for nodes and edges
  */
-int GraphsInt_LabelsCommand(Tcl_HashTable, Tcl_Interp*, int, Tcl_Obj* const []);
+int GraphsInt_LabelsCommand(GraphState*, LabelSet*, Tcl_HashTable* const indexes[], ClientData entity, Tcl_Interp*, int,
+    Tcl_Obj* const []);
+
+/*
+ * Label dictionary and label sets, see labels.c
+ */
+void GraphsInt_LabelsInit(GraphState* statePtr);
+void GraphsInt_LabelsFree(GraphState* statePtr);
+int GraphsInt_LabelIntern(GraphState* statePtr, Tcl_Obj* labelObj);
+int GraphsInt_LabelLookup(const GraphState* statePtr, Tcl_Obj* labelObj);
+void GraphsInt_LabelSetInit(LabelSet* setPtr);
+void GraphsInt_LabelSetFree(LabelSet* setPtr);
+int GraphsInt_LabelSetContains(const LabelSet* setPtr, int id);
+int GraphsInt_LabelSetAdd(LabelSet* setPtr, int id);
+int GraphsInt_LabelSetRemove(LabelSet* setPtr, int id);
+int GraphsInt_LabelSetHasAll(const LabelSet* setPtr, const LabelSet* maskPtr);
+int GraphsInt_LabelSetHasAny(const LabelSet* setPtr, const LabelSet* maskPtr);
+Tcl_Obj* GraphsInt_LabelSetToList(const GraphState* statePtr, const LabelSet* setPtr);
+void GraphsInt_LabelFilterInit(const GraphState* statePtr, struct LabelFilter* lblFiltPtr);
+void GraphsInt_LabelFilterFree(struct LabelFilter* lblFiltPtr);
+void GraphsInt_LabelIndexUpdate(Tcl_HashTable* const indexes[], int id, ClientData entity, int add);
+void GraphsInt_LabelIndexUpdateAll(Tcl_HashTable* indexPtr, const LabelSet* setPtr, ClientData entity, int add);
+Tcl_HashTable* GraphsInt_LabelIndexCandidates(const Tcl_HashTable* indexPtr, const struct LabelFilter* lblFiltPtr);
+
+/*
+ * Multi-valued indexes from labels or names to sets of nodes or edges, see index.c
+ */
+void GraphsInt_IndexInit(Tcl_HashTable* indexPtr, int keyType);
+void GraphsInt_IndexFree(Tcl_HashTable* indexPtr);
+void GraphsInt_IndexAdd(Tcl_HashTable* indexPtr, const void* key, ClientData entity);
+void GraphsInt_IndexRemove(Tcl_HashTable* indexPtr, const void* key, ClientData entity);
+Tcl_HashTable* GraphsInt_IndexGet(const Tcl_HashTable* indexPtr, const void* key);
 
 /*
  * Get delta (neighborhood) of a node or graph
  */
-int GraphsInt_GetDelta(Node*, Graph*, DeltaT, struct LabelFilter, Tcl_Interp* interp, Tcl_Obj** resultObj);
+int GraphsInt_GetDelta(Node*, Graph*, DeltaT, const struct LabelFilter*, Tcl_Interp* interp, Tcl_Obj** resultObj);
+
+/*
+ * Maintenance of the delta lists of nodes. DELTA_PLUS selects the outgoing, DELTA_MINUS the incoming list.
+ */
+DeltaEntry* GraphsInt_DeltaFind(Node* nodePtr, DeltaT deltaType, const Node* neighborPtr);
+DeltaEntry* GraphsInt_DeltaInsert(Node* nodePtr, DeltaT deltaType, Node* neighborPtr, Edge* edgePtr);
+void GraphsInt_DeltaDelete(Node* nodePtr, DeltaT deltaType, const Node* neighborPtr);
+void GraphsInt_DeltaFree(Node* nodePtr, DeltaT deltaType);
+
+typedef int (GraphsDeltaCompareProc)(const DeltaEntry* entry1, const DeltaEntry* entry2);
+int GraphsInt_DeltaCompareNodeName(const DeltaEntry* entry1, const DeltaEntry* entry2);
+int GraphsInt_DeltaCompareEdgeName(const DeltaEntry* entry1, const DeltaEntry* entry2);
+int GraphsInt_DeltaCompareWeight(const DeltaEntry* entry1, const DeltaEntry* entry2);
+void GraphsInt_DeltaSort(Node* nodePtr, DeltaT deltaType, GraphsDeltaCompareProc* compareProc, int descending);
+void GraphsInt_DeltaSetOrder(Node* nodePtr, DeltaT deltaType, DeltaOrderT order);
+void GraphsInt_DeltaReposition(Node* nodePtr, DeltaT deltaType, const Node* neighborPtr);
+int GraphsInt_DeltaTop(Node* nodePtr, DeltaT deltaType, int k, int descending,
+    const struct LabelFilter* lblFiltPtr, const DeltaEntry** topEntries);
+
+/*
+ * Drops the CSR snapshot of a graph after a mutation, see snapshot.c
+ */
+void GraphsInt_SnapshotInvalidate(Graph* graphPtr);
+int GraphsInt_SnapshotNodeId(const GraphSnapshot* snapPtr, const Node* nodePtr);
+
+/*
+ * Slab allocator for nodes, edges and delta entries, see pool.c
+ */
+void GraphsInt_PoolInit(GraphsPool* poolPtr, size_t blockSize);
+void* GraphsInt_PoolAlloc(GraphsPool* poolPtr);
+void GraphsInt_PoolFree(GraphsPool* poolPtr, void* block);
+void GraphsInt_PoolTrim(GraphsPool* poolPtr);
+void GraphsInt_PoolRelease(GraphsPool* poolPtr);
+void GraphsInt_PoolStats(const GraphsPool* poolPtr, Tcl_Interp* interp, Tcl_Obj* listObj);
+
+/*
+ * Worker threads that stay up between the steps of a parallel algorithm, see workers.c
+ */
+typedef void(GraphsWorkFunc)(void* item);
+typedef struct _graphsWorkers GraphsWorkers;
+GraphsWorkers* GraphsInt_WorkersStart(int count, GraphsWorkFunc* func, void* items, size_t itemSize);
+void GraphsInt_WorkersRun(GraphsWorkers* poolPtr);
+void GraphsInt_WorkersStop(GraphsWorkers* poolPtr);
 
 #endif // GRAPHSINT_H
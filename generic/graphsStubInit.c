@@ -17,6 +17,9 @@ const GraphsStubs graphsStubs = {
     Graphs_EdgeHasMarks, /* 7 */
     Graphs_EdgeCreateEdge, /* 8 */
     Graphs_EdgeDeleteEdge, /* 9 */
+    Graphs_GraphGetSnapshot, /* 10 */
+    Graphs_GraphGetFromObj, /* 11 */
+    Graphs_NodeGetFromObj, /* 12 */
 };
 
 /* !END!: Do not edit above this line. */
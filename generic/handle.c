@@ -0,0 +1,202 @@
+/*
+ * Tcl object types for graph, node and edge handles
+ *
+ * Resolving a handle by its name costs a string hash lookup in the state tables. The graphs::graph,
+ * graphs::node and graphs::edge object types cache the result of that lookup in the Tcl_Obj.
+ *
+ * Node and edge handles cache the dense id of the entity together with its generation. Each id allocator
+ * of a state keeps the entity and the generation by id, and every new entity gets a generation that is
+ * unique across all states of the process, while the generation of a deleted entity is cleared. So a
+ * cached id with a matching generation names the same live entity of the state it is looked up in, and
+ * deleting one node or edge only invalidates the handles of that entity. The check reads the arrays of
+ * the state only, never the memory of an entity that may be gone.
+ *
+ * Graph handles cache the pointer with the epoch of the state, which changes whenever a graph of the
+ * state is deleted. Epochs are unique across all states of the process as well.
+ *
+ * Every entity also owns one shared handle object, created on first use. Commands returning handles append
+ * this object instead of a new string, so a result list costs one pointer per element, and handles passed
+ * back in from such a result are resolved without a lookup.
+ */
+#include "graphsInt.h"
+
+TCL_DECLARE_MUTEX(epochMutex)
+static size_t epochCounter = 0;
+static size_t generationCounter = 0;
+
+static void HandleDupIntRep(Tcl_Obj* srcPtr, Tcl_Obj* dupPtr);
+
+static const Tcl_ObjType graphHandleType = {
+    "graphs::graph",
+    NULL,
+    HandleDupIntRep,
+    NULL,
+    NULL
+};
+
+static const Tcl_ObjType nodeHandleType = {
+    "graphs::node",
+    NULL,
+    HandleDupIntRep,
+    NULL,
+    NULL
+};
+
+static const Tcl_ObjType edgeHandleType = {
+    "graphs::edge",
+    NULL,
+    HandleDupIntRep,
+    NULL,
+    NULL
+};
+
+static void HandleDupIntRep(Tcl_Obj* srcPtr, Tcl_Obj* dupPtr)
+{
+    dupPtr->internalRep.twoPtrValue.ptr1 = srcPtr->internalRep.twoPtrValue.ptr1;
+    dupPtr->internalRep.twoPtrValue.ptr2 = srcPtr->internalRep.twoPtrValue.ptr2;
+    dupPtr->typePtr = srcPtr->typePtr;
+}
+
+/*
+ * Registers the handle types, so that they show up in [testobj types] and the like
+ */
+void GraphsInt_HandleTypesInit(void)
+{
+    Tcl_RegisterObjType(&graphHandleType);
+    Tcl_RegisterObjType(&nodeHandleType);
+    Tcl_RegisterObjType(&edgeHandleType);
+}
+
+/*
+ * Gives the state a new, process wide unique epoch. Must be called whenever a graph of the state is
+ * deleted, which invalidates all graph handles cached for the state.
+ */
+void GraphsInt_StateNewEpoch(GraphState* statePtr)
+{
+    Tcl_MutexLock(&epochMutex);
+    statePtr->epoch = ++epochCounter;
+    Tcl_MutexUnlock(&epochMutex);
+}
+
+/*
+ * Reserves count process wide unique handle generations and returns the first one. Generations are never 0.
+ */
+size_t GraphsInt_HandleReserveGenerations(size_t count)
+{
+    size_t first;
+
+    Tcl_MutexLock(&epochMutex);
+    first = generationCounter + 1;
+    generationCounter += count;
+    Tcl_MutexUnlock(&epochMutex);
+    return first;
+}
+
+static void HandleSetIntRep(Tcl_Obj* objPtr, const Tcl_ObjType* typePtr, void* ptr1, size_t ptr2)
+{
+    if (objPtr->typePtr != NULL && objPtr->typePtr->freeIntRepProc != NULL) {
+        objPtr->typePtr->freeIntRepProc(objPtr);
+    }
+    objPtr->internalRep.twoPtrValue.ptr1 = ptr1;
+    objPtr->internalRep.twoPtrValue.ptr2 = (void*)ptr2;
+    objPtr->typePtr = typePtr;
+}
+
+Graph* Graphs_GraphGetFromObj(const GraphState* statePtr, Tcl_Obj* objPtr)
+{
+    Tcl_HashEntry* entry;
+
+    if (objPtr->typePtr == &graphHandleType && (size_t)objPtr->internalRep.twoPtrValue.ptr2 == statePtr->epoch) {
+        return (Graph*)objPtr->internalRep.twoPtrValue.ptr1;
+    }
+    entry = Tcl_FindHashEntry((Tcl_HashTable*)&statePtr->graphs, Tcl_GetString(objPtr));
+    if (entry == NULL) {
+        return NULL;
+    }
+    HandleSetIntRep(objPtr, &graphHandleType, Tcl_GetHashValue(entry), statePtr->epoch);
+    return (Graph*)Tcl_GetHashValue(entry);
+}
+
+/* Resolves a node or edge handle through the cached id and generation, or by name */
+static void* HandleGetFromObj(const GraphsIds* idsPtr, Tcl_Obj* objPtr, const Tcl_ObjType* typePtr,
+    const Tcl_HashTable* tablePtr, int (*idProc)(const void* entity))
+{
+    Tcl_HashEntry* entry;
+    int id;
+
+    if (objPtr->typePtr == typePtr) {
+        id = (int)(size_t)objPtr->internalRep.twoPtrValue.ptr1;
+        if (id < idsPtr->capacity && idsPtr->generations[id] == (size_t)objPtr->internalRep.twoPtrValue.ptr2) {
+            return idsPtr->entities[id];
+        }
+    }
+
+    entry = Tcl_FindHashEntry((Tcl_HashTable*)tablePtr, Tcl_GetString(objPtr));
+    if (entry == NULL) {
+        return NULL;
+    }
+    id = idProc(Tcl_GetHashValue(entry));
+    HandleSetIntRep(objPtr, typePtr, (void*)(size_t)id, idsPtr->generations[id]);
+    return Tcl_GetHashValue(entry);
+}
+
+static int HandleNodeId(const void* entity)
+{
+    return ((const Node*)entity)->id;
+}
+
+static int HandleEdgeId(const void* entity)
+{
+    return ((const Edge*)entity)->id;
+}
+
+Node* Graphs_NodeGetFromObj(const GraphState* statePtr, Tcl_Obj* objPtr)
+{
+    return (Node*)HandleGetFromObj(&statePtr->nodeIds, objPtr, &nodeHandleType, &statePtr->nodes, HandleNodeId);
+}
+
+Edge* GraphsInt_EdgeGetFromObj(const GraphState* statePtr, Tcl_Obj* objPtr)
+{
+    return (Edge*)HandleGetFromObj(&statePtr->edgeIds, objPtr, &edgeHandleType, &statePtr->edges, HandleEdgeId);
+}
+
+static Tcl_Obj* HandleObj(Tcl_Obj** objRef, const char* cmdName, const Tcl_ObjType* typePtr, void* ptr1,
+    size_t ptr2)
+{
+    if (*objRef == NULL) {
+        Tcl_Obj* objPtr = Tcl_NewStringObj(cmdName, -1);
+        HandleSetIntRep(objPtr, typePtr, ptr1, ptr2);
+        Tcl_IncrRefCount(objPtr);
+        *objRef = objPtr;
+    }
+    return *objRef;
+}
+
+Tcl_Obj* GraphsInt_GraphHandleObj(Graph* graphPtr)
+{
+    return HandleObj(&graphPtr->handleObj, graphPtr->cmdName, &graphHandleType, graphPtr,
+        graphPtr->statePtr->epoch);
+}
+
+Tcl_Obj* GraphsInt_NodeHandleObj(Node* nodePtr)
+{
+    return HandleObj(&nodePtr->handleObj, nodePtr->cmdName, &nodeHandleType, (void*)(size_t)nodePtr->id,
+        nodePtr->statePtr->nodeIds.generations[nodePtr->id]);
+}
+
+Tcl_Obj* GraphsInt_EdgeHandleObj(Edge* edgePtr)
+{
+    return HandleObj(&edgePtr->handleObj, edgePtr->cmdName, &edgeHandleType, (void*)(size_t)edgePtr->id,
+        edgePtr->statePtr->edgeIds.generations[edgePtr->id]);
+}
+
+/*
+ * Releases the shared handle object of an entity that is deleted
+ */
+void GraphsInt_HandleObjFree(Tcl_Obj** objRef)
+{
+    if (*objRef != NULL) {
+        Tcl_DecrRefCount(*objRef);
+        *objRef = NULL;
+    }
+}
@@ -0,0 +1,74 @@
+/*
+ * Multi-valued indexes of graphs
+ *
+ * An index maps a key (a label id or a name) to the set of member nodes or edges of a graph with that key.
+ * The sets are hash tables with the entity pointers as keys and values, so they can be walked like the
+ * node and edge tables of the graph. Empty sets are dropped, so a key is in the index only if at least one
+ * entity has it.
+ */
+#include "graphsInt.h"
+
+void GraphsInt_IndexInit(Tcl_HashTable* indexPtr, int keyType)
+{
+    Tcl_InitHashTable(indexPtr, keyType);
+}
+
+void GraphsInt_IndexFree(Tcl_HashTable* indexPtr)
+{
+    Tcl_HashSearch search;
+
+    for (Tcl_HashEntry* entry = Tcl_FirstHashEntry(indexPtr, &search); entry != NULL; entry = Tcl_NextHashEntry(&search)) {
+        Tcl_HashTable* setPtr = (Tcl_HashTable*)Tcl_GetHashValue(entry);
+        Tcl_DeleteHashTable(setPtr);
+        ckfree((char*)setPtr);
+    }
+    Tcl_DeleteHashTable(indexPtr);
+}
+
+void GraphsInt_IndexAdd(Tcl_HashTable* indexPtr, const void* key, ClientData entity)
+{
+    int new;
+    Tcl_HashEntry* entry = Tcl_CreateHashEntry(indexPtr, key, &new);
+    Tcl_HashTable* setPtr;
+
+    if (new) {
+        setPtr = (Tcl_HashTable*)ckalloc(sizeof(Tcl_HashTable));
+        Tcl_InitHashTable(setPtr, TCL_ONE_WORD_KEYS);
+        Tcl_SetHashValue(entry, setPtr);
+    }
+    else {
+        setPtr = (Tcl_HashTable*)Tcl_GetHashValue(entry);
+    }
+    entry = Tcl_CreateHashEntry(setPtr, entity, &new);
+    Tcl_SetHashValue(entry, entity);
+}
+
+void GraphsInt_IndexRemove(Tcl_HashTable* indexPtr, const void* key, ClientData entity)
+{
+    Tcl_HashEntry* entry = Tcl_FindHashEntry(indexPtr, key);
+    Tcl_HashTable* setPtr;
+    Tcl_HashEntry* setEntry;
+
+    if (entry == NULL) {
+        return;
+    }
+    setPtr = (Tcl_HashTable*)Tcl_GetHashValue(entry);
+    setEntry = Tcl_FindHashEntry(setPtr, entity);
+    if (setEntry != NULL) {
+        Tcl_DeleteHashEntry(setEntry);
+    }
+    if (setPtr->numEntries == 0) {
+        Tcl_DeleteHashTable(setPtr);
+        ckfree((char*)setPtr);
+        Tcl_DeleteHashEntry(entry);
+    }
+}
+
+/*
+ * Returns the set of entities with the given key, or NULL if there are none
+ */
+Tcl_HashTable* GraphsInt_IndexGet(const Tcl_HashTable* indexPtr, const void* key)
+{
+    Tcl_HashEntry* entry = Tcl_FindHashEntry((Tcl_HashTable*)indexPtr, key);
+    return (entry == NULL) ? NULL : (Tcl_HashTable*)Tcl_GetHashValue(entry);
+}
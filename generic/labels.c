@@ -0,0 +1,333 @@
+/*
+ * Interned labels and label sets of nodes and edges
+ *
+ * All label strings of a state are interned in a dictionary that maps each label to a small integer id.
+ * Nodes and edges store their labels as a LabelSet: a 64 bit word for the ids below GRAPHS_LABEL_BITS and a
+ * sorted array for the (rare) ids beyond. Label filters are compiled into a LabelSet as well, so matching
+ * an entity is a word-wise AND or AND NOT instead of one string hash per label.
+ */
+#include "graphsInt.h"
+#include <stdlib.h>
+#include <string.h>
+
+void GraphsInt_LabelsInit(GraphState* statePtr)
+{
+    Tcl_InitHashTable(&statePtr->labelIds, TCL_STRING_KEYS);
+    statePtr->labelNames = NULL;
+    statePtr->labelCount = 0;
+}
+
+void GraphsInt_LabelsFree(GraphState* statePtr)
+{
+    for (int i = 0; i < statePtr->labelCount; i++) {
+        Tcl_DecrRefCount(statePtr->labelNames[i]);
+    }
+    if (statePtr->labelNames != NULL) {
+        ckfree((char*)statePtr->labelNames);
+    }
+    Tcl_DeleteHashTable(&statePtr->labelIds);
+}
+
+/*
+ * Returns the id of a label, interning it first if it is not known yet
+ */
+int GraphsInt_LabelIntern(GraphState* statePtr, Tcl_Obj* labelObj)
+{
+    int new;
+    Tcl_HashEntry* entry = Tcl_CreateHashEntry(&statePtr->labelIds, Tcl_GetString(labelObj), &new);
+
+    if (new) {
+        int id = statePtr->labelCount++;
+        /* grow in powers of two */
+        if ((id & (id - 1)) == 0) {
+            statePtr->labelNames = (Tcl_Obj**)ckrealloc((char*)statePtr->labelNames,
+                (id == 0 ? 1 : 2 * id) * sizeof(Tcl_Obj*));
+        }
+        statePtr->labelNames[id] = Tcl_NewStringObj(Tcl_GetString(labelObj), -1);
+        Tcl_IncrRefCount(statePtr->labelNames[id]);
+        Tcl_SetHashValue(entry, (ClientData)(size_t)id);
+    }
+    return (int)(size_t)Tcl_GetHashValue(entry);
+}
+
+/*
+ * Returns the id of a label, or -1 if the label was never used in the state
+ */
+int GraphsInt_LabelLookup(const GraphState* statePtr, Tcl_Obj* labelObj)
+{
+    Tcl_HashEntry* entry = Tcl_FindHashEntry((Tcl_HashTable*)&statePtr->labelIds, Tcl_GetString(labelObj));
+    return (entry == NULL) ? -1 : (int)(size_t)Tcl_GetHashValue(entry);
+}
+
+void GraphsInt_LabelSetInit(LabelSet* setPtr)
+{
+    setPtr->bits = 0;
+    setPtr->extra = NULL;
+    setPtr->extraCount = 0;
+}
+
+void GraphsInt_LabelSetFree(LabelSet* setPtr)
+{
+    if (setPtr->extra != NULL) {
+        ckfree((char*)setPtr->extra);
+    }
+    GraphsInt_LabelSetInit(setPtr);
+}
+
+/* Binary search in the extra ids. Returns the position of id, or the insert position as -(pos + 1) */
+static int LabelSetFindExtra(const LabelSet* setPtr, int id)
+{
+    int lo = 0;
+    int hi = setPtr->extraCount - 1;
+
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        if (setPtr->extra[mid] == id) {
+            return mid;
+        }
+        if (setPtr->extra[mid] < id) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid - 1;
+        }
+    }
+    return -(lo + 1);
+}
+
+int GraphsInt_LabelSetContains(const LabelSet* setPtr, int id)
+{
+    if (id < GRAPHS_LABEL_BITS) {
+        return (setPtr->bits & ((Tcl_WideUInt)1 << id)) != 0;
+    }
+    return LabelSetFindExtra(setPtr, id) >= 0;
+}
+
+/*
+ * Adds a label id to a set. Returns 1 if it was added, 0 if it was already in the set.
+ */
+int GraphsInt_LabelSetAdd(LabelSet* setPtr, int id)
+{
+    int pos;
+
+    if (id < GRAPHS_LABEL_BITS) {
+        Tcl_WideUInt bit = (Tcl_WideUInt)1 << id;
+        if (setPtr->bits & bit) {
+            return 0;
+        }
+        setPtr->bits |= bit;
+        return 1;
+    }
+
+    pos = LabelSetFindExtra(setPtr, id);
+    if (pos >= 0) {
+        return 0;
+    }
+    pos = -pos - 1;
+    setPtr->extra = (int*)ckrealloc((char*)setPtr->extra, (setPtr->extraCount + 1) * sizeof(int));
+    memmove(setPtr->extra + pos + 1, setPtr->extra + pos, (setPtr->extraCount - pos) * sizeof(int));
+    setPtr->extra[pos] = id;
+    setPtr->extraCount++;
+    return 1;
+}
+
+/*
+ * Removes a label id from a set. Returns 1 if it was removed, 0 if it was not in the set.
+ */
+int GraphsInt_LabelSetRemove(LabelSet* setPtr, int id)
+{
+    int pos;
+
+    if (id < GRAPHS_LABEL_BITS) {
+        Tcl_WideUInt bit = (Tcl_WideUInt)1 << id;
+        if ((setPtr->bits & bit) == 0) {
+            return 0;
+        }
+        setPtr->bits &= ~bit;
+        return 1;
+    }
+
+    pos = LabelSetFindExtra(setPtr, id);
+    if (pos < 0) {
+        return 0;
+    }
+    memmove(setPtr->extra + pos, setPtr->extra + pos + 1, (setPtr->extraCount - pos - 1) * sizeof(int));
+    if (--setPtr->extraCount == 0) {
+        ckfree((char*)setPtr->extra);
+        setPtr->extra = NULL;
+    }
+    return 1;
+}
+
+/*
+ * Whether all labels of maskPtr are in setPtr
+ */
+int GraphsInt_LabelSetHasAll(const LabelSet* setPtr, const LabelSet* maskPtr)
+{
+    int i = 0;
+
+    if ((setPtr->bits & maskPtr->bits) != maskPtr->bits) {
+        return 0;
+    }
+    /* both extra arrays are sorted */
+    for (int k = 0; k < maskPtr->extraCount; k++) {
+        while (i < setPtr->extraCount && setPtr->extra[i] < maskPtr->extra[k]) {
+            i++;
+        }
+        if (i == setPtr->extraCount || setPtr->extra[i] != maskPtr->extra[k]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Whether any label of maskPtr is in setPtr
+ */
+int GraphsInt_LabelSetHasAny(const LabelSet* setPtr, const LabelSet* maskPtr)
+{
+    int i = 0, k = 0;
+
+    if ((setPtr->bits & maskPtr->bits) != 0) {
+        return 1;
+    }
+    while (i < setPtr->extraCount && k < maskPtr->extraCount) {
+        if (setPtr->extra[i] == maskPtr->extra[k]) {
+            return 1;
+        }
+        if (setPtr->extra[i] < maskPtr->extra[k]) {
+            i++;
+        }
+        else {
+            k++;
+        }
+    }
+    return 0;
+}
+
+static int LabelNameCompare(const void* a, const void* b)
+{
+    return strcmp(Tcl_GetString(*(Tcl_Obj* const*)a), Tcl_GetString(*(Tcl_Obj* const*)b));
+}
+
+/*
+ * Returns the labels of a set as a list, sorted by name
+ */
+Tcl_Obj* GraphsInt_LabelSetToList(const GraphState* statePtr, const LabelSet* setPtr)
+{
+    Tcl_Obj** names = (Tcl_Obj**)ckalloc((GRAPHS_LABEL_BITS + setPtr->extraCount) * sizeof(Tcl_Obj*));
+    Tcl_Obj* listObj;
+    int count = 0;
+
+    for (int id = 0; id < GRAPHS_LABEL_BITS; id++) {
+        if (setPtr->bits & ((Tcl_WideUInt)1 << id)) {
+            names[count++] = statePtr->labelNames[id];
+        }
+    }
+    for (int i = 0; i < setPtr->extraCount; i++) {
+        names[count++] = statePtr->labelNames[setPtr->extra[i]];
+    }
+    qsort(names, count, sizeof(Tcl_Obj*), LabelNameCompare);
+    listObj = Tcl_NewListObj(count, names);
+    ckfree((char*)names);
+    return listObj;
+}
+
+/*
+ * Compiles the labels of a -labels or -notlabels filter into its mask. Labels that were never used in the
+ * state cannot be on any entity; for -labels this means that nothing matches. Must be paired with
+ * GraphsInt_LabelFilterFree().
+ */
+void GraphsInt_LabelFilterInit(const GraphState* statePtr, struct LabelFilter* lblFiltPtr)
+{
+    GraphsInt_LabelSetInit(&lblFiltPtr->mask);
+    lblFiltPtr->unknown = 0;
+
+    if (lblFiltPtr->filterType != LABELS_IDX && lblFiltPtr->filterType != LABELS_NOT_IDX) {
+        return;
+    }
+    for (int i = 0; i < lblFiltPtr->objc; i++) {
+        int id = GraphsInt_LabelLookup(statePtr, lblFiltPtr->objv[i]);
+        if (id < 0) {
+            lblFiltPtr->unknown = 1;
+        }
+        else {
+            GraphsInt_LabelSetAdd(&lblFiltPtr->mask, id);
+        }
+    }
+}
+
+void GraphsInt_LabelFilterFree(struct LabelFilter* lblFiltPtr)
+{
+    GraphsInt_LabelSetFree(&lblFiltPtr->mask);
+}
+
+/*
+ * Inverted label indexes of graphs map label ids to the member nodes or edges carrying the label, see index.c
+ */
+
+/*
+ * Adds (add != 0) or removes a label of an entity to/from the indexes it is listed in. The indexes array
+ * is terminated by NULL.
+ */
+void GraphsInt_LabelIndexUpdate(Tcl_HashTable* const indexes[], int id, ClientData entity, int add)
+{
+    for (int i = 0; indexes[i] != NULL; i++) {
+        if (add) {
+            GraphsInt_IndexAdd(indexes[i], (ClientData)(size_t)id, entity);
+        }
+        else {
+            GraphsInt_IndexRemove(indexes[i], (ClientData)(size_t)id, entity);
+        }
+    }
+}
+
+/*
+ * Adds or removes all labels of an entity to/from an index, when it becomes or stops being a member of a graph
+ */
+void GraphsInt_LabelIndexUpdateAll(Tcl_HashTable* indexPtr, const LabelSet* setPtr, ClientData entity, int add)
+{
+    Tcl_HashTable* indexes[2];
+
+    indexes[0] = indexPtr;
+    indexes[1] = NULL;
+    for (int id = 0; id < GRAPHS_LABEL_BITS; id++) {
+        if (setPtr->bits & ((Tcl_WideUInt)1 << id)) {
+            GraphsInt_LabelIndexUpdate(indexes, id, entity, add);
+        }
+    }
+    for (int i = 0; i < setPtr->extraCount; i++) {
+        GraphsInt_LabelIndexUpdate(indexes, setPtr->extra[i], entity, add);
+    }
+}
+
+/*
+ * Returns the smallest set of entities of an index that carry one of the labels of a compiled -labels
+ * filter. All matches of the filter are in this set. Returns NULL if nothing can match.
+ */
+Tcl_HashTable* GraphsInt_LabelIndexCandidates(const Tcl_HashTable* indexPtr, const struct LabelFilter* lblFiltPtr)
+{
+    const LabelSet* maskPtr = &lblFiltPtr->mask;
+    Tcl_HashTable* bestPtr = NULL;
+    int count = GRAPHS_LABEL_BITS + maskPtr->extraCount;
+
+    if (lblFiltPtr->unknown) {
+        return NULL;
+    }
+    for (int i = 0; i < count; i++) {
+        int id = (i < GRAPHS_LABEL_BITS) ? i : maskPtr->extra[i - GRAPHS_LABEL_BITS];
+        Tcl_HashTable* postingPtr;
+
+        if (i < GRAPHS_LABEL_BITS && (maskPtr->bits & ((Tcl_WideUInt)1 << i)) == 0) {
+            continue;
+        }
+        postingPtr = GraphsInt_IndexGet(indexPtr, (ClientData)(size_t)id);
+        if (postingPtr == NULL) {
+            return NULL;
+        }
+        if (bestPtr == NULL || postingPtr->numEntries < bestPtr->numEntries) {
+            bestPtr = postingPtr;
+        }
+    }
+    return bestPtr;
+}
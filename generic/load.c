@@ -0,0 +1,277 @@
+/*
+ * Bulk loading of edge lists into graphs
+ *
+ * [$graph load edges ?-undirected? <tuples>] and [$graph load edges ?-undirected? -channel <chan>] create
+ * the edges of a whole edge list in one call. Each tuple is a list {from to ?weight? ?name?}, where from
+ * and to are node -names. Nodes are looked up through the name index of the graph and created in the graph
+ * if they do not exist yet. In the channel variant, every line holds one tuple; empty lines and lines
+ * starting with # are skipped.
+ *
+ * A list is loaded completely or not at all: if an edge cannot be created, e.g. because it duplicates an
+ * existing one, the edges and nodes created for the tuples before it are deleted again. From a channel the
+ * edges of the lines before a failing line are kept.
+ */
+#include "graphsInt.h"
+#include <ctype.h>
+
+typedef struct _loadTuple
+{
+    const char* from;
+    const char* to;
+    double weight;
+    const char* name;
+} LoadTuple;
+
+/*
+ * The edges and nodes created by a list load so far, to be deleted again if it fails
+ */
+typedef struct _loadUndo
+{
+    Node** nodes;
+    int nodeCount;
+    Edge** edges;
+    int edgeCount;
+} LoadUndo;
+
+/*
+ * Checks and converts the fields of a tuple. Leaves an error message in interp on failure.
+ */
+static int LoadParseTuple(Tcl_Interp* interp, int argc, const char* const argv[], LoadTuple* tuplePtr)
+{
+    if (argc < 2 || argc > 4) {
+        Tcl_SetObjResult(interp, Tcl_NewStringObj("wrong # of fields, should be \"from to ?weight? ?name?\"", -1));
+        return TCL_ERROR;
+    }
+    tuplePtr->from = argv[0];
+    tuplePtr->to = argv[1];
+    tuplePtr->weight = 0.;
+    tuplePtr->name = (argc > 3) ? argv[3] : NULL;
+    if (argc > 2 && Tcl_GetDouble(interp, argv[2], &tuplePtr->weight) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    return TCL_OK;
+}
+
+/* Looks up or creates a node, new nodes are recorded in undoPtr unless it is NULL */
+static Node* LoadNode(Graph* graphPtr, const char* name, Tcl_Interp* interp, LoadUndo* undoPtr)
+{
+    int isNew = (undoPtr != NULL && GraphsInt_IndexGet(&graphPtr->nodesByName, name) == NULL);
+    Node* nodePtr = GraphsInt_GraphGetOrCreateNode(graphPtr, name, interp);
+
+    if (nodePtr != NULL && isNew) {
+        undoPtr->nodes[undoPtr->nodeCount++] = nodePtr;
+    }
+    return nodePtr;
+}
+
+static int LoadEdge(Graph* graphPtr, int undirected, const LoadTuple* tuplePtr, Tcl_Interp* interp,
+    LoadUndo* undoPtr)
+{
+    Node* fromNodePtr = LoadNode(graphPtr, tuplePtr->from, interp, undoPtr);
+    Node* toNodePtr;
+    Edge* edgePtr;
+
+    if (fromNodePtr == NULL || (toNodePtr = LoadNode(graphPtr, tuplePtr->to, interp, undoPtr)) == NULL) {
+        return TCL_ERROR;
+    }
+    edgePtr = GraphsInt_EdgeCreateWeighted(graphPtr->statePtr, fromNodePtr, toNodePtr, undirected, tuplePtr->weight,
+        interp);
+    if (edgePtr == NULL) {
+        return TCL_ERROR;
+    }
+    if (undoPtr != NULL) {
+        undoPtr->edges[undoPtr->edgeCount++] = edgePtr;
+    }
+    if (tuplePtr->name != NULL) {
+        GraphsInt_EdgeSetName(edgePtr, tuplePtr->name);
+    }
+    return TCL_OK;
+}
+
+/* Prefixes the error message in interp with the position of the failing tuple */
+static void LoadErrorAt(Tcl_Interp* interp, const char* what, int position)
+{
+    Tcl_Obj* msg = Tcl_ObjPrintf("%s %d: %s", what, position, Tcl_GetString(Tcl_GetObjResult(interp)));
+    Tcl_SetObjResult(interp, msg);
+}
+
+/* Deletes the edges and then the nodes recorded in undoPtr, keeping the error message in interp */
+static void LoadUndoAll(LoadUndo* undoPtr, Tcl_Interp* interp)
+{
+    Tcl_Obj* msg = Tcl_GetObjResult(interp);
+
+    Tcl_IncrRefCount(msg);
+    while (undoPtr->edgeCount > 0) {
+        Graphs_EdgeDeleteEdge(undoPtr->edges[--undoPtr->edgeCount], interp);
+    }
+    while (undoPtr->nodeCount > 0) {
+        Graphs_NodeDeleteNode(undoPtr->nodes[--undoPtr->nodeCount], interp);
+    }
+    Tcl_SetObjResult(interp, msg);
+    Tcl_DecrRefCount(msg);
+}
+
+/*
+ * Loads a list of tuples. The fields of all tuples are checked before the first edge is created, the edges
+ * and nodes created are deleted again if an edge cannot be created.
+ */
+static int LoadEdgesFromList(Graph* graphPtr, int undirected, Tcl_Obj* listObj, Tcl_Interp* interp)
+{
+    Tcl_Obj** tupleObjv;
+    int tupleObjc;
+    int i;
+    LoadTuple* tuples;
+    LoadUndo undo;
+
+    if (Tcl_ListObjGetElements(interp, listObj, &tupleObjc, &tupleObjv) != TCL_OK) {
+        return TCL_ERROR;
+    }
+
+    /* + 1: nothing is allocated for an empty list otherwise */
+    tuples = (LoadTuple*)ckalloc(tupleObjc * sizeof(LoadTuple) + 1);
+    for (i = 0; i < tupleObjc; i++) {
+        Tcl_Obj** fieldObjv;
+        const char* fields[4];
+        int fieldObjc;
+
+        if (Tcl_ListObjGetElements(interp, tupleObjv[i], &fieldObjc, &fieldObjv) != TCL_OK) {
+            break;
+        }
+        for (int k = 0; k < fieldObjc && k < 4; k++) {
+            fields[k] = Tcl_GetString(fieldObjv[k]);
+        }
+        if (LoadParseTuple(interp, fieldObjc, fields, &tuples[i]) != TCL_OK) {
+            break;
+        }
+    }
+    if (i < tupleObjc) {
+        LoadErrorAt(interp, "tuple", i + 1);
+        ckfree((char*)tuples);
+        return TCL_ERROR;
+    }
+
+    undo.nodes = (Node**)ckalloc(2 * tupleObjc * sizeof(Node*) + 1);
+    undo.edges = (Edge**)ckalloc(tupleObjc * sizeof(Edge*) + 1);
+    undo.nodeCount = undo.edgeCount = 0;
+    for (i = 0; i < tupleObjc; i++) {
+        if (LoadEdge(graphPtr, undirected, &tuples[i], interp, &undo) != TCL_OK) {
+            LoadErrorAt(interp, "tuple", i + 1);
+            LoadUndoAll(&undo, interp);
+            break;
+        }
+    }
+    ckfree((char*)undo.nodes);
+    ckfree((char*)undo.edges);
+    ckfree((char*)tuples);
+    if (i < tupleObjc) {
+        return TCL_ERROR;
+    }
+    Tcl_SetObjResult(interp, Tcl_NewIntObj(tupleObjc));
+    return TCL_OK;
+}
+
+/*
+ * Loads one tuple per line from a channel. Edges of the lines before a failing line are kept.
+ */
+static int LoadEdgesFromChannel(Graph* graphPtr, int undirected, Tcl_Obj* chanObj, Tcl_Interp* interp)
+{
+    int mode, lineNo = 0, count = 0;
+    int result = TCL_OK;
+    Tcl_Channel chan = Tcl_GetChannel(interp, Tcl_GetString(chanObj), &mode);
+    Tcl_Obj* lineObj;
+
+    if (chan == NULL) {
+        return TCL_ERROR;
+    }
+    if ((mode & TCL_READABLE) == 0) {
+        Tcl_SetObjResult(interp, Tcl_ObjPrintf("channel \"%s\" wasn't opened for reading", Tcl_GetString(chanObj)));
+        return TCL_ERROR;
+    }
+
+    lineObj = Tcl_NewObj();
+    Tcl_IncrRefCount(lineObj);
+    while (result == TCL_OK) {
+        const char* line;
+        const char** fields;
+        int fieldCount;
+        LoadTuple tuple;
+
+        Tcl_SetObjLength(lineObj, 0);
+        if (Tcl_GetsObj(chan, lineObj) < 0) {
+            if (!Tcl_Eof(chan) && !Tcl_InputBlocked(chan)) {
+                Tcl_SetObjResult(interp, Tcl_ObjPrintf("error reading \"%s\": %s", Tcl_GetString(chanObj),
+                    Tcl_PosixError(interp)));
+                result = TCL_ERROR;
+            }
+            break;
+        }
+        lineNo++;
+
+        for (line = Tcl_GetString(lineObj); isspace((unsigned char)*line); line++) {
+        }
+        if (*line == '\0' || *line == '#') {
+            continue;
+        }
+
+        if (Tcl_SplitList(interp, line, &fieldCount, &fields) != TCL_OK) {
+            LoadErrorAt(interp, "line", lineNo);
+            result = TCL_ERROR;
+            break;
+        }
+        if (LoadParseTuple(interp, fieldCount, fields, &tuple) != TCL_OK
+            || LoadEdge(graphPtr, undirected, &tuple, interp, NULL) != TCL_OK) {
+            LoadErrorAt(interp, "line", lineNo);
+            result = TCL_ERROR;
+        }
+        else {
+            count++;
+        }
+        ckfree((char*)fields);
+    }
+    Tcl_DecrRefCount(lineObj);
+
+    if (result == TCL_OK) {
+        Tcl_SetObjResult(interp, Tcl_NewIntObj(count));
+    }
+    return result;
+}
+
+/*
+ * Implements [$graph load edges ?-undirected? ?-channel? <tuples | channel>]. Returns the number of
+ * edges created.
+ */
+int GraphsInt_GraphCmdLoad(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[])
+{
+    const char* what[] = { "edges", NULL };
+    const char* options[] = { "-undirected", "-channel", NULL };
+    enum optionsIx
+    {
+        UndirectedIx,
+        ChannelIx
+    };
+    int idx, undirected = 0, fromChannel = 0;
+
+    if (objc < 2) {
+        Tcl_WrongNumArgs(interp, 0, objv, "edges ?-undirected? ?-channel? <tuples | channel>");
+        return TCL_ERROR;
+    }
+    if (Tcl_GetIndexFromObj(interp, objv[0], what, "what", 0, &idx) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    for (int i = 1; i < objc - 1; i++) {
+        if (Tcl_GetIndexFromObj(interp, objv[i], options, "option", 0, &idx) != TCL_OK) {
+            return TCL_ERROR;
+        }
+        if (idx == UndirectedIx) {
+            undirected = 1;
+        }
+        else {
+            fromChannel = 1;
+        }
+    }
+
+    if (fromChannel) {
+        return LoadEdgesFromChannel(graphPtr, undirected, objv[objc - 1], interp);
+    }
+    return LoadEdgesFromList(graphPtr, undirected, objv[objc - 1], interp);
+}
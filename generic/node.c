@@ -9,8 +9,8 @@
 
 static const char* LabelFilterOptions[] = { "-name", "-labels", "-notlabels", "-all", NULL };
 
-static const char* NodeOptions[] = { "-name", "-graph", "-data", NULL };
-enum NodeOptsIdx { NameIx, GraphIx, DataIx };
+static const char* NodeOptions[] = { "-name", "-graph", "-data", "-attr", NULL };
+enum NodeOptsIdx { NameIx, GraphIx, DataIx, AttrIx };
 
 typedef enum _EdgeDirection
 {
@@ -59,11 +59,42 @@ enum NodeMarksIndex
 };
 
 
+/*
+ * Sets the -name of a node and keeps the name index of its graph up to date
+ */
+static void NodeSetName(Node* nodePtr, const char* name)
+{
+    if (nodePtr->graph != NULL) {
+        GraphsInt_IndexRemove(&nodePtr->graph->nodesByName, nodePtr->name, nodePtr);
+    }
+    GraphsInt_NameSet(&nodePtr->name, name);
+    if (nodePtr->graph != NULL) {
+        GraphsInt_IndexAdd(&nodePtr->graph->nodesByName, nodePtr->name, nodePtr);
+    }
+}
+
+/*
+ * Finds an attribute column of the graph of a node, see attrs.c
+ */
+static GraphsAttr* NodeGetAttr(Node* nodePtr, Tcl_Obj* nameObj, Tcl_Interp* interp)
+{
+    GraphsAttr* attrPtr = NULL;
+
+    if (nodePtr->graph == NULL) {
+        Tcl_SetObjResult(interp, Tcl_ObjPrintf("%s is not in a graph", nodePtr->cmdName));
+    }
+    else if ((attrPtr = GraphsInt_AttrFind(&nodePtr->graph->nodeAttrs, Tcl_GetString(nameObj))) == NULL) {
+        Tcl_SetObjResult(interp, Tcl_ObjPrintf("no node attribute \"%s\" in %s", Tcl_GetString(nameObj),
+            nodePtr->graph->cmdName));
+    }
+    return attrPtr;
+}
+
 static int NodeCmdConfigure(Node* nodePtr, Tcl_Interp *interp, int objc, Tcl_Obj * const objv[])
 {
     int i, optIdx;
 
-    if (objc < 2 || objc > 4 || (objc % 2) != 0) {
+    if (objc < 2) {
         Tcl_WrongNumArgs(interp, 0, objv, "option arg ?option arg ...?");
         return TCL_ERROR;
     }
@@ -72,9 +103,14 @@ static int NodeCmdConfigure(Node* nodePtr, Tcl_Interp *interp, int objc, Tcl_Obj
         if (Tcl_GetIndexFromObj(interp, objv[i], NodeOptions, "option", 0, &optIdx) != TCL_OK) {
             return TCL_ERROR;
         }
+        /* -attr takes a name and a value */
+        if (i + 1 >= objc || (optIdx == AttrIx && i + 2 >= objc)) {
+            Tcl_WrongNumArgs(interp, 0, objv, "option arg ?option arg ...?");
+            return TCL_ERROR;
+        }
         switch (optIdx) {
         case NameIx: {
-            sprintf(nodePtr->name, "%s", Tcl_GetString(objv[i + 1]));
+            NodeSetName(nodePtr, Tcl_GetString(objv[i + 1]));
             break;
         }
         case GraphIx: {
@@ -83,7 +119,7 @@ static int NodeCmdConfigure(Node* nodePtr, Tcl_Interp *interp, int objc, Tcl_Obj
                 Graphs_NodeAddToGraph(g, nodePtr);
                 return TCL_OK;
             }
-            g = Graphs_GraphGetByCommand(nodePtr->statePtr, Tcl_GetString(objv[i+1]));
+            g = Graphs_GraphGetFromObj(nodePtr->statePtr, objv[i+1]);
             if (g == NULL) {
                 Tcl_Obj* res = Tcl_NewStringObj("No such graph: ", -1);
                 Tcl_AppendObjToObj(res, objv[2]);
@@ -99,6 +135,14 @@ static int NodeCmdConfigure(Node* nodePtr, Tcl_Interp *interp, int objc, Tcl_Obj
             Tcl_IncrRefCount(nodePtr->data);
             break;
         }
+        case AttrIx: {
+            GraphsAttr* attrPtr = NodeGetAttr(nodePtr, objv[i + 1], interp);
+            if (attrPtr == NULL || GraphsInt_AttrSetFromObj(interp, attrPtr, nodePtr->id, objv[i + 2]) != TCL_OK) {
+                return TCL_ERROR;
+            }
+            i++;
+            break;
+        }
         default: {
             Tcl_SetObjResult(interp, Tcl_NewStringObj("Wrong options in node configure", -1));
             return TCL_ERROR;
@@ -113,14 +157,18 @@ static int NodeCmdCget(Node* nodePtr, Tcl_Interp *interp, int objc, Tcl_Obj * co
 {
     int optIdx;
 
-    if (objc != 1) {
-        Tcl_WrongNumArgs(interp, 0, objv, "option");
+    if (objc < 1 || objc > 2) {
+        Tcl_WrongNumArgs(interp, 0, objv, "option ?name?");
         return TCL_ERROR;
     }
 
     if (Tcl_GetIndexFromObj(interp, objv[0], NodeOptions, "option", 0, &optIdx) != TCL_OK) {
         return TCL_ERROR;
     }
+    if ((optIdx == AttrIx) != (objc == 2)) {
+        Tcl_WrongNumArgs(interp, 0, objv, optIdx == AttrIx ? "-attr name" : "option");
+        return TCL_ERROR;
+    }
 
     switch (optIdx) {
     case NameIx: {
@@ -131,7 +179,7 @@ static int NodeCmdCget(Node* nodePtr, Tcl_Interp *interp, int objc, Tcl_Obj * co
         if (nodePtr->graph == NULL) {
             Tcl_SetObjResult(interp, Tcl_NewStringObj("",-1));
         } else {
-            Tcl_SetObjResult(interp, Tcl_NewStringObj(nodePtr->graph->cmdName, -1));
+            Tcl_SetObjResult(interp, GraphsInt_GraphHandleObj(nodePtr->graph));
         }
         return TCL_OK;
     }
@@ -139,6 +187,14 @@ static int NodeCmdCget(Node* nodePtr, Tcl_Interp *interp, int objc, Tcl_Obj * co
         Tcl_SetObjResult(interp, nodePtr->data);
         return TCL_OK;
     }
+    case AttrIx: {
+        GraphsAttr* attrPtr = NodeGetAttr(nodePtr, objv[1], interp);
+        if (attrPtr == NULL) {
+            return TCL_ERROR;
+        }
+        Tcl_SetObjResult(interp, GraphsInt_AttrGetObj(attrPtr, nodePtr->id));
+        return TCL_OK;
+    }
     default: {
         break;
     }
@@ -153,10 +209,22 @@ static int NodeCmdCget(Node* nodePtr, Tcl_Interp *interp, int objc, Tcl_Obj * co
  */
 static int NodeCmdDestroy(Node* nodePtr, Tcl_Interp *interp, int objc, Tcl_Obj * const objv[])
 {
-    Tcl_DeleteCommandFromToken(interp, nodePtr->commandTkn);
+    Graphs_NodeDeleteNode(nodePtr, interp);
     return TCL_OK;
 }
 
+/*
+ * Labels of the node, keeps the label index of its graph up to date
+ */
+static int NodeLabelsCommand(Node* nodePtr, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[])
+{
+    Tcl_HashTable* indexes[2];
+
+    indexes[0] = (nodePtr->graph != NULL) ? &nodePtr->graph->nodesByLabel : NULL;
+    indexes[1] = NULL;
+    return GraphsInt_LabelsCommand(nodePtr->statePtr, &nodePtr->labels, indexes, nodePtr, interp, objc, objv);
+}
+
 static int NodeInfoDelta(Node* nodePtr, DeltaT deltaType, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[])
 {
     int optIdx = LABELS_ALL_IDX;
@@ -174,9 +242,12 @@ static int NodeInfoDelta(Node* nodePtr, DeltaT deltaType, Tcl_Interp* interp, in
     lblFilt.filterType = optIdx;
     lblFilt.objc = objc - 1;
     lblFilt.objv = (Tcl_Obj**) objv + 1;
-    if (GraphsInt_GetDelta(nodePtr, NULL, deltaType, lblFilt, interp, &deltaList) != TCL_OK) {
+    GraphsInt_LabelFilterInit(nodePtr->statePtr, &lblFilt);
+    if (GraphsInt_GetDelta(nodePtr, NULL, deltaType, &lblFilt, interp, &deltaList) != TCL_OK) {
+        GraphsInt_LabelFilterFree(&lblFilt);
         return TCL_ERROR;
     }
+    GraphsInt_LabelFilterFree(&lblFilt);
     Tcl_SetObjResult(interp, deltaList);
     return TCL_OK;
 }
@@ -221,7 +292,7 @@ static int NodeCmdInfo(Node* nodePtr, Tcl_Interp *interp, int objc, Tcl_Obj * co
         if (nodePtr->graph == NULL) {
             Tcl_SetObjResult(interp, Tcl_NewStringObj("",-1));
         } else {
-            Tcl_SetObjResult(interp, Tcl_NewStringObj(nodePtr->graph->cmdName, -1));
+            Tcl_SetObjResult(interp, GraphsInt_GraphHandleObj(nodePtr->graph));
         }
         return TCL_OK;
     }
@@ -230,7 +301,7 @@ static int NodeCmdInfo(Node* nodePtr, Tcl_Interp *interp, int objc, Tcl_Obj * co
             Tcl_WrongNumArgs(interp, 0, objv, "option");
             return TCL_ERROR;
         }
-        return GraphsInt_LabelsCommand(nodePtr->labels, interp, objc - 1, objv + 1);
+        return NodeLabelsCommand(nodePtr, interp, objc - 1, objv + 1);
     }
 
     }
@@ -277,93 +348,23 @@ static int NodeCmdMark(Node* nodePtr, Tcl_Interp* interp, int objc, Tcl_Obj* con
     return TCL_OK;
 }
 
-static int delta_compare_edgename(DeltaEntry* entry1, DeltaEntry* entry2) {
-    return 0;
-}
-
-static int delta_compare_nodename(DeltaEntry* entry1, DeltaEntry* entry2) {
-    return 0;
-}
-
-static int delta_compare_weight(DeltaEntry* entry1, DeltaEntry* entry2) {
-    if (entry1->edgePtr->weight < entry2->edgePtr->weight) {
-        return -1;
-    }
-    else if (entry1->edgePtr->weight > entry2->edgePtr->weight) {
-        return 1;
-    }
-    return 0;
-}
-
-static void DeltaBubbleSortSwap(DeltaEntry* entry1, DeltaEntry* entry2)
-{
-    Node* tempNode = entry1->nodePtr;
-    Edge* tempEdge = entry1->edgePtr;
-
-    entry1->nodePtr = entry2->nodePtr;
-    entry1->edgePtr = entry2->edgePtr;
-    entry2->nodePtr = tempNode;
-    entry2->edgePtr = tempEdge;
-}
-
-static void DeltaBubbleSortDesc(DeltaEntry* start, int (*compareFcn)(DeltaEntry* entry1, DeltaEntry* entry2))
-{
-    int swapped;
-    DeltaEntry* ptr1;
-    DeltaEntry* lptr = NULL;
-
-    if (start == NULL) {
-        return;
-    }
-
-    do {
-        swapped = 0;
-        ptr1 = start;
-        while (ptr1->next != lptr) {
-            if (compareFcn(ptr1, ptr1->next) < 0) {
-                DeltaBubbleSortSwap(ptr1, ptr1->next);
-                swapped = 1;
-            }
-            ptr1 = ptr1->next;
-        }
-        lptr = ptr1;
-    } while (swapped);
-}
-
-static void DeltaBubbleSortAsc(DeltaEntry* start, int (*compareFcn)(DeltaEntry* entry1, DeltaEntry* entry2))
-{
-    int swapped;
-    DeltaEntry* ptr1;
-    DeltaEntry* lptr = NULL;
-
-    if (start == NULL) {
-        return;
-    }
-
-    do {
-        swapped = 0;
-        ptr1 = start;
-        while (ptr1->next != lptr) {
-            if (compareFcn(ptr1, ptr1->next) > 0) {
-                DeltaBubbleSortSwap(ptr1, ptr1->next);
-                swapped = 1;
-            }
-            ptr1 = ptr1->next;
-        }
-        lptr = ptr1;
-    } while (swapped);
-}
-
+/*
+ * Implements [$node delta? sort ?-nodename|-edgename|-weight? ?-desc? ?-keep?]. With -keep, the list stays
+ * sorted by weight while edges are added or reweighted, until it is sorted again without -keep.
+ */
 static int NodeCmdDeltaCmdSort(Node* nodePtr, DeltaT deltaType, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[])
 {
-    const char* deltaSortOptions[] = {"-nodename", "-edgename", "-weight", "-desc", NULL };
-    enum deltaSortOptionsIndex { deltaSortNodeNameIx, deltaSortEdgeNameIx, deltaSortWeightIx, deltaSortDescIx };
+    const char* deltaSortOptions[] = {"-nodename", "-edgename", "-weight", "-desc", "-keep", NULL };
+    enum deltaSortOptionsIndex { deltaSortNodeNameIx, deltaSortEdgeNameIx, deltaSortWeightIx, deltaSortDescIx,
+        deltaSortKeepIx };
     int optIdx = 0;
-    int (*compareFcn)(DeltaEntry*, DeltaEntry*) = delta_compare_nodename;
+    GraphsDeltaCompareProc* compareFcn = GraphsInt_DeltaCompareNodeName;
     int compareOptionSet = 0;
-    void (*bubbleSortFcn)(DeltaEntry*, int (*)(DeltaEntry*, DeltaEntry*)) = DeltaBubbleSortAsc;
+    int descending = 0;
+    int keep = 0;
+    DeltaOrderT order = DELTA_ORDER_NONE;
 
-    for (size_t i = 0; i < objc;) {
+    for (size_t i = 0; i < objc; i++) {
         if (Tcl_GetIndexFromObj(interp, objv[i], deltaSortOptions, "option", 0, &optIdx) != TCL_OK) {
             return TCL_ERROR;
         }
@@ -371,65 +372,123 @@ static int NodeCmdDeltaCmdSort(Node* nodePtr, DeltaT deltaType, Tcl_Interp* inte
         switch (optIdx)
         {
         case deltaSortNodeNameIx:
-            if (compareOptionSet) {
-                Tcl_SetObjResult(interp,
-                    Tcl_NewStringObj("Only one of the compare options ?-nodename? ?-edgename? or ?-weight? can be set", -1));
-                return TCL_ERROR;
-            }
-            compareFcn = delta_compare_nodename;
-            compareOptionSet = 1;
-            i++;
-            break;
         case deltaSortEdgeNameIx:
-            if (compareOptionSet) {
-                Tcl_SetObjResult(interp,
-                    Tcl_NewStringObj("Only one of the compare options ?-nodename? ?-edgename? or ?-weight? can be set", -1));
-                return TCL_ERROR;
-            }
-            compareFcn = delta_compare_edgename;
-            compareOptionSet = 1;
-            i++;
         case deltaSortWeightIx:
             if (compareOptionSet) {
                 Tcl_SetObjResult(interp,
                     Tcl_NewStringObj("Only one of the compare options ?-nodename? ?-edgename? or ?-weight? can be set", -1));
                 return TCL_ERROR;
             }
-            compareFcn = delta_compare_weight;
+            compareFcn = (optIdx == deltaSortNodeNameIx) ? GraphsInt_DeltaCompareNodeName
+                : (optIdx == deltaSortEdgeNameIx) ? GraphsInt_DeltaCompareEdgeName : GraphsInt_DeltaCompareWeight;
             compareOptionSet = 1;
-            i++;
             break;
         case deltaSortDescIx:
-            bubbleSortFcn = DeltaBubbleSortDesc;
-            i++;
+            descending = 1;
+            break;
+        case deltaSortKeepIx:
+            keep = 1;
             break;
         default:
             break;
         }
     }
 
-    switch (deltaType)
-    {
-    case DELTA_PLUS:
-        bubbleSortFcn(nodePtr->outgoing, compareFcn);
-        break;
-    case DELTA_MINUS:
-        bubbleSortFcn(nodePtr->incoming, compareFcn);
-        break;
-    case DELTA_ALL:
-    default:
-        bubbleSortFcn(nodePtr->outgoing, compareFcn);
-        bubbleSortFcn(nodePtr->incoming, compareFcn);
+    if (keep) {
+        if (compareFcn != GraphsInt_DeltaCompareWeight) {
+            Tcl_SetObjResult(interp, Tcl_NewStringObj("-keep is only supported together with -weight", -1));
+            return TCL_ERROR;
+        }
+        order = descending ? DELTA_ORDER_WEIGHT_DESC : DELTA_ORDER_WEIGHT_ASC;
+    }
+
+    /* snapshots follow the order of the delta lists */
+    GraphsInt_SnapshotInvalidate(nodePtr->graph);
+
+    for (DeltaT listType = DELTA_PLUS; listType <= DELTA_MINUS; listType++) {
+        if (deltaType != DELTA_ALL && deltaType != listType) {
+            continue;
+        }
+        GraphsInt_DeltaSetOrder(nodePtr, listType, order);
+        if (order == DELTA_ORDER_NONE) {
+            GraphsInt_DeltaSort(nodePtr, listType, compareFcn, descending);
+        }
+    }
+
+    return TCL_OK;
+}
+
+/*
+ * Implements [$node delta? top <k> ?-weight? ?-desc? ?-name|-labels|-notlabels|-all ...?]: the k neighbors
+ * with the lightest (or with -desc the heaviest) edges, best first. -weight names the ranking key, which is
+ * also the default and for now the only one. Ties are ranked by their position in the delta list, which is
+ * not reordered.
+ */
+static int NodeCmdDeltaCmdTop(Node* nodePtr, DeltaT deltaType, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[])
+{
+    /* the label filter options follow -weight and -desc in the order of LabelFilterT */
+    static const char* deltaTopOptions[] = { "-weight", "-desc", "-name", "-labels", "-notlabels", "-all", NULL };
+    enum deltaTopOptionsIndex { deltaTopWeightIx, deltaTopDescIx, deltaTopFilterIx };
+    int k, optIdx, descending = 0, i = 1;
+    int filterIdx = LABELS_ALL_IDX;
+    int maxCount;
+    const DeltaEntry** topEntries;
+    Tcl_Obj* resultObj;
+    struct LabelFilter lblFilt;
+
+    if (objc < 1) {
+        Tcl_WrongNumArgs(interp, 0, objv, "<k> ?-weight? ?-desc? ?-name|-labels|-notlabels|-all ...?");
+        return TCL_ERROR;
+    }
+    if (Tcl_GetIntFromObj(interp, objv[0], &k) != TCL_OK) {
+        return TCL_ERROR;
+    }
+
+    for (; i < objc; i++) {
+        if (Tcl_GetIndexFromObj(interp, objv[i], deltaTopOptions, "option", 0, &optIdx) != TCL_OK) {
+            return TCL_ERROR;
+        }
+        if (optIdx == deltaTopWeightIx) {
+            continue;
+        }
+        if (optIdx == deltaTopDescIx) {
+            descending = 1;
+            continue;
+        }
+        filterIdx = optIdx - deltaTopFilterIx;
+        if (GraphsInt_CheckLabelsOptions(filterIdx, interp, objc - i, objv + i) != TCL_OK) {
+            return TCL_ERROR;
+        }
         break;
     }
-    
+
+    /* no list holds more entries than the degrees of the node add up to */
+    maxCount = nodePtr->degreeplus + nodePtr->degreeminus + nodePtr->degreeundir;
+    if (k > maxCount) {
+        k = maxCount;
+    }
+
+    lblFilt.filterType = filterIdx;
+    lblFilt.objc = objc - i - 1;
+    lblFilt.objv = (Tcl_Obj**)objv + i + 1;
+    GraphsInt_LabelFilterInit(nodePtr->statePtr, &lblFilt);
+    topEntries = (const DeltaEntry**)ckalloc((k > 0 ? k : 1) * sizeof(DeltaEntry*));
+    k = GraphsInt_DeltaTop(nodePtr, deltaType, k, descending, &lblFilt, topEntries);
+    GraphsInt_LabelFilterFree(&lblFilt);
+
+    resultObj = Tcl_NewListObj(0, NULL);
+    for (int j = 0; j < k; j++) {
+        Tcl_ListObjAppendElement(interp, resultObj, GraphsInt_NodeHandleObj(topEntries[j]->nodePtr));
+    }
+    ckfree((char*)topEntries);
+    Tcl_SetObjResult(interp, resultObj);
     return TCL_OK;
 }
 
 static int NodeCmdDelta(Node* nodePtr, DeltaT deltaType, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[])
 {
-    const char* deltaSubCommands[] = { "sort", NULL };
-    enum deltaSubCommandIndex { deltaSortIx };
+    const char* deltaSubCommands[] = { "sort", "top", NULL };
+    enum deltaSubCommandIndex { deltaSortIx, deltaTopIx };
     int cmdIdx;
 
     if (objc == 0) {
@@ -444,6 +503,8 @@ static int NodeCmdDelta(Node* nodePtr, DeltaT deltaType, Tcl_Interp* interp, int
     {
     case deltaSortIx:
         return NodeCmdDeltaCmdSort(nodePtr, deltaType, interp, objc - 1, objv + 1);
+    case deltaTopIx:
+        return NodeCmdDeltaCmdTop(nodePtr, deltaType, interp, objc - 1, objv + 1);
     default:
         break;
     }
@@ -493,7 +554,7 @@ static int NodeSubCmd(Node* nodePtr, Tcl_Obj* cmd, Tcl_Interp *interp, int objc,
     case infoIx:
         return NodeCmdInfo(nodePtr, interp, objc, objv);
     case labelsIx:
-        return GraphsInt_LabelsCommand(nodePtr->labels, interp, objc, objv);
+        return NodeLabelsCommand(nodePtr, interp, objc, objv);
     case markIx:
         return NodeCmdMark(nodePtr, interp, objc, objv);
     case deltaIx:
@@ -520,9 +581,9 @@ static int Node_NodeSubCmd(ClientData clientData, Tcl_Interp *interp, int objc,
 }
 
 /*
- * Command Delete callback
+ * Command Delete callback. Called directly for nodes that have no command.
  */
-static void NodeDestroyCmd(ClientData clientData)
+void GraphsInt_NodeDestroyCmd(ClientData clientData)
 {
     Node* nodePtr = (Node*)clientData;
     DeltaEntry* entry;
@@ -549,92 +610,183 @@ static void NodeDestroyCmd(ClientData clientData)
         Graphs_NodeDeleteFromGraph(nodePtr->graph, nodePtr);
     }
 
+    /* the edges are gone, this only releases what is left of the lists and their indexes */
+    GraphsInt_DeltaFree(nodePtr, DELTA_PLUS);
+    GraphsInt_DeltaFree(nodePtr, DELTA_MINUS);
+
     if (nodePtr->data != NULL) {
         Tcl_DecrRefCount(nodePtr->data);
     }
     
-    Tcl_DeleteHashTable(&nodePtr->labels);
+    GraphsInt_LabelSetFree(&nodePtr->labels);
+    GraphsInt_NameFree(&nodePtr->name);
 
     hashEntry = Tcl_FindHashEntry(&nodePtr->statePtr->nodes, nodePtr->cmdName);
     Tcl_DeleteHashEntry(hashEntry);
+    GraphsInt_HandleObjFree(&nodePtr->handleObj);
+    GraphsInt_IdRelease(&nodePtr->statePtr->nodeIds, nodePtr->id);
+
+    GraphsInt_PoolFree(&nodePtr->statePtr->nodePool, nodePtr);
+}
 
-    Tcl_Free((char*)nodePtr);
+
+/*
+ * Allocates a node and registers it in the state, under cmdName or, if cmdName is NULL, under a generated
+ * ::graphs::Node<n> handle. The node is in no graph and has no command yet.
+ */
+static Node* NodeAlloc(GraphState* gState, const char* cmdName)
+{
+    int new;
+    Node* nodePtr = (Node*)GraphsInt_PoolAlloc(&gState->nodePool);
+    Tcl_HashEntry* entryPtr;
+
+    nodePtr->statePtr = gState;
+    nodePtr->id = GraphsInt_IdAlloc(&gState->nodeIds, nodePtr);
+    nodePtr->commandTkn = NULL;
+    nodePtr->handleObj = NULL;
+    nodePtr->graph = NULL;
+    nodePtr->data = Tcl_NewListObj(0, NULL);
+    Tcl_IncrRefCount(nodePtr->data);
+    nodePtr->marks = 0;
+    nodePtr->degreeplus = 0;
+    nodePtr->degreeminus = 0;
+    nodePtr->degreeundir = 0;
+    nodePtr->name = NULL;
+    GraphsInt_NameFree(&nodePtr->name);
+
+    if (cmdName == NULL) {
+        do {
+            sprintf(nodePtr->cmdName, "::graphs::Node%d", gState->nodeUid++);
+        } while (Graphs_NodeGetByCommand(gState, nodePtr->cmdName) != NULL);
+    }
+    else {
+        snprintf(nodePtr->cmdName, sizeof(nodePtr->cmdName), "%s", cmdName);
+    }
+
+    nodePtr->outgoing = NULL;
+    nodePtr->incoming = NULL;
+    nodePtr->outgoingOrder = DELTA_ORDER_NONE;
+    nodePtr->incomingOrder = DELTA_ORDER_NONE;
+    nodePtr->outgoingIndex = NULL;
+    nodePtr->incomingIndex = NULL;
+    nodePtr->outgoingOrderIndex = NULL;
+    nodePtr->incomingOrderIndex = NULL;
+    GraphsInt_LabelSetInit(&nodePtr->labels);
+
+    entryPtr = Tcl_CreateHashEntry(&gState->nodes, nodePtr->cmdName, &new);
+    Tcl_SetHashValue(entryPtr, nodePtr);
+    return nodePtr;
 }
 
+/*
+ * Gives the node a command, if its graph or, for nodes without a graph, the package default says so.
+ * checkExists refuses to replace an existing command. On error the node is destroyed.
+ */
+static int NodeCreateCommand(Node* nodePtr, Tcl_Interp* interp, int checkExists)
+{
+    if (nodePtr->graph != NULL ? nodePtr->graph->createCommands : nodePtr->statePtr->createCommands) {
+        if (checkExists && GraphsInt_CheckCommandExists(interp, nodePtr->cmdName)) {
+            GraphsInt_NodeDestroyCmd((ClientData)nodePtr);
+            return TCL_ERROR;
+        }
+        nodePtr->commandTkn = Tcl_CreateObjCommand(interp, nodePtr->cmdName, Node_NodeSubCmd, nodePtr,
+            GraphsInt_NodeDestroyCmd);
+    }
+    return TCL_OK;
+}
 
+/*
+ * Implements the node command.
+ *
+ * Creates nodes with [node new ?option value ...?] and [node create <name> ?option value ...?]. Any node,
+ * but in particular nodes created without a command of their own (see the -commands option of graphs and
+ * of [::graphs::configure]), can be addressed by its handle as in [node <handle> <method> ?arg ...?].
+ */
 int GraphsInt_NodeCmd(ClientData clientData, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[])
 {
     const char* subCommands[] = { "new", "create", NULL };
     enum subCommandIdx { newIdx, createIdx };
 
     GraphState* gState = (GraphState*)clientData;
-    int new, cmdIdx;
+    int cmdIdx;
     Node* nodePtr;
-    Tcl_HashEntry* entryPtr;
 
     if (objc < 2) {
         Tcl_WrongNumArgs(interp, 0, objv, "option");
         return TCL_ERROR;
     }
 
-    if (Tcl_GetIndexFromObj(interp, objv[1], subCommands, "method", 0, &cmdIdx) != TCL_OK) {
-        return TCL_ERROR;
+    if (Tcl_GetIndexFromObj(NULL, objv[1], subCommands, "method", TCL_EXACT, &cmdIdx) != TCL_OK) {
+        nodePtr = Graphs_NodeGetFromObj(gState, objv[1]);
+        if (nodePtr != NULL) {
+            if (objc < 3) {
+                Tcl_WrongNumArgs(interp, 2, objv, "method ?arg ...?");
+                return TCL_ERROR;
+            }
+            return NodeSubCmd(nodePtr, objv[2], interp, objc - 3, objv + 3);
+        }
+        if (Tcl_GetIndexFromObj(interp, objv[1], subCommands, "method", 0, &cmdIdx) != TCL_OK) {
+            return TCL_ERROR;
+        }
     }
 
     objc -= 2;
     objv += 2;
 
-    nodePtr = (Node*)Tcl_Alloc(sizeof(Node));
-    nodePtr->statePtr = gState;
-    nodePtr->graph = NULL;
-    nodePtr->data = Tcl_NewListObj(0, NULL);
-    nodePtr->marks = 0;
-    nodePtr->degreeplus = 0;
-    nodePtr->degreeminus = 0;
-    nodePtr->degreeundir = 0;
-    sprintf(nodePtr->name, "%s", "");
-
-    switch (cmdIdx) {
-    case newIdx:
-        sprintf(nodePtr->cmdName, "::graphs::Node%d", gState->nodeUid++);
-        break;
-    case createIdx:
+    if (cmdIdx == createIdx) {
         if (objc < 1) {
-
             Tcl_WrongNumArgs(interp, 1, objv, "<name>");
-            Tcl_Free((char*)nodePtr);
             return TCL_ERROR;
         }
-        const char* cmdName = Tcl_GetString(objv[0]);
-        if (GraphsInt_CheckCommandExists(interp, cmdName)) {
-            Tcl_Free((char*)nodePtr);
+        if (Graphs_NodeGetByCommand(gState, Tcl_GetString(objv[0])) != NULL) {
+            Tcl_Obj* result = Tcl_NewObj();
+            Tcl_AppendStringsToObj(result, "Node ", Tcl_GetString(objv[0]), " already exists!", NULL);
+            Tcl_SetObjResult(interp, result);
             return TCL_ERROR;
         }
-        sprintf(nodePtr->cmdName, "%s", cmdName);
+    }
+
+    if (cmdIdx == createIdx) {
+        nodePtr = NodeAlloc(gState, Tcl_GetString(objv[0]));
         objc--;
         objv++;
-        break;
     }
-
-    nodePtr->outgoing = NULL;
-    nodePtr->incoming = NULL;
-    Tcl_InitHashTable(&nodePtr->labels, TCL_STRING_KEYS);
-
-    entryPtr = Tcl_CreateHashEntry(&gState->nodes, nodePtr->cmdName, &new);
-    Tcl_SetHashValue(entryPtr, nodePtr);
+    else {
+        nodePtr = NodeAlloc(gState, NULL);
+    }
 
     if (objc > 0) {
         if (NodeCmdConfigure(nodePtr, interp, objc, objv) != TCL_OK) {
-            NodeDestroyCmd((ClientData)nodePtr);
+            GraphsInt_NodeDestroyCmd((ClientData)nodePtr);
             return TCL_ERROR;
         }
     }
 
-    nodePtr->commandTkn = Tcl_CreateObjCommand(interp, nodePtr->cmdName, Node_NodeSubCmd, nodePtr, NodeDestroyCmd);
-    Tcl_SetObjResult(interp, Tcl_NewStringObj(nodePtr->cmdName, -1));
+    if (NodeCreateCommand(nodePtr, interp, cmdIdx == createIdx) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    Tcl_SetObjResult(interp, GraphsInt_NodeHandleObj(nodePtr));
     return TCL_OK;
 }
 
+/*
+ * Creates a node with the given -name in a graph (which may be NULL) from C, as [node new -name <name>
+ * -graph <graph>] does. Returns NULL and leaves an error in interp if the node command cannot be created.
+ */
+Node* GraphsInt_NodeCreateNode(GraphState* gState, Graph* graphPtr, const char* name, Tcl_Interp* interp)
+{
+    Node* nodePtr = NodeAlloc(gState, NULL);
+
+    NodeSetName(nodePtr, name);
+    if (graphPtr != NULL) {
+        Graphs_NodeAddToGraph(graphPtr, nodePtr);
+    }
+    if (NodeCreateCommand(nodePtr, interp, 0) != TCL_OK) {
+        return NULL;
+    }
+    return nodePtr;
+}
+
 
 void GraphsInt_NodeCleanupCmd(ClientData data)
 {
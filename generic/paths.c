@@ -0,0 +1,1208 @@
+/*
+ * Shortest paths
+ *
+ * [$graph shortestpath <source> ?-target <node>? ?options? ?filter?] runs Dijkstra's algorithm from a member
+ * node over the CSR snapshot of the graph, with an indexed 4-ary heap as priority queue. Only edges between
+ * member nodes are used. Hidden nodes and edges are skipped, and so are edges not matching the filter, one of
+ * -name <pattern>, -labels <label ...> or -notlabels <label ...>. Edge weights must not be negative, the
+ * search fails when it comes across one that is.
+ *
+ * For point to point queries -method bidirectional searches from both ends, forward over the outgoing and
+ * backward over the incoming arcs, and -method astar directs the search to the target with an estimate of the
+ * remaining distance: the euclidean distance (-metric euclidean) or the great circle distance in kilometres
+ * (-metric haversine, longitude and latitude in degrees) between the coordinates given by two node attribute
+ * columns, -coords {<x> <y>}, times -scale <factor>. The estimate is computed in C, it must not exceed the
+ * real distance for the paths found to be shortest.
+ *
+ * -method bellmanford allows negative weights. It runs the queue based variant of Bellman-Ford, or with
+ * -threads <count> on graphs with at least [::graphs::configure -parallelarcs] arcs rounds over slices of
+ * the nodes done by a fixed set of threads, and fails
+ * with the error code {GRAPHS NEGATIVE_CYCLE <edges>} if a negative cycle is reachable from the source.
+ * [$graph negativecycle] returns the edges of a negative cycle anywhere in the graph, and [$graph allpaths]
+ * the distances between all pairs of nodes with Johnson's algorithm, which runs Dijkstra's algorithm from
+ * every source after reweighting the edges with potentials from Bellman-Ford.
+ *
+ * Without -target the result is a dict of all reached nodes to a pair of their distance and the edge
+ * through which they are reached, which is empty for the source. With -target the search stops as soon as
+ * the target is settled and the result is the distance and the list of edges of the path, or an empty list
+ * if the target is not reachable.
+ */
+#include "graphsInt.h"
+#include <math.h>
+#include <string.h>
+
+#define PATHS_HEAP_ARITY 4
+
+/*
+ * The most threads used by -threads
+ */
+#define PATHS_MAX_THREADS 64
+
+/*
+ * Indexed d-ary min heap of node ids keyed by their distances. pos[] holds the heap position of each node,
+ * -1 if it is not in the heap.
+ */
+typedef struct _pathsHeap
+{
+    int* items;
+    int* pos;
+    int count;
+    const double* keys;
+} PathsHeap;
+
+static void PathsHeapInit(PathsHeap* heapPtr, int n, const double* keys)
+{
+    heapPtr->items = (int*)ckalloc(n * sizeof(int) + 1);
+    heapPtr->pos = (int*)ckalloc(n * sizeof(int) + 1);
+    memset(heapPtr->pos, -1, n * sizeof(int));
+    heapPtr->count = 0;
+    heapPtr->keys = keys;
+}
+
+static void PathsHeapFree(PathsHeap* heapPtr)
+{
+    ckfree((char*)heapPtr->items);
+    ckfree((char*)heapPtr->pos);
+}
+
+static void PathsHeapSiftUp(PathsHeap* heapPtr, int i)
+{
+    int item = heapPtr->items[i];
+    double key = heapPtr->keys[item];
+
+    while (i > 0) {
+        int parent = (i - 1) / PATHS_HEAP_ARITY;
+        int parentItem = heapPtr->items[parent];
+        if (heapPtr->keys[parentItem] <= key) {
+            break;
+        }
+        heapPtr->items[i] = parentItem;
+        heapPtr->pos[parentItem] = i;
+        i = parent;
+    }
+    heapPtr->items[i] = item;
+    heapPtr->pos[item] = i;
+}
+
+static void PathsHeapSiftDown(PathsHeap* heapPtr, int i)
+{
+    int item = heapPtr->items[i];
+    double key = heapPtr->keys[item];
+
+    for (;;) {
+        int first = i * PATHS_HEAP_ARITY + 1;
+        int last = first + PATHS_HEAP_ARITY;
+        int best = -1;
+        double bestKey = key;
+
+        if (last > heapPtr->count) {
+            last = heapPtr->count;
+        }
+        for (int c = first; c < last; c++) {
+            double childKey = heapPtr->keys[heapPtr->items[c]];
+            if (childKey < bestKey) {
+                best = c;
+                bestKey = childKey;
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+        heapPtr->items[i] = heapPtr->items[best];
+        heapPtr->pos[heapPtr->items[i]] = i;
+        i = best;
+    }
+    heapPtr->items[i] = item;
+    heapPtr->pos[item] = i;
+}
+
+/* Inserts a node or moves it up after its key was decreased */
+static void PathsHeapPush(PathsHeap* heapPtr, int item)
+{
+    int i = heapPtr->pos[item];
+
+    if (i < 0) {
+        i = heapPtr->count++;
+        heapPtr->items[i] = item;
+    }
+    PathsHeapSiftUp(heapPtr, i);
+}
+
+static int PathsHeapPop(PathsHeap* heapPtr)
+{
+    int top = heapPtr->items[0];
+
+    heapPtr->pos[top] = -1;
+    if (--heapPtr->count > 0) {
+        heapPtr->items[0] = heapPtr->items[heapPtr->count];
+        PathsHeapSiftDown(heapPtr, 0);
+    }
+    return top;
+}
+
+/*
+ * One direction of a search over a snapshot. The forward direction follows the outgoing arcs, the backward
+ * direction the incoming ones. dist[] holds the distances from the start, HUGE_VAL for unreached nodes,
+ * pred[] the arc through which a node was reached and parent[] the node it was reached from, both -1 for the
+ * start and unreached nodes. Arcs are checked for hidden marks and the filter when they are followed, so that a point to
+ * point search only costs the part of the graph it explores. negativeArc is the first arc with a negative
+ * weight the search came across, which stops it, or -1.
+ */
+typedef struct _pathsSide
+{
+    const GraphSnapshot* snapPtr;
+    const struct LabelFilter* lblFiltPtr;
+    const int* offsets;
+    const int* ends;
+    Edge* const* edges;
+    const double* weights;
+    int negativeArc;
+    double* dist;
+    int* pred;
+    int* parent;
+    PathsHeap heap;
+} PathsSide;
+
+/*
+ * Lower bound of the distance of a node to the target for A*: the euclidean or great circle distance between
+ * the coordinates of the nodes, given by two node attribute columns, times a scale factor.
+ */
+typedef struct _pathsHeuristic
+{
+    const GraphSnapshot* snapPtr;
+    const GraphsAttr* xAttr;
+    const GraphsAttr* yAttr;
+    int haversine;
+    double scale;
+    double targetX;
+    double targetY;
+} PathsHeuristic;
+
+#define PATHS_EARTH_RADIUS_KM 6371.0088
+
+static double PathsEstimate(const PathsHeuristic* hPtr, int v)
+{
+    int id = hPtr->snapPtr->nodes[v]->id;
+    double x = GraphsInt_AttrGet(hPtr->xAttr, id);
+    double y = GraphsInt_AttrGet(hPtr->yAttr, id);
+
+    if (hPtr->haversine) {
+        /* x is the longitude, y the latitude in degrees */
+        double rad = M_PI / 180.0;
+        double sinLat = sin((hPtr->targetY - y) * rad / 2.0);
+        double sinLon = sin((hPtr->targetX - x) * rad / 2.0);
+        double a = sinLat * sinLat + cos(y * rad) * cos(hPtr->targetY * rad) * sinLon * sinLon;
+        return hPtr->scale * 2.0 * PATHS_EARTH_RADIUS_KM * asin(sqrt(a < 1.0 ? a : 1.0));
+    }
+    return hPtr->scale * sqrt((hPtr->targetX - x) * (hPtr->targetX - x) + (hPtr->targetY - y) * (hPtr->targetY - y));
+}
+
+static const char* PathsOptions[] = { "-target", "-method", "-coords", "-metric", "-scale", "-threads", "-name",
+    "-labels", "-notlabels", NULL };
+enum PathsOptionIx
+{
+    PathsTargetIx,
+    PathsMethodIx,
+    PathsCoordsIx,
+    PathsMetricIx,
+    PathsScaleIx,
+    PathsThreadsIx,
+    PathsFilterIx
+};
+
+/*
+ * Prepares a search direction. The heap is keyed by keys[], or by the distances if keys is NULL.
+ */
+static void PathsSideInit(PathsSide* sidePtr, const GraphSnapshot* snapPtr, int backward,
+    const struct LabelFilter* lblFiltPtr, const double* keys)
+{
+    int n = snapPtr->nodeCount;
+
+    sidePtr->snapPtr = snapPtr;
+    sidePtr->lblFiltPtr = lblFiltPtr;
+    sidePtr->negativeArc = -1;
+    sidePtr->offsets = backward ? snapPtr->inOffsets : snapPtr->outOffsets;
+    sidePtr->ends = backward ? snapPtr->inSources : snapPtr->outTargets;
+    sidePtr->edges = backward ? snapPtr->inEdges : snapPtr->outEdges;
+    sidePtr->weights = backward ? snapPtr->inWeights : snapPtr->outWeights;
+
+    sidePtr->dist = (double*)ckalloc(n * sizeof(double) + 1);
+    sidePtr->pred = (int*)ckalloc(n * sizeof(int) + 1);
+    sidePtr->parent = (int*)ckalloc(n * sizeof(int) + 1);
+    for (int i = 0; i < n; i++) {
+        sidePtr->dist[i] = HUGE_VAL;
+        sidePtr->pred[i] = -1;
+        sidePtr->parent[i] = -1;
+    }
+    PathsHeapInit(&sidePtr->heap, n, keys != NULL ? keys : sidePtr->dist);
+}
+
+static void PathsSideFree(PathsSide* sidePtr)
+{
+    ckfree((char*)sidePtr->dist);
+    ckfree((char*)sidePtr->pred);
+    ckfree((char*)sidePtr->parent);
+    PathsHeapFree(&sidePtr->heap);
+}
+
+/* Prepares a side for the next search, after the last one emptied the heap */
+static void PathsSideReset(PathsSide* sidePtr)
+{
+    for (int i = 0; i < sidePtr->snapPtr->nodeCount; i++) {
+        sidePtr->dist[i] = HUGE_VAL;
+        sidePtr->pred[i] = -1;
+        sidePtr->parent[i] = -1;
+    }
+}
+
+/*
+ * Whether an arc may be followed: its edge and the node it leads to are not hidden and its edge matches the
+ * filter. Records the arc if it has a negative weight, which the searches here do not handle.
+ */
+static int PathsArcUsable(PathsSide* sidePtr, int k)
+{
+    const Edge* edgePtr = sidePtr->edges[k];
+    int matches = 1;
+
+    if ((edgePtr->marks & GRAPHS_MARK_HIDDEN) != 0
+        || (sidePtr->snapPtr->nodes[sidePtr->ends[k]]->marks & GRAPHS_MARK_HIDDEN) != 0) {
+        return 0;
+    }
+    if (sidePtr->lblFiltPtr->filterType != LABELS_ALL_IDX) {
+        GraphsInt_MatchesLabels(&edgePtr->labels, edgePtr->name, sidePtr->lblFiltPtr, &matches);
+    }
+    if (matches && sidePtr->weights[k] < 0.0 && sidePtr->negativeArc < 0) {
+        sidePtr->negativeArc = k;
+    }
+    return matches;
+}
+
+/*
+ * Dijkstra's algorithm from source, stops when target (if >= 0) is settled. With a heuristic this is A*: the
+ * heap is keyed by f[], the distance plus the estimate of the rest. An estimate that is not consistent only
+ * costs nodes that are settled more than once.
+ */
+static void PathsSearch(PathsSide* sidePtr, int source, int target, const PathsHeuristic* hPtr, double* f)
+{
+    PathsHeap* heapPtr = &sidePtr->heap;
+
+    sidePtr->dist[source] = 0.0;
+    if (hPtr != NULL) {
+        f[source] = PathsEstimate(hPtr, source);
+    }
+    PathsHeapPush(heapPtr, source);
+
+    while (heapPtr->count > 0 && sidePtr->negativeArc < 0) {
+        int u = PathsHeapPop(heapPtr);
+        double du = sidePtr->dist[u];
+
+        if (u == target) {
+            break;
+        }
+        for (int k = sidePtr->offsets[u]; k < sidePtr->offsets[u + 1]; k++) {
+            int v = sidePtr->ends[k];
+            double dv = du + sidePtr->weights[k];
+
+            if (dv < sidePtr->dist[v] && PathsArcUsable(sidePtr, k)) {
+                sidePtr->dist[v] = dv;
+                sidePtr->pred[v] = k;
+                sidePtr->parent[v] = u;
+                if (hPtr != NULL) {
+                    f[v] = dv + PathsEstimate(hPtr, v);
+                }
+                PathsHeapPush(heapPtr, v);
+            }
+        }
+    }
+}
+
+/*
+ * Bidirectional Dijkstra: a forward search from source and a backward search from target, each step settling
+ * the node with the smaller distance of the two. mu is the length of the shortest path through a node
+ * reached by both, the searches stop once the sum of their smallest open distances reaches it. Returns the
+ * node the shortest path goes through, -1 if target is not reachable.
+ */
+static int PathsBidirectional(PathsSide* forwardPtr, PathsSide* backwardPtr, int source, int target)
+{
+    double mu = HUGE_VAL;
+    int meet = -1;
+
+    forwardPtr->dist[source] = 0.0;
+    PathsHeapPush(&forwardPtr->heap, source);
+    backwardPtr->dist[target] = 0.0;
+    PathsHeapPush(&backwardPtr->heap, target);
+    if (source == target) {
+        return source;
+    }
+
+    while (forwardPtr->heap.count > 0 && backwardPtr->heap.count > 0 && forwardPtr->negativeArc < 0
+        && backwardPtr->negativeArc < 0) {
+        double forwardTop = forwardPtr->dist[forwardPtr->heap.items[0]];
+        double backwardTop = backwardPtr->dist[backwardPtr->heap.items[0]];
+        PathsSide* sidePtr = (forwardTop <= backwardTop) ? forwardPtr : backwardPtr;
+        const PathsSide* otherPtr = (sidePtr == forwardPtr) ? backwardPtr : forwardPtr;
+        int u;
+        double du;
+
+        if (forwardTop + backwardTop >= mu) {
+            break;
+        }
+        u = PathsHeapPop(&sidePtr->heap);
+        du = sidePtr->dist[u];
+        for (int k = sidePtr->offsets[u]; k < sidePtr->offsets[u + 1]; k++) {
+            int v = sidePtr->ends[k];
+            double dv = du + sidePtr->weights[k];
+
+            if (dv < sidePtr->dist[v] && PathsArcUsable(sidePtr, k)) {
+                sidePtr->dist[v] = dv;
+                sidePtr->pred[v] = k;
+                sidePtr->parent[v] = u;
+                PathsHeapPush(&sidePtr->heap, v);
+                if (dv + otherPtr->dist[v] < mu) {
+                    mu = dv + otherPtr->dist[v];
+                    meet = v;
+                }
+            }
+        }
+    }
+    return meet;
+}
+
+/*
+ * Returns a node on a cycle of negative weight in the graph of the parent[] pointers, -1 if there is none.
+ * visit[] is scratch space of nodeCount ints.
+ */
+static int PathsParentCycle(const PathsSide* sidePtr, int n, int* visit)
+{
+    for (int i = 0; i < n; i++) {
+        visit[i] = -1;
+    }
+    for (int i = 0; i < n; i++) {
+        int v = i;
+
+        while (v >= 0 && visit[v] < 0) {
+            visit[v] = i;
+            v = sidePtr->parent[v];
+        }
+        if (v >= 0 && visit[v] == i) {
+            /* a cycle closed on this walk, only negative ones count */
+            double weight = 0.0;
+            int c = v;
+            do {
+                weight += sidePtr->weights[sidePtr->pred[c]];
+                c = sidePtr->parent[c];
+            } while (c != v);
+            if (weight < 0.0) {
+                return v;
+            }
+        }
+    }
+    return -1;
+}
+
+/*
+ * Queue based Bellman-Ford (SPFA): only nodes whose distance decreased are scanned again, and the search ends
+ * when none is left. Every nodeCount relaxations the parent pointers are checked for a cycle, which exists
+ * once a negative cycle is reachable. Returns a node on such a cycle, or -1.
+ */
+static int PathsSpfa(PathsSide* sidePtr, const char* isStart)
+{
+    int n = sidePtr->snapPtr->nodeCount;
+    int* queue = (int*)ckalloc(n * sizeof(int) + 1);
+    int* visit = (int*)ckalloc(n * sizeof(int) + 1);
+    char* queued = (char*)ckalloc(n + 1);
+    int head = 0, count = 0, relaxations = 0, cycle = -1;
+
+    for (int i = 0; i < n; i++) {
+        queued[i] = isStart[i];
+        if (isStart[i]) {
+            sidePtr->dist[i] = 0.0;
+            queue[count++] = i;
+        }
+    }
+
+    while (count > 0 && cycle < 0) {
+        int u = queue[head];
+        double du = sidePtr->dist[u];
+
+        head = (head + 1 == n) ? 0 : head + 1;
+        count--;
+        queued[u] = 0;
+        for (int k = sidePtr->offsets[u]; k < sidePtr->offsets[u + 1]; k++) {
+            int v = sidePtr->ends[k];
+            double dv = du + sidePtr->weights[k];
+
+            if (dv < sidePtr->dist[v] && PathsArcUsable(sidePtr, k)) {
+                sidePtr->dist[v] = dv;
+                sidePtr->pred[v] = k;
+                sidePtr->parent[v] = u;
+                if (!queued[v]) {
+                    queued[v] = 1;
+                    queue[(head + count++) % n] = v;
+                }
+                if (++relaxations == n) {
+                    relaxations = 0;
+                    if ((cycle = PathsParentCycle(sidePtr, n, visit)) >= 0) {
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    ckfree((char*)queue);
+    ckfree((char*)visit);
+    ckfree(queued);
+    return cycle;
+}
+
+/*
+ * Parallel Bellman-Ford splits the nodes into slices, one per thread, and relaxes only the arcs leaving nodes
+ * whose distance went down since they were last scanned. A thread writes the distances of its own nodes
+ * only: arcs into another slice are sent as a relaxation to the thread that owns their end, which applies it
+ * in the next round. There are two sets of boxes for these, one is filled while the other is read.
+ */
+typedef struct _pathsRelax
+{
+    int node;
+    int from;
+    int arc;
+    double dist;
+} PathsRelax;
+
+typedef struct _pathsBox
+{
+    PathsRelax* items;
+    int count;
+    int size;
+} PathsBox;
+
+typedef struct _pathsRound
+{
+    PathsSide* sidePtr;
+    const char* usable;
+    const unsigned char* owner;
+    char* queued;
+    const struct _pathsRound* rounds;
+    int index;
+    int threads;
+    int parity;
+
+    /* own nodes to scan in this round, and those whose distance went down since they were scanned */
+    int* active;
+    int* next;
+    int nextCount;
+
+    /* boxes[parity * threads + t] holds the relaxations for thread t */
+    PathsBox* boxes;
+    int sent;
+    int relaxations;
+} PathsRound;
+
+/* Lowers the distance of an own node, which is then scanned in the next round */
+static void PathsRoundRelax(PathsRound* roundPtr, int v, int u, int k, double d)
+{
+    PathsSide* sidePtr = roundPtr->sidePtr;
+
+    sidePtr->dist[v] = d;
+    sidePtr->pred[v] = k;
+    sidePtr->parent[v] = u;
+    roundPtr->relaxations++;
+    if (!roundPtr->queued[v]) {
+        roundPtr->queued[v] = 1;
+        roundPtr->next[roundPtr->nextCount++] = v;
+    }
+}
+
+static void PathsRoundSend(PathsBox* boxPtr, int v, int u, int k, double d)
+{
+    PathsRelax* relaxPtr;
+
+    if (boxPtr->count == boxPtr->size) {
+        boxPtr->size = (boxPtr->size == 0) ? 64 : 2 * boxPtr->size;
+        boxPtr->items = (boxPtr->items == NULL)
+            ? (PathsRelax*)ckalloc(boxPtr->size * sizeof(PathsRelax))
+            : (PathsRelax*)ckrealloc((char*)boxPtr->items, boxPtr->size * sizeof(PathsRelax));
+    }
+    relaxPtr = &boxPtr->items[boxPtr->count++];
+    relaxPtr->node = v;
+    relaxPtr->from = u;
+    relaxPtr->arc = k;
+    relaxPtr->dist = d;
+}
+
+/*
+ * One round on a slice: applies the relaxations sent in the previous round, then scans the own nodes whose
+ * distance went down. Distances lowered during the scan are seen by the nodes scanned after them.
+ */
+static void PathsRoundRun(void* item)
+{
+    PathsRound* roundPtr = (PathsRound*)item;
+    PathsSide* sidePtr = roundPtr->sidePtr;
+    PathsBox* outBoxes = roundPtr->boxes + roundPtr->parity * roundPtr->threads;
+    int* active = roundPtr->next;
+    int activeCount;
+
+    roundPtr->relaxations = 0;
+    roundPtr->sent = 0;
+    for (int t = 0; t < roundPtr->threads; t++) {
+        const PathsBox* boxPtr = &roundPtr->rounds[t].boxes[(1 - roundPtr->parity) * roundPtr->threads
+            + roundPtr->index];
+
+        for (int i = 0; i < boxPtr->count; i++) {
+            const PathsRelax* relaxPtr = &boxPtr->items[i];
+
+            if (relaxPtr->dist < sidePtr->dist[relaxPtr->node]) {
+                PathsRoundRelax(roundPtr, relaxPtr->node, relaxPtr->from, relaxPtr->arc, relaxPtr->dist);
+            }
+        }
+        outBoxes[t].count = 0;
+    }
+
+    roundPtr->next = roundPtr->active;
+    roundPtr->active = active;
+    activeCount = roundPtr->nextCount;
+    roundPtr->nextCount = 0;
+    for (int i = 0; i < activeCount; i++) {
+        int u = active[i];
+        double du = sidePtr->dist[u];
+
+        roundPtr->queued[u] = 0;
+        for (int k = sidePtr->offsets[u]; k < sidePtr->offsets[u + 1]; k++) {
+            int v = sidePtr->ends[k];
+            double dv = du + sidePtr->weights[k];
+
+            if (!roundPtr->usable[k]) {
+                continue;
+            }
+            if (roundPtr->owner[v] != roundPtr->index) {
+                PathsRoundSend(&outBoxes[roundPtr->owner[v]], v, u, k, dv);
+                roundPtr->sent++;
+            }
+            else if (dv < sidePtr->dist[v]) {
+                PathsRoundRelax(roundPtr, v, u, k, dv);
+            }
+        }
+    }
+}
+
+/*
+ * Bellman-Ford in rounds over slices of about the same number of arcs, done by a fixed set of threads that
+ * wait for the next round between rounds. The search ends when no distance went down and no relaxation is
+ * under way. As in PathsSpfa() the parent pointers are checked for a cycle every nodeCount relaxations.
+ * Returns a node on a negative cycle, or -1.
+ */
+static int PathsBellmanFordParallel(PathsSide* sidePtr, const char* isStart, int threads)
+{
+    int n = sidePtr->snapPtr->nodeCount;
+    int m = sidePtr->offsets[n];
+    PathsRound rounds[PATHS_MAX_THREADS];
+    GraphsWorkers* workers;
+    int* visit = (int*)ckalloc(n * sizeof(int) + 1);
+    char* usable = (char*)ckalloc(m + 1);
+    unsigned char* owner = (unsigned char*)ckalloc(n + 1);
+    char* queued = (char*)ckalloc(n + 1);
+    int cycle = -1, pending = 1, relaxations = 0;
+
+    /* the filter is evaluated up front, the threads then only read flags */
+    for (int k = 0; k < m; k++) {
+        usable[k] = PathsArcUsable(sidePtr, k);
+    }
+    memset(queued, 0, n);
+
+    for (int t = 0, v = 0; t < threads; t++) {
+        PathsRound* roundPtr = &rounds[t];
+        int from = v;
+
+        while (v < n && (t == threads - 1 || sidePtr->offsets[v] < (Tcl_WideInt)m * (t + 1) / threads)) {
+            owner[v++] = t;
+        }
+        roundPtr->sidePtr = sidePtr;
+        roundPtr->usable = usable;
+        roundPtr->owner = owner;
+        roundPtr->queued = queued;
+        roundPtr->rounds = rounds;
+        roundPtr->index = t;
+        roundPtr->threads = threads;
+        roundPtr->active = (int*)ckalloc((v - from) * sizeof(int) + 1);
+        roundPtr->next = (int*)ckalloc((v - from) * sizeof(int) + 1);
+        roundPtr->nextCount = 0;
+        roundPtr->boxes = (PathsBox*)ckalloc(2 * threads * sizeof(PathsBox));
+        memset(roundPtr->boxes, 0, 2 * threads * sizeof(PathsBox));
+    }
+    for (int v = 0; v < n; v++) {
+        if (isStart[v]) {
+            PathsRound* roundPtr = &rounds[owner[v]];
+
+            sidePtr->dist[v] = 0.0;
+            queued[v] = 1;
+            roundPtr->next[roundPtr->nextCount++] = v;
+        }
+    }
+
+    workers = GraphsInt_WorkersStart(threads, PathsRoundRun, rounds, sizeof(PathsRound));
+    for (int parity = 0; pending > 0 && cycle < 0; parity = 1 - parity) {
+        for (int t = 0; t < threads; t++) {
+            rounds[t].parity = parity;
+        }
+        GraphsInt_WorkersRun(workers);
+        pending = 0;
+        for (int t = 0; t < threads; t++) {
+            pending += rounds[t].nextCount + rounds[t].sent;
+            relaxations += rounds[t].relaxations;
+        }
+        if (relaxations >= n) {
+            relaxations = 0;
+            cycle = PathsParentCycle(sidePtr, n, visit);
+        }
+    }
+    GraphsInt_WorkersStop(workers);
+
+    for (int t = 0; t < threads; t++) {
+        for (int b = 0; b < 2 * threads; b++) {
+            if (rounds[t].boxes[b].items != NULL) {
+                ckfree((char*)rounds[t].boxes[b].items);
+            }
+        }
+        ckfree((char*)rounds[t].boxes);
+        ckfree((char*)rounds[t].active);
+        ckfree((char*)rounds[t].next);
+    }
+    ckfree((char*)visit);
+    ckfree(usable);
+    ckfree((char*)owner);
+    ckfree(queued);
+    return cycle;
+}
+
+/*
+ * Bellman-Ford from the nodes flagged in isStart, which all get distance 0, so that with all nodes flagged
+ * the distances are potentials for Johnson's reweighting. The search is done in parallel rounds if more
+ * than one thread is left after PathsThreads(). Returns a node on a negative cycle, or -1.
+ */
+static int PathsBellmanFord(PathsSide* sidePtr, const char* isStart, int threads)
+{
+    if (threads > 1) {
+        return PathsBellmanFordParallel(sidePtr, isStart, threads);
+    }
+    return PathsSpfa(sidePtr, isStart);
+}
+
+/* Returns the member node given by a handle, with its snapshot id */
+static int PathsGetNode(Graph* graphPtr, const GraphSnapshot* snapPtr, Tcl_Interp* interp, Tcl_Obj* nodeObj,
+    int* idPtr)
+{
+    Node* nodePtr = Graphs_NodeGetFromObj(graphPtr->statePtr, nodeObj);
+
+    if (nodePtr == NULL || (*idPtr = GraphsInt_SnapshotNodeId(snapPtr, nodePtr)) < 0) {
+        Tcl_SetObjResult(interp, Tcl_ObjPrintf("%s is not a node of %s", Tcl_GetString(nodeObj),
+            graphPtr->cmdName));
+        return TCL_ERROR;
+    }
+    return TCL_OK;
+}
+
+/* Returns the node attribute column with the given name */
+static int PathsGetAttr(Graph* graphPtr, Tcl_Interp* interp, Tcl_Obj* nameObj, const GraphsAttr** attrPtr)
+{
+    if ((*attrPtr = GraphsInt_AttrFind(&graphPtr->nodeAttrs, Tcl_GetString(nameObj))) == NULL) {
+        Tcl_SetObjResult(interp, Tcl_ObjPrintf("no node attribute \"%s\" in %s", Tcl_GetString(nameObj),
+            graphPtr->cmdName));
+        return TCL_ERROR;
+    }
+    return TCL_OK;
+}
+
+/* The dict of nodes reached by a search to {distance edge} */
+static Tcl_Obj* PathsTreeObj(const GraphSnapshot* snapPtr, const PathsSide* sidePtr)
+{
+    Tcl_Obj* result = Tcl_NewListObj(0, NULL);
+
+    for (int i = 0; i < snapPtr->nodeCount; i++) {
+        Tcl_Obj* pair[2];
+
+        if (sidePtr->dist[i] == HUGE_VAL) {
+            continue;
+        }
+        pair[0] = Tcl_NewDoubleObj(sidePtr->dist[i]);
+        pair[1] = (sidePtr->pred[i] < 0) ? Tcl_NewObj() : GraphsInt_EdgeHandleObj(sidePtr->edges[sidePtr->pred[i]]);
+        Tcl_ListObjAppendElement(NULL, result, GraphsInt_NodeHandleObj(snapPtr->nodes[i]));
+        Tcl_ListObjAppendElement(NULL, result, Tcl_NewListObj(2, pair));
+    }
+    return result;
+}
+
+/*
+ * The length and the edges of the path from the start of the forward search to meet, continued by the path
+ * from meet to the start of the backward search if there is one. An empty list if meet is -1.
+ */
+static Tcl_Obj* PathsPathObj(const PathsSide* forwardPtr, const PathsSide* backwardPtr, int meet)
+{
+    Tcl_Obj* pair[2];
+    Tcl_Obj** edges;
+    int forwardCount = 0, backwardCount = 0, i;
+
+    if (meet < 0) {
+        return Tcl_NewObj();
+    }
+    for (int v = meet; forwardPtr->pred[v] >= 0; v = forwardPtr->parent[v]) {
+        forwardCount++;
+    }
+    for (int v = meet; backwardPtr != NULL && backwardPtr->pred[v] >= 0; v = backwardPtr->parent[v]) {
+        backwardCount++;
+    }
+    edges = (Tcl_Obj**)ckalloc((forwardCount + backwardCount) * sizeof(Tcl_Obj*) + 1);
+    i = forwardCount;
+    for (int v = meet; forwardPtr->pred[v] >= 0; v = forwardPtr->parent[v]) {
+        edges[--i] = GraphsInt_EdgeHandleObj(forwardPtr->edges[forwardPtr->pred[v]]);
+    }
+    i = forwardCount;
+    for (int v = meet; backwardPtr != NULL && backwardPtr->pred[v] >= 0; v = backwardPtr->parent[v]) {
+        edges[i++] = GraphsInt_EdgeHandleObj(backwardPtr->edges[backwardPtr->pred[v]]);
+    }
+    pair[0] = Tcl_NewDoubleObj(forwardPtr->dist[meet] + (backwardPtr != NULL ? backwardPtr->dist[meet] : 0.0));
+    pair[1] = Tcl_NewListObj(forwardCount + backwardCount, edges);
+    ckfree((char*)edges);
+    return Tcl_NewListObj(2, pair);
+}
+
+/* The edges of the cycle of parent pointers through node c, in the direction of the cycle */
+static Tcl_Obj* PathsCycleObj(const PathsSide* sidePtr, int c)
+{
+    Tcl_Obj** edges;
+    Tcl_Obj* result;
+    int count = 0, v = c;
+
+    do {
+        count++;
+        v = sidePtr->parent[v];
+    } while (v != c);
+    edges = (Tcl_Obj**)ckalloc(count * sizeof(Tcl_Obj*));
+    for (int i = count; i > 0; v = sidePtr->parent[v]) {
+        edges[--i] = GraphsInt_EdgeHandleObj(sidePtr->edges[sidePtr->pred[v]]);
+    }
+    result = Tcl_NewListObj(count, edges);
+    ckfree((char*)edges);
+    return result;
+}
+
+/* Leaves the error for a negative cycle through node c, with its edges in the error code */
+static int PathsNegativeCycleError(Tcl_Interp* interp, const PathsSide* sidePtr, int c)
+{
+    Tcl_Obj* code[3];
+
+    code[0] = Tcl_NewStringObj("GRAPHS", -1);
+    code[1] = Tcl_NewStringObj("NEGATIVE_CYCLE", -1);
+    code[2] = PathsCycleObj(sidePtr, c);
+    Tcl_SetObjResult(interp, Tcl_NewStringObj("negative cycle", -1));
+    Tcl_SetObjErrorCode(interp, Tcl_NewListObj(3, code));
+    return TCL_ERROR;
+}
+
+/*
+ * Initializes a label filter on edges from the filter arguments of a command, objc may be 0 for no filter.
+ * Also used by apsp.c.
+ */
+int GraphsInt_PathsFilterInit(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[],
+    struct LabelFilter* lblFiltPtr)
+{
+    static const char* filterOptions[] = { "-name", "-labels", "-notlabels", NULL };
+    int optIdx = LABELS_ALL_IDX;
+
+    if (objc > 0) {
+        if (Tcl_GetIndexFromObj(interp, objv[0], filterOptions, "option", 0, &optIdx) != TCL_OK
+            || GraphsInt_CheckLabelsOptions(optIdx, interp, objc, objv) != TCL_OK) {
+            return TCL_ERROR;
+        }
+    }
+    lblFiltPtr->filterType = optIdx;
+    lblFiltPtr->objc = objc - 1;
+    lblFiltPtr->objv = objv + 1;
+    GraphsInt_LabelFilterInit(graphPtr->statePtr, lblFiltPtr);
+    return TCL_OK;
+}
+
+/* The threads used on a snapshot: one if it has less arcs than [::graphs::configure -parallelarcs] */
+static int PathsThreads(const Graph* graphPtr, const GraphSnapshot* snapPtr, int threads)
+{
+    return (snapPtr->edgeCount < graphPtr->statePtr->parallelArcs) ? 1 : threads;
+}
+
+/* Reads the value of -threads, also used by bfs.c */
+int GraphsInt_PathsGetThreads(Tcl_Interp* interp, Tcl_Obj* valueObj, int* threadsPtr)
+{
+    if (Tcl_GetIntFromObj(interp, valueObj, threadsPtr) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    if (*threadsPtr < 1 || *threadsPtr > PATHS_MAX_THREADS) {
+        Tcl_SetObjResult(interp, Tcl_ObjPrintf("-threads must be between 1 and %d", PATHS_MAX_THREADS));
+        return TCL_ERROR;
+    }
+    return TCL_OK;
+}
+
+/*
+ * Implements [$graph shortestpath <source> ?-target <node>? ?-method dijkstra|bidirectional|astar|bellmanford?
+ * ?-coords {<x> <y>}? ?-metric euclidean|haversine? ?-scale <factor>? ?-threads <count>? ?filter?]
+ */
+int GraphsInt_GraphCmdShortestPath(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[])
+{
+    static const char* methods[] = { "dijkstra", "bidirectional", "astar", "bellmanford", NULL };
+    enum MethodIx
+    {
+        DijkstraIx,
+        BidirectionalIx,
+        AstarIx,
+        BellmanFordIx
+    };
+    static const char* metrics[] = { "euclidean", "haversine", NULL };
+    const GraphSnapshot* snapPtr;
+    struct LabelFilter lblFilt;
+    PathsSide forward, backward;
+    PathsHeuristic heuristic;
+    Tcl_Obj** coords = NULL;
+    double* f = NULL;
+    int source, target = -1, method = DijkstraIx, coordCount, threads = 1, result;
+
+    if (objc < 1) {
+        Tcl_WrongNumArgs(interp, 0, objv, "<source> ?-target <node>? ?-method dijkstra|bidirectional|astar|"
+            "bellmanford? ?-coords {<x> <y>}? ?-metric euclidean|haversine? ?-scale <factor>? ?-threads <count>? "
+            "?filter?");
+        return TCL_ERROR;
+    }
+    snapPtr = Graphs_GraphGetSnapshot(graphPtr);
+    if (PathsGetNode(graphPtr, snapPtr, interp, objv[0], &source) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    heuristic.snapPtr = snapPtr;
+    heuristic.haversine = 0;
+    heuristic.scale = 1.0;
+    objc--;
+    objv++;
+
+    while (objc > 0) {
+        int optIdx;
+
+        if (Tcl_GetIndexFromObj(interp, objv[0], PathsOptions, "option", 0, &optIdx) != TCL_OK) {
+            return TCL_ERROR;
+        }
+        if (optIdx >= PathsFilterIx) {
+            break;
+        }
+        if (objc < 2) {
+            Tcl_SetObjResult(interp, Tcl_ObjPrintf("missing value for option %s", PathsOptions[optIdx]));
+            return TCL_ERROR;
+        }
+        switch (optIdx) {
+        case PathsTargetIx:
+            result = PathsGetNode(graphPtr, snapPtr, interp, objv[1], &target);
+            break;
+        case PathsMethodIx:
+            result = Tcl_GetIndexFromObj(interp, objv[1], methods, "method", 0, &method);
+            break;
+        case PathsCoordsIx:
+            result = Tcl_ListObjGetElements(interp, objv[1], &coordCount, &coords);
+            if (result == TCL_OK && coordCount != 2) {
+                Tcl_SetObjResult(interp, Tcl_NewStringObj("-coords needs the names of two node attributes", -1));
+                result = TCL_ERROR;
+            }
+            if (result == TCL_OK) {
+                result = PathsGetAttr(graphPtr, interp, coords[0], &heuristic.xAttr);
+            }
+            if (result == TCL_OK) {
+                result = PathsGetAttr(graphPtr, interp, coords[1], &heuristic.yAttr);
+            }
+            break;
+        case PathsMetricIx:
+            result = Tcl_GetIndexFromObj(interp, objv[1], metrics, "metric", 0, &heuristic.haversine);
+            break;
+        case PathsScaleIx:
+            result = Tcl_GetDoubleFromObj(interp, objv[1], &heuristic.scale);
+            break;
+        case PathsThreadsIx:
+            result = GraphsInt_PathsGetThreads(interp, objv[1], &threads);
+            break;
+        default:
+            result = TCL_ERROR;
+            break;
+        }
+        if (result != TCL_OK) {
+            return TCL_ERROR;
+        }
+        objc -= 2;
+        objv += 2;
+    }
+    threads = PathsThreads(graphPtr, snapPtr, threads);
+    if ((method == BidirectionalIx || method == AstarIx) && target < 0) {
+        Tcl_SetObjResult(interp, Tcl_ObjPrintf("-method %s needs a -target", methods[method]));
+        return TCL_ERROR;
+    }
+    if (method == AstarIx && coords == NULL) {
+        Tcl_SetObjResult(interp, Tcl_NewStringObj("-method astar needs -coords {<x> <y>}", -1));
+        return TCL_ERROR;
+    }
+
+    if (GraphsInt_PathsFilterInit(graphPtr, interp, objc, objv, &lblFilt) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    result = TCL_OK;
+
+    if (method == AstarIx) {
+        int targetId = snapPtr->nodes[target]->id;
+        f = (double*)ckalloc(snapPtr->nodeCount * sizeof(double) + 1);
+        heuristic.targetX = GraphsInt_AttrGet(heuristic.xAttr, targetId);
+        heuristic.targetY = GraphsInt_AttrGet(heuristic.yAttr, targetId);
+    }
+    PathsSideInit(&forward, snapPtr, 0, &lblFilt, f);
+    if (method == BidirectionalIx) {
+        PathsSideInit(&backward, snapPtr, 1, &lblFilt, NULL);
+    }
+
+    switch (method) {
+    case BidirectionalIx:
+        Tcl_SetObjResult(interp, PathsPathObj(&forward, &backward,
+            PathsBidirectional(&forward, &backward, source, target)));
+        if (backward.negativeArc >= 0) {
+            forward.negativeArc = backward.negativeArc;
+            forward.edges = backward.edges;
+        }
+        break;
+    case AstarIx:
+        PathsSearch(&forward, source, target, &heuristic, f);
+        Tcl_SetObjResult(interp, PathsPathObj(&forward, NULL, forward.dist[target] == HUGE_VAL ? -1 : target));
+        break;
+    case BellmanFordIx: {
+        char* isStart = (char*)ckalloc(snapPtr->nodeCount + 1);
+        int cycle;
+
+        memset(isStart, 0, snapPtr->nodeCount);
+        isStart[source] = 1;
+        cycle = PathsBellmanFord(&forward, isStart, threads);
+        ckfree(isStart);
+        forward.negativeArc = -1;
+        if (cycle >= 0) {
+            result = PathsNegativeCycleError(interp, &forward, cycle);
+            break;
+        }
+        Tcl_SetObjResult(interp, target < 0 ? PathsTreeObj(snapPtr, &forward)
+            : PathsPathObj(&forward, NULL, forward.dist[target] == HUGE_VAL ? -1 : target));
+        break;
+    }
+    default:
+        PathsSearch(&forward, source, target, NULL, NULL);
+        Tcl_SetObjResult(interp, target < 0 ? PathsTreeObj(snapPtr, &forward)
+            : PathsPathObj(&forward, NULL, forward.dist[target] == HUGE_VAL ? -1 : target));
+        break;
+    }
+    if (forward.negativeArc >= 0) {
+        Tcl_SetObjResult(interp, Tcl_ObjPrintf("edge %s has a negative weight",
+            forward.edges[forward.negativeArc]->cmdName));
+        result = TCL_ERROR;
+    }
+    GraphsInt_LabelFilterFree(&lblFilt);
+
+    PathsSideFree(&forward);
+    if (method == BidirectionalIx) {
+        PathsSideFree(&backward);
+    }
+    if (f != NULL) {
+        ckfree((char*)f);
+    }
+    return result;
+}
+
+static const char* PathsAllOptions[] = { "-sources", "-threads", "-name", "-labels", "-notlabels", NULL };
+enum PathsAllOptionIx
+{
+    PathsAllSourcesIx,
+    PathsAllThreadsIx,
+    PathsAllFilterIx
+};
+
+/*
+ * Parses the options of [$graph negativecycle] and [$graph allpaths]. Leaves objc and objv at the filter.
+ * The sources are flagged in a new array of nodeCount chars, which must be freed with ckfree().
+ */
+static int PathsAllParse(Graph* graphPtr, const GraphSnapshot* snapPtr, Tcl_Interp* interp, int* objcPtr,
+    Tcl_Obj* const** objvPtr, int allowSources, char** isSourcePtr, int* threadsPtr)
+{
+    int objc = *objcPtr;
+    Tcl_Obj* const* objv = *objvPtr;
+    Tcl_Obj* sourcesObj = NULL;
+    char* isSource;
+
+    while (objc > 0) {
+        int optIdx;
+
+        if (Tcl_GetIndexFromObj(interp, objv[0], PathsAllOptions, "option", 0, &optIdx) != TCL_OK) {
+            return TCL_ERROR;
+        }
+        if (optIdx >= PathsAllFilterIx) {
+            break;
+        }
+        if (optIdx == PathsAllSourcesIx && !allowSources) {
+            Tcl_SetObjResult(interp, Tcl_NewStringObj("option -sources does not apply", -1));
+            return TCL_ERROR;
+        }
+        if (objc < 2) {
+            Tcl_SetObjResult(interp, Tcl_ObjPrintf("missing value for option %s", PathsAllOptions[optIdx]));
+            return TCL_ERROR;
+        }
+        if (optIdx == PathsAllSourcesIx) {
+            sourcesObj = objv[1];
+        }
+        else if (GraphsInt_PathsGetThreads(interp, objv[1], threadsPtr) != TCL_OK) {
+            return TCL_ERROR;
+        }
+        objc -= 2;
+        objv += 2;
+    }
+    *threadsPtr = PathsThreads(graphPtr, snapPtr, *threadsPtr);
+
+    isSource = (char*)ckalloc(snapPtr->nodeCount + 1);
+    for (int i = 0; i < snapPtr->nodeCount; i++) {
+        isSource[i] = (sourcesObj == NULL && (snapPtr->nodes[i]->marks & GRAPHS_MARK_HIDDEN) == 0);
+    }
+    if (sourcesObj != NULL) {
+        Tcl_Obj** sources;
+        int count;
+
+        if (Tcl_ListObjGetElements(interp, sourcesObj, &count, &sources) != TCL_OK) {
+            ckfree(isSource);
+            return TCL_ERROR;
+        }
+        for (int i = 0; i < count; i++) {
+            int id;
+            if (PathsGetNode(graphPtr, snapPtr, interp, sources[i], &id) != TCL_OK) {
+                ckfree(isSource);
+                return TCL_ERROR;
+            }
+            isSource[id] = 1;
+        }
+    }
+    *isSourcePtr = isSource;
+    *objcPtr = objc;
+    *objvPtr = objv;
+    return TCL_OK;
+}
+
+/*
+ * Runs Bellman-Ford from all nodes at once. Returns a node on a negative cycle, or -1 with the potentials of
+ * Johnson's reweighting in the distances of the side.
+ */
+static int PathsPotentials(PathsSide* sidePtr, int threads)
+{
+    int n = sidePtr->snapPtr->nodeCount;
+    char* all = (char*)ckalloc(n + 1);
+    int cycle;
+
+    memset(all, 1, n);
+    cycle = PathsBellmanFord(sidePtr, all, threads);
+    ckfree(all);
+    return cycle;
+}
+
+/*
+ * Implements [$graph negativecycle ?-threads <count>? ?filter?]: the edges of a cycle of negative weight, an
+ * empty list if there is none.
+ */
+int GraphsInt_GraphCmdNegativeCycle(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[])
+{
+    const GraphSnapshot* snapPtr = Graphs_GraphGetSnapshot(graphPtr);
+    struct LabelFilter lblFilt;
+    PathsSide side;
+    char* isSource;
+    int threads = 1, cycle;
+
+    if (PathsAllParse(graphPtr, snapPtr, interp, &objc, &objv, 0, &isSource, &threads) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    ckfree(isSource);
+    if (GraphsInt_PathsFilterInit(graphPtr, interp, objc, objv, &lblFilt) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    PathsSideInit(&side, snapPtr, 0, &lblFilt, NULL);
+    cycle = PathsPotentials(&side, threads);
+    Tcl_SetObjResult(interp, cycle < 0 ? Tcl_NewObj() : PathsCycleObj(&side, cycle));
+    PathsSideFree(&side);
+    GraphsInt_LabelFilterFree(&lblFilt);
+    return TCL_OK;
+}
+
+/*
+ * Implements [$graph allpaths ?-sources <nodes>? ?-threads <count>? ?filter?]: a dict of the sources, all
+ * nodes that are not hidden by default, to dicts of the nodes they reach to their distance.
+ *
+ * Johnson's algorithm: Bellman-Ford from all nodes at once gives potentials h, with which the weights
+ * w(u,v) + h(u) - h(v) are not negative, so that every source is done with Dijkstra's algorithm. The
+ * distances are shifted back by h(v) - h(u) afterwards.
+ */
+int GraphsInt_GraphCmdAllPaths(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[])
+{
+    const GraphSnapshot* snapPtr = Graphs_GraphGetSnapshot(graphPtr);
+    int n = snapPtr->nodeCount;
+    struct LabelFilter lblFilt;
+    PathsSide side;
+    Tcl_Obj* result;
+    char* isSource;
+    double *potential, *reweighted;
+    int threads = 1, cycle;
+
+    if (PathsAllParse(graphPtr, snapPtr, interp, &objc, &objv, 1, &isSource, &threads) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    if (GraphsInt_PathsFilterInit(graphPtr, interp, objc, objv, &lblFilt) != TCL_OK) {
+        ckfree(isSource);
+        return TCL_ERROR;
+    }
+
+    PathsSideInit(&side, snapPtr, 0, &lblFilt, NULL);
+    if ((cycle = PathsPotentials(&side, threads)) >= 0) {
+        PathsNegativeCycleError(interp, &side, cycle);
+        PathsSideFree(&side);
+        GraphsInt_LabelFilterFree(&lblFilt);
+        ckfree(isSource);
+        return TCL_ERROR;
+    }
+    potential = (double*)ckalloc(n * sizeof(double) + 1);
+    memcpy(potential, side.dist, n * sizeof(double));
+    PathsSideFree(&side);
+
+    /* rounding may leave tiny negative weights on arcs of shortest paths */
+    reweighted = (double*)ckalloc(snapPtr->edgeCount * sizeof(double) + 1);
+    for (int u = 0; u < n; u++) {
+        for (int k = snapPtr->outOffsets[u]; k < snapPtr->outOffsets[u + 1]; k++) {
+            double w = snapPtr->outWeights[k] + potential[u] - potential[snapPtr->outTargets[k]];
+            reweighted[k] = (w > 0.0) ? w : 0.0;
+        }
+    }
+
+    PathsSideInit(&side, snapPtr, 0, &lblFilt, NULL);
+    side.weights = reweighted;
+    result = Tcl_NewListObj(0, NULL);
+    for (int s = 0; s < n; s++) {
+        Tcl_Obj* targets;
+
+        if (!isSource[s]) {
+            continue;
+        }
+        PathsSideReset(&side);
+        PathsSearch(&side, s, -1, NULL, NULL);
+        targets = Tcl_NewListObj(0, NULL);
+        for (int v = 0; v < n; v++) {
+            if (side.dist[v] != HUGE_VAL) {
+                Tcl_ListObjAppendElement(NULL, targets, GraphsInt_NodeHandleObj(snapPtr->nodes[v]));
+                Tcl_ListObjAppendElement(NULL, targets,
+                    Tcl_NewDoubleObj(side.dist[v] - potential[s] + potential[v]));
+            }
+        }
+        Tcl_ListObjAppendElement(NULL, result, GraphsInt_NodeHandleObj(snapPtr->nodes[s]));
+        Tcl_ListObjAppendElement(NULL, result, targets);
+    }
+    PathsSideFree(&side);
+    GraphsInt_LabelFilterFree(&lblFilt);
+    ckfree((char*)potential);
+    ckfree((char*)reweighted);
+    ckfree(isSource);
+    Tcl_SetObjResult(interp, result);
+    return TCL_OK;
+}
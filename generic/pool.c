@@ -0,0 +1,198 @@
+/*
+ * Slab allocator for the fixed size entities (nodes, edges and delta entries)
+ *
+ * Each pool hands out blocks of one size. Blocks are carved from slabs of GRAPHS_POOL_SLAB_BLOCKS blocks
+ * that are allocated in one piece, freed blocks are recycled through a free list. Freeing a block never
+ * releases memory, so that creating and deleting entities in a loop does not allocate a slab every time.
+ * GraphsInt_PoolTrim() gives back the slabs without blocks in use but one, it is called after a graph was
+ * destroyed with all its nodes. All slabs are released in bulk when the state is deleted.
+ */
+#include "graphsInt.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+/* Blocks are aligned like the slab header, which holds a pointer and a double */
+typedef union _poolAlign
+{
+    void* ptr;
+    double d;
+} PoolAlign;
+
+#define POOL_ALIGN(size) (((size) + sizeof(PoolAlign) - 1) & ~(sizeof(PoolAlign) - 1))
+
+void GraphsInt_PoolInit(GraphsPool* poolPtr, size_t blockSize)
+{
+    poolPtr->blockSize = POOL_ALIGN(blockSize < sizeof(void*) ? sizeof(void*) : blockSize);
+    poolPtr->slabs = NULL;
+    poolPtr->freeList = NULL;
+    poolPtr->slabCount = 0;
+    poolPtr->usedCount = 0;
+    poolPtr->freeCount = 0;
+}
+
+static void PoolAddSlab(GraphsPool* poolPtr)
+{
+    char* slab = ckalloc(POOL_ALIGN(sizeof(void*)) + GRAPHS_POOL_SLAB_BLOCKS * poolPtr->blockSize);
+    char* block = slab + POOL_ALIGN(sizeof(void*));
+
+    /* the first word of a slab links the slabs of the pool */
+    *(void**)slab = poolPtr->slabs;
+    poolPtr->slabs = slab;
+    poolPtr->slabCount++;
+
+    for (int i = 0; i < GRAPHS_POOL_SLAB_BLOCKS; i++, block += poolPtr->blockSize) {
+        *(void**)block = poolPtr->freeList;
+        poolPtr->freeList = block;
+    }
+    poolPtr->freeCount += GRAPHS_POOL_SLAB_BLOCKS;
+}
+
+void* GraphsInt_PoolAlloc(GraphsPool* poolPtr)
+{
+    void* block;
+
+    if (poolPtr->freeList == NULL) {
+        PoolAddSlab(poolPtr);
+    }
+    block = poolPtr->freeList;
+    poolPtr->freeList = *(void**)block;
+    poolPtr->freeCount--;
+    poolPtr->usedCount++;
+    return block;
+}
+
+void GraphsInt_PoolFree(GraphsPool* poolPtr, void* block)
+{
+    *(void**)block = poolPtr->freeList;
+    poolPtr->freeList = block;
+    poolPtr->freeCount++;
+    poolPtr->usedCount--;
+}
+
+static int PoolCompareSlabs(const void* a, const void* b)
+{
+    uintptr_t slab1 = (uintptr_t)*(char* const*)a;
+    uintptr_t slab2 = (uintptr_t)*(char* const*)b;
+    return (slab1 > slab2) - (slab1 < slab2);
+}
+
+/* The index of the slab in the sorted slabs array that holds a block */
+static int PoolFindSlab(char** slabs, int count, const char* block)
+{
+    int low = 0, high = count - 1;
+
+    while (low < high) {
+        int mid = (low + high + 1) / 2;
+        if ((uintptr_t)slabs[mid] <= (uintptr_t)block) {
+            low = mid;
+        }
+        else {
+            high = mid - 1;
+        }
+    }
+    return low;
+}
+
+/*
+ * Releases the slabs of a pool none of whose blocks is in use, except for one that is kept for the next
+ * allocations. Costs O(free blocks * log slabs).
+ */
+void GraphsInt_PoolTrim(GraphsPool* poolPtr)
+{
+    char** slabs;
+    int* freeBlocks;
+    char* release;
+    void* block;
+    void** link;
+    int count = poolPtr->slabCount, kept = 0, spare = 0;
+
+    if (count < 2 || poolPtr->freeCount < 2 * GRAPHS_POOL_SLAB_BLOCKS) {
+        return;
+    }
+    slabs = (char**)ckalloc(count * sizeof(char*));
+    freeBlocks = (int*)ckalloc(count * sizeof(int));
+    release = ckalloc(count);
+    block = poolPtr->slabs;
+    for (int i = 0; i < count; i++, block = *(void**)block) {
+        slabs[i] = (char*)block;
+        freeBlocks[i] = 0;
+    }
+    qsort(slabs, count, sizeof(char*), PoolCompareSlabs);
+    for (block = poolPtr->freeList; block != NULL; block = *(void**)block) {
+        freeBlocks[PoolFindSlab(slabs, count, (char*)block)]++;
+    }
+    for (int i = 0; i < count; i++) {
+        release[i] = 0;
+        if (freeBlocks[i] == GRAPHS_POOL_SLAB_BLOCKS) {
+            release[i] = spare;
+            spare = 1;
+        }
+    }
+
+    /* unlink the blocks of the released slabs from the free list */
+    link = &poolPtr->freeList;
+    while (*link != NULL) {
+        if (release[PoolFindSlab(slabs, count, (char*)*link)]) {
+            *link = *(void**)*link;
+            poolPtr->freeCount--;
+        }
+        else {
+            link = (void**)*link;
+        }
+    }
+
+    poolPtr->slabs = NULL;
+    for (int i = 0; i < count; i++) {
+        if (release[i]) {
+            ckfree(slabs[i]);
+        }
+        else {
+            *(void**)slabs[i] = poolPtr->slabs;
+            poolPtr->slabs = slabs[i];
+            kept++;
+        }
+    }
+    poolPtr->slabCount = kept;
+    ckfree((char*)slabs);
+    ckfree((char*)freeBlocks);
+    ckfree(release);
+}
+
+/*
+ * Releases all slabs of a pool at once. Blocks still in use become invalid.
+ */
+void GraphsInt_PoolRelease(GraphsPool* poolPtr)
+{
+    void* slab = poolPtr->slabs;
+    while (slab != NULL) {
+        void* next = *(void**)slab;
+        ckfree(slab);
+        slab = next;
+    }
+    poolPtr->slabs = NULL;
+    poolPtr->freeList = NULL;
+    poolPtr->slabCount = 0;
+    poolPtr->usedCount = 0;
+    poolPtr->freeCount = 0;
+}
+
+/*
+ * Appends the statistics of a pool as a dict to listObj
+ */
+void GraphsInt_PoolStats(const GraphsPool* poolPtr, Tcl_Interp* interp, Tcl_Obj* listObj)
+{
+    Tcl_Obj* stats = Tcl_NewListObj(0, NULL);
+
+    Tcl_ListObjAppendElement(interp, stats, Tcl_NewStringObj("blocksize", -1));
+    Tcl_ListObjAppendElement(interp, stats, Tcl_NewWideIntObj((Tcl_WideInt)poolPtr->blockSize));
+    Tcl_ListObjAppendElement(interp, stats, Tcl_NewStringObj("slabs", -1));
+    Tcl_ListObjAppendElement(interp, stats, Tcl_NewIntObj(poolPtr->slabCount));
+    Tcl_ListObjAppendElement(interp, stats, Tcl_NewStringObj("used", -1));
+    Tcl_ListObjAppendElement(interp, stats, Tcl_NewWideIntObj(poolPtr->usedCount));
+    Tcl_ListObjAppendElement(interp, stats, Tcl_NewStringObj("free", -1));
+    Tcl_ListObjAppendElement(interp, stats, Tcl_NewWideIntObj(poolPtr->freeCount));
+    Tcl_ListObjAppendElement(interp, stats, Tcl_NewStringObj("bytes", -1));
+    Tcl_ListObjAppendElement(interp, stats, Tcl_NewWideIntObj(
+        (Tcl_WideInt)poolPtr->slabCount * GRAPHS_POOL_SLAB_BLOCKS * (Tcl_WideInt)poolPtr->blockSize));
+    Tcl_ListObjAppendElement(interp, listObj, stats);
+}
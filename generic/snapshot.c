@@ -0,0 +1,139 @@
+/*
+ * Frozen compressed sparse row (CSR) snapshots of graphs
+ *
+ * A snapshot compacts the nodes of a graph and the edges between them into contiguous arrays, with dense
+ * integer ids for the nodes. It is built on demand by [$graph freeze] or by C code through
+ * Graphs_GraphGetSnapshot(), is shared by all readers and is dropped on the next mutation of the graph.
+ * Only edges with both nodes inside the graph are part of a snapshot. The incoming arrays are the transpose
+ * of the outgoing arrays, so undirected edges show up in both directions in both of them.
+ */
+#include "graphsInt.h"
+#include <string.h>
+
+static void SnapshotFree(GraphSnapshot* snapPtr)
+{
+    Tcl_DeleteHashTable(&snapPtr->ids);
+    ckfree((char*)snapPtr->nodes);
+    ckfree((char*)snapPtr->outOffsets);
+    ckfree((char*)snapPtr->outTargets);
+    ckfree((char*)snapPtr->outEdges);
+    ckfree((char*)snapPtr->outWeights);
+    ckfree((char*)snapPtr->inOffsets);
+    ckfree((char*)snapPtr->inSources);
+    ckfree((char*)snapPtr->inEdges);
+    ckfree((char*)snapPtr->inWeights);
+    ckfree((char*)snapPtr);
+}
+
+static GraphSnapshot* SnapshotBuild(Graph* graphPtr)
+{
+    GraphSnapshot* snapPtr = (GraphSnapshot*)ckalloc(sizeof(GraphSnapshot));
+    Tcl_HashSearch search;
+    Tcl_HashEntry* entry;
+    int n = graphPtr->nodes.numEntries;
+    int m = 0;
+    int i, new;
+
+    snapPtr->nodeCount = n;
+    snapPtr->nodes = (Node**)ckalloc(n * sizeof(Node*) + 1);
+    Tcl_InitHashTable(&snapPtr->ids, TCL_ONE_WORD_KEYS);
+
+    /* dense node ids */
+    i = 0;
+    for (entry = Tcl_FirstHashEntry(&graphPtr->nodes, &search); entry != NULL; entry = Tcl_NextHashEntry(&search)) {
+        Node* nodePtr = (Node*)Tcl_GetHashValue(entry);
+        Tcl_HashEntry* idEntry = Tcl_CreateHashEntry(&snapPtr->ids, (ClientData)nodePtr, &new);
+        Tcl_SetHashValue(idEntry, (ClientData)(size_t)i);
+        snapPtr->nodes[i++] = nodePtr;
+    }
+
+    /* outgoing rows, in the order of the delta lists */
+    snapPtr->outOffsets = (int*)ckalloc((n + 1) * sizeof(int));
+    for (i = 0; i < n; i++) {
+        snapPtr->outOffsets[i] = m;
+        for (const DeltaEntry* dEntry = snapPtr->nodes[i]->outgoing; dEntry != NULL; dEntry = dEntry->next) {
+            if (dEntry->nodePtr->graph == graphPtr) {
+                m++;
+            }
+        }
+    }
+    snapPtr->outOffsets[n] = m;
+    snapPtr->edgeCount = m;
+
+    snapPtr->outTargets = (int*)ckalloc(m * sizeof(int) + 1);
+    snapPtr->outEdges = (Edge**)ckalloc(m * sizeof(Edge*) + 1);
+    snapPtr->outWeights = (double*)ckalloc(m * sizeof(double) + 1);
+    for (i = 0; i < n; i++) {
+        int k = snapPtr->outOffsets[i];
+        for (const DeltaEntry* dEntry = snapPtr->nodes[i]->outgoing; dEntry != NULL; dEntry = dEntry->next) {
+            if (dEntry->nodePtr->graph == graphPtr) {
+                Tcl_HashEntry* idEntry = Tcl_FindHashEntry(&snapPtr->ids, (ClientData)dEntry->nodePtr);
+                snapPtr->outTargets[k] = (int)(size_t)Tcl_GetHashValue(idEntry);
+                snapPtr->outEdges[k] = dEntry->edgePtr;
+                snapPtr->outWeights[k] = dEntry->edgePtr->weight;
+                k++;
+            }
+        }
+    }
+
+    /* incoming rows, transposed from the outgoing ones */
+    snapPtr->inOffsets = (int*)ckalloc((n + 1) * sizeof(int));
+    memset(snapPtr->inOffsets, 0, (n + 1) * sizeof(int));
+    for (i = 0; i < m; i++) {
+        snapPtr->inOffsets[snapPtr->outTargets[i] + 1]++;
+    }
+    for (i = 0; i < n; i++) {
+        snapPtr->inOffsets[i + 1] += snapPtr->inOffsets[i];
+    }
+
+    snapPtr->inSources = (int*)ckalloc(m * sizeof(int) + 1);
+    snapPtr->inEdges = (Edge**)ckalloc(m * sizeof(Edge*) + 1);
+    snapPtr->inWeights = (double*)ckalloc(m * sizeof(double) + 1);
+    {
+        int* fill = (int*)ckalloc((n + 1) * sizeof(int));
+        memcpy(fill, snapPtr->inOffsets, (n + 1) * sizeof(int));
+        for (i = 0; i < n; i++) {
+            for (int k = snapPtr->outOffsets[i]; k < snapPtr->outOffsets[i + 1]; k++) {
+                int pos = fill[snapPtr->outTargets[k]]++;
+                snapPtr->inSources[pos] = i;
+                snapPtr->inEdges[pos] = snapPtr->outEdges[k];
+                snapPtr->inWeights[pos] = snapPtr->outWeights[k];
+            }
+        }
+        ckfree((char*)fill);
+    }
+
+    return snapPtr;
+}
+
+/*
+ * Returns the snapshot of a graph, building it if there is none or if the graph was modified after the
+ * last one was built. The snapshot is owned by the graph and must not be freed by the caller.
+ */
+GraphSnapshot* Graphs_GraphGetSnapshot(Graph* graphPtr)
+{
+    if (graphPtr->snapshot == NULL) {
+        graphPtr->snapshot = SnapshotBuild(graphPtr);
+    }
+    return graphPtr->snapshot;
+}
+
+/*
+ * Drops the snapshot of a graph. Called on every mutation of the graph, graphPtr may be NULL.
+ */
+void GraphsInt_SnapshotInvalidate(Graph* graphPtr)
+{
+    if (graphPtr != NULL && graphPtr->snapshot != NULL) {
+        SnapshotFree(graphPtr->snapshot);
+        graphPtr->snapshot = NULL;
+    }
+}
+
+/*
+ * Returns the dense id of a node in a snapshot, or -1 if the node is not part of it.
+ */
+int GraphsInt_SnapshotNodeId(const GraphSnapshot* snapPtr, const Node* nodePtr)
+{
+    Tcl_HashEntry* entry = Tcl_FindHashEntry((Tcl_HashTable*)&snapPtr->ids, (ClientData)nodePtr);
+    return (entry == NULL) ? -1 : (int)(size_t)Tcl_GetHashValue(entry);
+}
@@ -0,0 +1,231 @@
+/*
+ * Bulk access to the edge weights of a graph
+ *
+ * [$graph edges weights ?-packed? ?filter?] returns the weights of all member edges of a graph, or of those
+ * matching a filter, in one call: as a dict of edge handles and weights or, with -packed, as a byte array
+ * of doubles in native byte order, to be read with [binary scan $bytes d* weights]. The edges of the packed
+ * form are in the order of [$graph edges list ?filter?], which is stable while the graph is not changed.
+ * [$graph edges setweights <dict>] and [$graph edges setweights -packed <bytes> ?filter?] are the inverse.
+ *
+ * The filter is one of -name <pattern>, -labels <label ...>, -notlabels <label ...> or -all.
+ */
+#include "graphsInt.h"
+#include <string.h>
+
+static const char* WeightsFilterOptions[] = { "-name", "-labels", "-notlabels", "-all", NULL };
+
+/*
+ * Collects the member edges of a graph that match a filter. The edges array must be freed with ckfree().
+ */
+static int WeightsCollect(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[], Edge*** edgesPtr,
+    int* countPtr)
+{
+    struct LabelFilter lblFilt;
+    Tcl_HashTable* edgesTbl = &graphPtr->edges;
+    Tcl_HashSearch search;
+    Tcl_HashEntry* entry;
+    Edge** edges;
+    int optIdx = LABELS_ALL_IDX, count = 0;
+
+    if (objc > 0) {
+        if (Tcl_GetIndexFromObj(interp, objv[0], WeightsFilterOptions, "option", 0, &optIdx) != TCL_OK
+            || GraphsInt_CheckLabelsOptions(optIdx, interp, objc, objv) != TCL_OK) {
+            return TCL_ERROR;
+        }
+    }
+    lblFilt.filterType = optIdx;
+    lblFilt.objc = objc - 1;
+    lblFilt.objv = objv + 1;
+    GraphsInt_LabelFilterInit(graphPtr->statePtr, &lblFilt);
+
+    /* for -labels only the edges carrying the rarest label are candidates */
+    if (lblFilt.filterType == LABELS_IDX) {
+        edgesTbl = GraphsInt_LabelIndexCandidates(&graphPtr->edgesByLabel, &lblFilt);
+    }
+    edges = (Edge**)ckalloc((edgesTbl == NULL ? 0 : edgesTbl->numEntries) * sizeof(Edge*) + 1);
+    entry = (edgesTbl == NULL) ? NULL : Tcl_FirstHashEntry(edgesTbl, &search);
+    for (; entry != NULL; entry = Tcl_NextHashEntry(&search)) {
+        Edge* edgePtr = (Edge*)Tcl_GetHashKey(edgesTbl, entry);
+        int matches = 0;
+
+        GraphsInt_MatchesLabels(&edgePtr->labels, edgePtr->name, &lblFilt, &matches);
+        if (matches) {
+            edges[count++] = edgePtr;
+        }
+    }
+    GraphsInt_LabelFilterFree(&lblFilt);
+
+    *edgesPtr = edges;
+    *countPtr = count;
+    return TCL_OK;
+}
+
+static int WeightsCmdList(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[])
+{
+    Tcl_Obj* result;
+    Edge** edges;
+    int count;
+
+    if (WeightsCollect(graphPtr, interp, objc, objv, &edges, &count) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    result = Tcl_NewListObj(0, NULL);
+    for (int i = 0; i < count; i++) {
+        Tcl_ListObjAppendElement(NULL, result, GraphsInt_EdgeHandleObj(edges[i]));
+    }
+    ckfree((char*)edges);
+    Tcl_SetObjResult(interp, result);
+    return TCL_OK;
+}
+
+static int WeightsCmdGet(Graph* graphPtr, Tcl_Interp* interp, int packed, int objc, Tcl_Obj* const objv[])
+{
+    Tcl_Obj* result;
+    Edge** edges;
+    int count;
+
+    if (WeightsCollect(graphPtr, interp, objc, objv, &edges, &count) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    if (packed) {
+        unsigned char* bytes;
+
+        result = Tcl_NewByteArrayObj(NULL, 0);
+        bytes = Tcl_SetByteArrayLength(result, count * (int)sizeof(double));
+        for (int i = 0; i < count; i++) {
+            memcpy(bytes + i * sizeof(double), &edges[i]->weight, sizeof(double));
+        }
+    }
+    else {
+        Tcl_Obj** elements = (Tcl_Obj**)ckalloc(2 * count * sizeof(Tcl_Obj*) + 1);
+
+        for (int i = 0; i < count; i++) {
+            elements[2 * i] = GraphsInt_EdgeHandleObj(edges[i]);
+            elements[2 * i + 1] = Tcl_NewDoubleObj(edges[i]->weight);
+        }
+        result = Tcl_NewListObj(2 * count, elements);
+        ckfree((char*)elements);
+    }
+    ckfree((char*)edges);
+    Tcl_SetObjResult(interp, result);
+    return TCL_OK;
+}
+
+/* Sets the weights from a packed byte array, one double per edge of the filter */
+static int WeightsSetPacked(Graph* graphPtr, Tcl_Interp* interp, Tcl_Obj* bytesObj, int objc, Tcl_Obj* const objv[])
+{
+    Edge** edges;
+    int count, length;
+    const unsigned char* bytes = Tcl_GetByteArrayFromObj(bytesObj, &length);
+
+    if (WeightsCollect(graphPtr, interp, objc, objv, &edges, &count) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    if (length != count * (int)sizeof(double)) {
+        Tcl_SetObjResult(interp, Tcl_ObjPrintf("expected %d packed weights, got %d bytes", count, length));
+        ckfree((char*)edges);
+        return TCL_ERROR;
+    }
+    for (int i = 0; i < count; i++) {
+        double weight;
+        memcpy(&weight, bytes + i * sizeof(double), sizeof(double));
+        GraphsInt_EdgeSetWeight(edges[i], weight);
+    }
+    ckfree((char*)edges);
+    Tcl_SetObjResult(interp, Tcl_NewIntObj(count));
+    return TCL_OK;
+}
+
+/* Sets the weights from a dict of member edges and weights. All pairs are checked before the first is set. */
+static int WeightsSetDict(Graph* graphPtr, Tcl_Interp* interp, Tcl_Obj* dictObj)
+{
+    Tcl_Obj** pairs;
+    Edge** edges;
+    double* weights;
+    int count;
+
+    if (Tcl_ListObjGetElements(interp, dictObj, &count, &pairs) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    if (count % 2) {
+        Tcl_SetObjResult(interp, Tcl_NewStringObj("missing weight to go with edge", -1));
+        return TCL_ERROR;
+    }
+
+    edges = (Edge**)ckalloc((count / 2) * sizeof(Edge*) + 1);
+    weights = (double*)ckalloc((count / 2) * sizeof(double) + 1);
+    for (int i = 0; i < count / 2; i++) {
+        Edge* edgePtr = GraphsInt_EdgeGetFromObj(graphPtr->statePtr, pairs[2 * i]);
+
+        if (edgePtr == NULL || Tcl_FindHashEntry(&graphPtr->edges, (ClientData)edgePtr) == NULL) {
+            Tcl_SetObjResult(interp, Tcl_ObjPrintf("%s is not an edge of %s", Tcl_GetString(pairs[2 * i]),
+                graphPtr->cmdName));
+            count = -1;
+            break;
+        }
+        if (Tcl_GetDoubleFromObj(interp, pairs[2 * i + 1], &weights[i]) != TCL_OK) {
+            count = -1;
+            break;
+        }
+        edges[i] = edgePtr;
+    }
+    for (int i = 0; i < count / 2; i++) {
+        GraphsInt_EdgeSetWeight(edges[i], weights[i]);
+    }
+    ckfree((char*)edges);
+    ckfree((char*)weights);
+    if (count < 0) {
+        return TCL_ERROR;
+    }
+    Tcl_SetObjResult(interp, Tcl_NewIntObj(count / 2));
+    return TCL_OK;
+}
+
+/*
+ * Implements [$graph edges list|weights|setweights ...]
+ */
+int GraphsInt_GraphCmdEdges(Graph* graphPtr, Tcl_Interp* interp, int objc, Tcl_Obj* const objv[])
+{
+    static const char* subCmds[] = { "list", "weights", "setweights", NULL };
+    enum SubCmdIx
+    {
+        ListIx,
+        WeightsIx,
+        SetWeightsIx
+    };
+    int cmdIdx, packed = 0;
+
+    if (objc < 1) {
+        Tcl_WrongNumArgs(interp, 0, objv, "list|weights|setweights ?arg ...?");
+        return TCL_ERROR;
+    }
+    if (Tcl_GetIndexFromObj(interp, objv[0], subCmds, "subcommand", 0, &cmdIdx) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    objc--;
+    objv++;
+    if (cmdIdx != ListIx && objc > 0 && strcmp(Tcl_GetString(objv[0]), "-packed") == 0) {
+        packed = 1;
+        objc--;
+        objv++;
+    }
+
+    switch (cmdIdx) {
+    case ListIx:
+        return WeightsCmdList(graphPtr, interp, objc, objv);
+    case WeightsIx:
+        return WeightsCmdGet(graphPtr, interp, packed, objc, objv);
+    case SetWeightsIx:
+        if (packed && objc >= 1) {
+            return WeightsSetPacked(graphPtr, interp, objv[0], objc - 1, objv + 1);
+        }
+        if (!packed && objc == 1) {
+            return WeightsSetDict(graphPtr, interp, objv[0]);
+        }
+        Tcl_WrongNumArgs(interp, 0, objv, "setweights <dict> | setweights -packed <bytes> ?filter?");
+        return TCL_ERROR;
+    default:
+        break;
+    }
+    return TCL_ERROR;
+}
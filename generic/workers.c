@@ -0,0 +1,142 @@
+/*
+ * Fixed set of worker threads for the parallel algorithms (Bellman-Ford rounds and bottom-up BFS steps)
+ *
+ * The threads are started once per run of an algorithm and wait on a condition between the steps, so that
+ * a step costs a wakeup instead of creating and joining threads. Every thread has an item of its own, a
+ * step calls the work function on all items: the first one on the calling thread, the others on the
+ * workers. Items of threads that could not be created are done by the calling thread as well, and so are
+ * all items if the extension is built without TCL_THREADS, where Tcl's mutexes and conditions do nothing.
+ */
+#include "graphsInt.h"
+
+typedef struct _workersThread
+{
+    GraphsWorkers* poolPtr;
+    void* item;
+    Tcl_ThreadId id;
+    int started;
+} WorkersThread;
+
+struct _graphsWorkers
+{
+    GraphsWorkFunc* func;
+    WorkersThread* threads;
+    int count;
+
+    /* the mutex guards step, pending and stop */
+    Tcl_Mutex mutex;
+    Tcl_Condition startCond;
+    Tcl_Condition doneCond;
+    unsigned int step;
+    int pending;
+    int running;
+    int stop;
+};
+
+static Tcl_ThreadCreateType WorkersThreadProc(ClientData clientData)
+{
+    WorkersThread* threadPtr = (WorkersThread*)clientData;
+    GraphsWorkers* poolPtr = threadPtr->poolPtr;
+    unsigned int step = 0;
+
+    Tcl_MutexLock(&poolPtr->mutex);
+    for (;;) {
+        while (poolPtr->step == step && !poolPtr->stop) {
+            Tcl_ConditionWait(&poolPtr->startCond, &poolPtr->mutex, NULL);
+        }
+        if (poolPtr->stop) {
+            break;
+        }
+        step = poolPtr->step;
+        Tcl_MutexUnlock(&poolPtr->mutex);
+
+        poolPtr->func(threadPtr->item);
+
+        Tcl_MutexLock(&poolPtr->mutex);
+        if (--poolPtr->pending == 0) {
+            Tcl_ConditionNotify(&poolPtr->doneCond);
+        }
+    }
+    Tcl_MutexUnlock(&poolPtr->mutex);
+    TCL_THREAD_CREATE_RETURN;
+}
+
+/*
+ * Starts count - 1 threads for the items, an array of count items of itemSize bytes each. The items must
+ * stay in place until GraphsInt_WorkersStop().
+ */
+GraphsWorkers* GraphsInt_WorkersStart(int count, GraphsWorkFunc* func, void* items, size_t itemSize)
+{
+    GraphsWorkers* poolPtr = (GraphsWorkers*)ckalloc(sizeof(GraphsWorkers));
+
+    poolPtr->func = func;
+    poolPtr->count = count;
+    poolPtr->threads = (WorkersThread*)ckalloc(count * sizeof(WorkersThread));
+    poolPtr->mutex = NULL;
+    poolPtr->startCond = NULL;
+    poolPtr->doneCond = NULL;
+    poolPtr->step = 0;
+    poolPtr->pending = 0;
+    poolPtr->running = 0;
+    poolPtr->stop = 0;
+
+    for (int t = 0; t < count; t++) {
+        WorkersThread* threadPtr = &poolPtr->threads[t];
+
+        threadPtr->poolPtr = poolPtr;
+        threadPtr->item = (char*)items + t * itemSize;
+#ifdef TCL_THREADS
+        threadPtr->started = t > 0
+            && Tcl_CreateThread(&threadPtr->id, WorkersThreadProc, threadPtr, TCL_THREAD_STACK_DEFAULT,
+                   TCL_THREAD_JOINABLE) == TCL_OK;
+#else
+        threadPtr->started = 0;
+#endif
+        poolPtr->running += threadPtr->started;
+    }
+    return poolPtr;
+}
+
+/* Runs the work function on all items and returns when all are done */
+void GraphsInt_WorkersRun(GraphsWorkers* poolPtr)
+{
+    Tcl_MutexLock(&poolPtr->mutex);
+    poolPtr->pending = poolPtr->running;
+    poolPtr->step++;
+    Tcl_ConditionNotify(&poolPtr->startCond);
+    Tcl_MutexUnlock(&poolPtr->mutex);
+
+    for (int t = 0; t < poolPtr->count; t++) {
+        if (!poolPtr->threads[t].started) {
+            poolPtr->func(poolPtr->threads[t].item);
+        }
+    }
+
+    Tcl_MutexLock(&poolPtr->mutex);
+    while (poolPtr->pending > 0) {
+        Tcl_ConditionWait(&poolPtr->doneCond, &poolPtr->mutex, NULL);
+    }
+    Tcl_MutexUnlock(&poolPtr->mutex);
+}
+
+/* Ends and joins the threads, and frees the pool */
+void GraphsInt_WorkersStop(GraphsWorkers* poolPtr)
+{
+    Tcl_MutexLock(&poolPtr->mutex);
+    poolPtr->stop = 1;
+    Tcl_ConditionNotify(&poolPtr->startCond);
+    Tcl_MutexUnlock(&poolPtr->mutex);
+
+    for (int t = 0; t < poolPtr->count; t++) {
+        int threadResult;
+
+        if (poolPtr->threads[t].started) {
+            Tcl_JoinThread(poolPtr->threads[t].id, &threadResult);
+        }
+    }
+    Tcl_ConditionFinalize(&poolPtr->startCond);
+    Tcl_ConditionFinalize(&poolPtr->doneCond);
+    Tcl_MutexFinalize(&poolPtr->mutex);
+    ckfree((char*)poolPtr->threads);
+    ckfree((char*)poolPtr);
+}
@@ -20,14 +20,20 @@ proc ::graphs::digraph-to-dot {graph args} {
         append result \n
     }
 
-    foreach {edge} [$graph info edges] {
+    # marked edges as dict keys, looked up once per edge
+    set marked {}
+    if {[dict exists $args -mark]} {
+        foreach edge [dict get $args -mark] {
+            dict set marked $edge {}
+        }
+    }
+    foreach {edge fromName toName name weight data labels} \
+            [$graph info edges -format {edge fromname toname name weight data labels}] {
         set markArgs {}
-        if {[dict exists $args -mark]} {
-            if {[lsearch [dict get $args -mark] $edge] >= 0} {
-                set markArgs { color=red penwidth=2.0 }
-            }
+        if {[dict exists $marked $edge]} {
+            set markArgs { color=red penwidth=2.0 }
         }
-        append result [diedge-to-dot $edge {*}$markArgs] \;
+        append result [edge-fields-to-dot $fromName $toName $name $weight $data $labels {*}$markArgs] \;
         if {$pretty} {
             append result \n
         }
@@ -38,14 +44,17 @@ proc ::graphs::digraph-to-dot {graph args} {
 proc ::graphs::diedge-to-dot {edge args} {
     set from [$edge cget -from]
     set to [$edge cget -to]
-    set weight [$edge cget -weight]
-    set data [$edge cget -data]
-    if {[$from cget -name] == "" || [$to cget -name] == ""} {
+    edge-fields-to-dot [$from cget -name] [$to cget -name] [$edge cget -name] [$edge cget -weight] \
+        [$edge cget -data] [$edge labels] {*}$args
+}
+
+proc ::graphs::edge-fields-to-dot {fromName toName name weight data labels args} {
+    if {$fromName == "" || $toName == ""} {
         throw {GRAPHS EDGE_TO_DOT} "from and to nodes must have names"
     }
-    append result \" [$from cget -name] \" -> \" [$to cget -name] \"
-    append result \[ label = \" [$edge cget -name] \" , weight = \" $weight \" , data = \" $data \" ,
-    append result labels = \" [$edge labels] \"
+    append result \" $fromName \" -> \" $toName \"
+    append result \[ label = \" $name \" , weight = \" $weight \" , data = \" $data \" ,
+    append result labels = \" $labels \"
     if {$args != {}} {
         append result , [join $args ,]
     }
@@ -53,48 +62,7 @@ proc ::graphs::diedge-to-dot {edge args} {
 }
 
 proc ::graphs::digraph-from-dot {graph dot} {
-
-    set start [expr {[string first "\{" $dot] + 1}]
-    set end [expr {[string last "\}" $dot] - 1}]
-
-    set graphTkn [string range $dot 0 [expr {$start - 2}]]
-    set name [if {[llength $graphTkn] > 1} {
-        lindex $graphTkn 1
-    } else {
-        list
-    }]
-
-    set result {}
-    set edgesStr [lrange [split [string range $dot $start $end] \;] 0 end-1]
-    foreach {edge} $edgesStr {
-        set edge [string trim $edge]
-        set attrStart [expr {[string first "\[" $edge] + 1}]
-        set attrEnd [expr {[string last "\]" $edge]} - 1]
-        set edgeDesc [string range $edge 0 [expr {$attrStart - 2}]]
-        set attrStr [string range $edge $attrStart $attrEnd]
-        foreach {attr} [split $attrStr ,] {
-            set key -[lindex [split $attr =] 0]
-            set val [lindex [split $attr =] 1]
-            dict set attrs $key [string trim $val \"]
-        }
-        set nodes [split [regsub {\->} $edgeDesc ,] ,]
-        set from [get-or-create-node $graph [string trim [lindex $nodes 0] \"]]
-        set to [get-or-create-node $graph [string trim [lindex $nodes 1] \"]]
-        set e [::graphs::edge new $from -> $to]
-        foreach {key} { -weight -data } {
-            if {[dict exists $attrs $key]} {
-                $e configure $key [dict get $attrs $key]
-            }
-        }
-        if {[dict exists $attrs -label]} {
-            $e configure -name [dict get $attrs -label]
-        }
-        if {[dict exists $attrs -labels]} {
-            $e labels + {*}[dict get $attrs -labels]
-        }
-    }
-
-    return $name
+    $graph read dot -string $dot
 }
 
 package provide graphs::dot @CMAKE_PROJECT_VERSION@
@@ -10,11 +10,7 @@ namespace eval ::graphs {
 # Determines whether a node with a name already exists and returns it.
 # Otherwise creates a new node with that name.
 proc ::graphs::get-or-create-node {graph name} {
-    if {[$graph info nodes -name $name] != {}} {
-        $graph info nodes -name $name
-    } else {
-        ::graphs::node new -name $name -graph $graph
-    }
+    $graph nodes get-or-create $name
 }
 
 ## clone edges into a new graph.